@@ -0,0 +1,243 @@
+// Compares the per-tick update loop over the old interleaved Entity layout
+// against the split EntityBody columns. Prints time per entity and, where
+// perf counters are available, cache misses per entity.
+//
+//     bench_entity_layout [entity_count] [iterations]
+#define _GNU_SOURCE
+
+#include "common.h"
+#include "core/clock.h"
+#include "entity.h"
+#include "globals.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+// Entity and Bullet as they were before the split, render and weapon data interleaved with physics
+typedef struct {
+	bool32 active;
+
+	Vector2 position;
+	Vector2 velocity;
+	Vector2 size;
+	float rotation;
+
+	bool collision_active;
+	Rectangle collision_shape;
+
+	float bullet_damage;
+	float bullet_life_timer;
+
+	Rectangle area;
+	Color tint;
+	Texture2D *texture;
+} LegacyEntity;
+
+typedef struct {
+	LegacyEntity entity;
+
+	float speed;
+	float damage;
+	float life_timer;
+} LegacyBullet;
+
+typedef struct {
+	const char *name;
+	uint64_t cache_misses, cache_references;
+	bool32 counters;
+	double ns_per_entity;
+} LayoutResult;
+
+#if defined(__linux__)
+static int counter_open(uint64_t config) {
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t counter_read(int fd) {
+	uint64_t value = 0;
+	if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value))
+		return 0;
+	return value;
+}
+#endif
+
+// The bullet update before and after the split: integrate, wrap and sync the collision rectangle.
+// Both loops are written out the same way so only the memory layout differs.
+static void legacy_update(LegacyBullet *bullets, uint32_t count) {
+	for (uint32_t index = 0; index < count; index++) {
+		LegacyEntity *entity = &bullets[index].entity;
+
+		entity->position = Vector2Add(entity->position, entity->velocity);
+		entity->velocity = Vector2Scale(entity->velocity, 1.0f);
+
+		float half_w = entity->size.x * .5f;
+		float half_h = entity->size.y * .5f;
+		if (entity->position.x < -half_w)
+			entity->position.x = WINDOW_WIDTH + half_w;
+		else if (entity->position.x > WINDOW_WIDTH + half_w)
+			entity->position.x = -half_w;
+		if (entity->position.y < -half_h)
+			entity->position.y = WINDOW_HEIGHT + half_h;
+		else if (entity->position.y > WINDOW_HEIGHT + half_h)
+			entity->position.y = -half_h;
+
+		entity->collision_shape.x = entity->position.x - entity->collision_shape.width * .5f;
+		entity->collision_shape.y = entity->position.y - entity->collision_shape.height * .5f;
+	}
+}
+
+static void split_update(EntityBody *bodies, uint32_t count) {
+	for (uint32_t index = 0; index < count; index++) {
+		EntityBody *body = &bodies[index];
+
+		body->position = Vector2Add(body->position, body->velocity);
+		body->velocity = Vector2Scale(body->velocity, 1.0f);
+
+		float half_w = body->size.x * .5f;
+		float half_h = body->size.y * .5f;
+		if (body->position.x < -half_w)
+			body->position.x = WINDOW_WIDTH + half_w;
+		else if (body->position.x > WINDOW_WIDTH + half_w)
+			body->position.x = -half_w;
+		if (body->position.y < -half_h)
+			body->position.y = WINDOW_HEIGHT + half_h;
+		else if (body->position.y > WINDOW_HEIGHT + half_h)
+			body->position.y = -half_h;
+
+		body->collision_shape.x = body->position.x - body->collision_shape.width * .5f;
+		body->collision_shape.y = body->position.y - body->collision_shape.height * .5f;
+	}
+}
+
+typedef void (*PFN_layout_update)(void *data, uint32_t count);
+
+static void run_legacy(void *data, uint32_t count) { legacy_update(data, count); }
+static void run_split(void *data, uint32_t count) { split_update(data, count); }
+
+static LayoutResult measure(const char *name, PFN_layout_update update, void *data, uint32_t count, uint32_t iterations) {
+	LayoutResult result = { .name = name };
+
+	// Warm up so both layouts start from the same cache state
+	update(data, count);
+
+#if defined(__linux__)
+	int misses = counter_open(PERF_COUNT_HW_CACHE_MISSES);
+	int references = counter_open(PERF_COUNT_HW_CACHE_REFERENCES);
+	result.counters = misses >= 0 && references >= 0;
+	if (result.counters) {
+		ioctl(misses, PERF_EVENT_IOC_RESET, 0);
+		ioctl(references, PERF_EVENT_IOC_RESET, 0);
+		ioctl(misses, PERF_EVENT_IOC_ENABLE, 0);
+		ioctl(references, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif
+
+	uint64_t start = clock_now_ns();
+	for (uint32_t iteration = 0; iteration < iterations; iteration++)
+		update(data, count);
+	uint64_t elapsed = clock_now_ns() - start;
+
+#if defined(__linux__)
+	if (result.counters) {
+		ioctl(misses, PERF_EVENT_IOC_DISABLE, 0);
+		ioctl(references, PERF_EVENT_IOC_DISABLE, 0);
+		result.cache_misses = counter_read(misses);
+		result.cache_references = counter_read(references);
+	}
+	if (misses >= 0)
+		close(misses);
+	if (references >= 0)
+		close(references);
+#endif
+
+	result.ns_per_entity = (double)elapsed / ((double)count * iterations);
+	return result;
+}
+
+static void print_result(LayoutResult *result, usize stride, uint32_t count, uint32_t iterations) {
+	double entities = (double)count * iterations;
+	printf("%-8s stride %3zu B  %6.2f ns/entity", result->name, stride, result->ns_per_entity);
+	if (result->counters)
+		printf("  %6.3f misses/entity  %6.3f refs/entity", result->cache_misses / entities, result->cache_references / entities);
+	printf("\n");
+}
+
+int main(int argc, char **argv) {
+	// Default working set is well past L2 so the difference in lines touched shows up
+	uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 1u << 18;
+	uint32_t iterations = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 100;
+	if (count == 0 || iterations == 0) {
+		fprintf(stderr, "usage: %s [entity_count] [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	LegacyBullet *legacy = calloc(count, sizeof(*legacy));
+	EntityBody *bodies = calloc(count, sizeof(*bodies));
+	if (legacy == NULL || bodies == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	srand(1);
+	for (uint32_t index = 0; index < count; index++) {
+		Vector2 position = { (float)(rand() % WINDOW_WIDTH), (float)(rand() % WINDOW_HEIGHT) };
+		Vector2 velocity = { (float)(rand() % 31 - 15), (float)(rand() % 31 - 15) };
+		Vector2 size = { 16.f, 32.f };
+
+		legacy[index].entity = (LegacyEntity){
+			.active = true,
+			.position = position,
+			.velocity = velocity,
+			.size = size,
+			.collision_active = true,
+			.collision_shape = { 0, 0, size.x, size.y },
+		};
+		bodies[index] = (EntityBody){
+			.position = position,
+			.velocity = velocity,
+			.size = size,
+			.collision_active = true,
+			.collision_shape = { 0, 0, size.x, size.y },
+		};
+	}
+
+	printf("%u entities, %u iterations\n", count, iterations);
+
+	LayoutResult legacy_result = measure("legacy", run_legacy, legacy, count, iterations);
+	LayoutResult split_result = measure("split", run_split, bodies, count, iterations);
+
+	print_result(&legacy_result, sizeof(LegacyBullet), count, iterations);
+	print_result(&split_result, sizeof(EntityBody), count, iterations);
+
+	if (legacy_result.counters && split_result.counters && split_result.cache_misses)
+		printf("cache misses reduced %.2fx\n", (double)legacy_result.cache_misses / (double)split_result.cache_misses);
+	else if (legacy_result.counters == false)
+		printf("perf counters unavailable, compare time per entity only\n");
+
+	// Keep the results observable so the loops are not optimized away
+	double checksum = 0;
+	for (uint32_t index = 0; index < count; index++)
+		checksum += legacy[index].entity.position.x - bodies[index].position.x;
+	printf("checksum %.3f\n", checksum);
+
+	free(legacy);
+	free(bodies);
+	return 0;
+}
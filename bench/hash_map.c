@@ -0,0 +1,284 @@
+// Builds and probes the hash trie and the flat maps from core/hash_map.h at
+// growing key counts, with asset path keys and with 64 bit hashes as keys.
+// Lookups go in shuffled order so neither side gets the insertion order's
+// cache locality for free. The concurrent trie is then filled by several threads
+// at once, each inserting every key from its own starting point so they collide,
+// and times are per key of wall clock.
+//
+//     bench_hash_map [max_keys] [threads]
+#include "common.h"
+#include "core/arena.h"
+#include "core/astring.h"
+#include "core/clock.h"
+#include "core/hash_map.h"
+#include "core/hash_trie.h"
+#include "core/random.h"
+#include "core/thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Keys touched per measurement at the smaller sizes, the build is repeated until it adds up
+#define BENCH_OPERATIONS (1u << 21)
+#define BENCH_MAX_THREADS 8
+
+typedef struct {
+	HashTrieNode node;
+	uint32_t value;
+} TrieEntry;
+
+typedef struct {
+	Arena keys, work;
+	String *strings;
+	uint64_t *hashes;
+	uint32_t *order;
+} Bench;
+
+typedef struct {
+	double insert_ns, lookup_ns;
+	uint64_t checksum;
+} Timing;
+
+static Timing time_trie_strings(Bench *bench, uint32_t count, uint32_t rounds) {
+	Timing timing = { 0 };
+	for (uint32_t round = 0; round < rounds; round++) {
+		arena_reset(&bench->work);
+		TrieEntry *root = NULL;
+
+		uint64_t start = clock_now_ns();
+		for (uint32_t index = 0; index < count; index++)
+			hash_trie_insert(&bench->work, &root, bench->strings[index], TrieEntry)->value = index;
+		uint64_t built = clock_now_ns();
+		for (uint32_t index = 0; index < count; index++)
+			timing.checksum += hash_trie_lookup(&root, bench->strings[bench->order[index]], TrieEntry)->value;
+		uint64_t probed = clock_now_ns();
+
+		timing.insert_ns += built - start;
+		timing.lookup_ns += probed - built;
+	}
+	return timing;
+}
+
+static Timing time_map_strings(Bench *bench, uint32_t count, uint32_t rounds) {
+	Timing timing = { 0 };
+	for (uint32_t round = 0; round < rounds; round++) {
+		arena_reset(&bench->work);
+		StringMap map;
+		string_map_init(&map, &bench->work, 0);
+
+		uint64_t start = clock_now_ns();
+		for (uint32_t index = 0; index < count; index++)
+			*string_map_insert_value(&bench->work, &map, bench->strings[index], uint32_t) = index;
+		uint64_t built = clock_now_ns();
+		for (uint32_t index = 0; index < count; index++)
+			timing.checksum += *string_map_lookup_value(&map, bench->strings[bench->order[index]], uint32_t);
+		uint64_t probed = clock_now_ns();
+
+		timing.insert_ns += built - start;
+		timing.lookup_ns += probed - built;
+	}
+	return timing;
+}
+
+static Timing time_trie_hashes(Bench *bench, uint32_t count, uint32_t rounds) {
+	Timing timing = { 0 };
+	for (uint32_t round = 0; round < rounds; round++) {
+		arena_reset(&bench->work);
+		TrieEntry *root = NULL;
+
+		uint64_t start = clock_now_ns();
+		for (uint32_t index = 0; index < count; index++)
+			hash_trie_insert_hash(&bench->work, &root, bench->hashes[index], TrieEntry)->value = index;
+		uint64_t built = clock_now_ns();
+		for (uint32_t index = 0; index < count; index++)
+			timing.checksum += hash_trie_lookup_hash(&root, bench->hashes[bench->order[index]], TrieEntry)->value;
+		uint64_t probed = clock_now_ns();
+
+		timing.insert_ns += built - start;
+		timing.lookup_ns += probed - built;
+	}
+	return timing;
+}
+
+static Timing time_map_hashes(Bench *bench, uint32_t count, uint32_t rounds) {
+	Timing timing = { 0 };
+	for (uint32_t round = 0; round < rounds; round++) {
+		arena_reset(&bench->work);
+		U64Map map;
+		u64_map_init(&map, &bench->work, 0);
+
+		uint64_t start = clock_now_ns();
+		for (uint32_t index = 0; index < count; index++)
+			*u64_map_insert_value(&bench->work, &map, bench->hashes[index], uint32_t) = index;
+		uint64_t built = clock_now_ns();
+		for (uint32_t index = 0; index < count; index++)
+			timing.checksum += *u64_map_lookup_value(&map, bench->hashes[bench->order[index]], uint32_t);
+		uint64_t probed = clock_now_ns();
+
+		timing.insert_ns += built - start;
+		timing.lookup_ns += probed - built;
+	}
+	return timing;
+}
+
+typedef struct {
+	Bench *bench;
+	Arena arena;
+	TrieEntry **root;
+	uint32_t count, first;
+	// Node each key resolved to, indexed by key
+	TrieEntry **found;
+	uint64_t lookups;
+} TrieWorker;
+
+static void trie_worker_insert(void *user) {
+	TrieWorker *worker = user;
+	for (uint32_t step = 0; step < worker->count; step++) {
+		uint32_t index = (worker->first + step) % worker->count;
+		worker->found[index] = hash_trie_insert_concurrent(&worker->arena, worker->root, worker->bench->strings[index], TrieEntry);
+	}
+}
+
+static void trie_worker_lookup(void *user) {
+	TrieWorker *worker = user;
+	for (uint32_t step = 0; step < worker->count; step++) {
+		uint32_t index = worker->bench->order[(worker->first + step) % worker->count];
+		worker->lookups += hash_trie_lookup_concurrent(worker->root, worker->bench->strings[index], TrieEntry) == worker->found[index];
+	}
+}
+
+static void run_workers(TrieWorker *workers, uint32_t thread_count, PFN_thread_entry entry) {
+	Thread *threads[BENCH_MAX_THREADS] = { 0 };
+	for (uint32_t index = 1; index < thread_count; index++)
+		threads[index] = thread_create(entry, &workers[index]);
+	entry(&workers[0]);
+	for (uint32_t index = 1; index < thread_count; index++) {
+		// Without threads the calling thread does every share in turn
+		if (threads[index] == NULL)
+			entry(&workers[index]);
+		thread_join(threads[index]);
+	}
+}
+
+// Returns false when two threads came back with different nodes for one key, or a key lost its node
+static bool32 time_trie_concurrent(Bench *bench, uint32_t count, uint32_t thread_count, Timing *timing) {
+	TrieWorker workers[BENCH_MAX_THREADS];
+	TrieEntry *root = NULL;
+	for (uint32_t index = 0; index < thread_count; index++) {
+		workers[index] = (TrieWorker){
+			.bench = bench,
+			// A thread can win most of the inserts, candidates for keys it lost are handed back
+			.arena = arena_create(count * 128ull + MiB(1)),
+			.root = &root,
+			.count = count,
+			.first = (uint32_t)((uint64_t)count * index / thread_count),
+			.found = malloc(count * sizeof(TrieEntry *)),
+		};
+	}
+
+	uint64_t start = clock_now_ns();
+	run_workers(workers, thread_count, trie_worker_insert);
+	uint64_t built = clock_now_ns();
+	run_workers(workers, thread_count, trie_worker_lookup);
+	uint64_t probed = clock_now_ns();
+	*timing = (Timing){ .insert_ns = (double)(built - start), .lookup_ns = (double)(probed - built) };
+
+	bool32 agreed = true;
+	for (uint32_t key = 0; key < count; key++) {
+		TrieEntry *entry = workers[0].found[key];
+		agreed &= entry != NULL && string_equals(entry->node.key, bench->strings[key]);
+		for (uint32_t index = 1; index < thread_count; index++)
+			agreed &= workers[index].found[key] == entry;
+	}
+	for (uint32_t index = 0; index < thread_count; index++) {
+		agreed &= workers[index].lookups == count;
+		free(workers[index].found);
+		arena_destroy(&workers[index].arena);
+	}
+	return agreed;
+}
+
+static void print_row(const char *name, uint32_t count, uint32_t rounds, Timing timing) {
+	double operations = (double)count * rounds;
+	printf("%-12s %8u %10.2f %10.2f\n", name, count, timing.insert_ns / operations, timing.lookup_ns / operations);
+}
+
+int main(int argc, char **argv) {
+	uint32_t max_keys = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 1000000;
+	if (max_keys == 0) {
+		fprintf(stderr, "usage: %s [max_keys] [threads]\n", argv[0]);
+		return 1;
+	}
+
+	// Sized for the trie at the largest count, the maps leave their outgrown tables behind too
+	Bench bench = {
+		.keys = arena_create(max_keys * 64ull + MiB(1)),
+		.work = arena_create(max_keys * 256ull + MiB(1)),
+		.strings = malloc(max_keys * sizeof(String)),
+		.hashes = malloc(max_keys * sizeof(uint64_t)),
+		.order = malloc(max_keys * sizeof(uint32_t)),
+	};
+	if (bench.keys.memory == NULL || bench.work.memory == NULL || bench.strings == NULL || bench.hashes == NULL || bench.order == NULL)
+		return 1;
+
+	Rng rng = rng_seed(7, 0);
+	for (uint32_t index = 0; index < max_keys; index++) {
+		bench.strings[index] = string_format(&bench.keys, "assets/textures/sprite_%07u.png", index);
+		bench.hashes[index] = string_hash64(bench.strings[index]);
+		bench.order[index] = index;
+	}
+
+	uint32_t thread_count = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : thread_hardware_concurrency();
+	thread_count = clamp(thread_count, 1u, (uint32_t)BENCH_MAX_THREADS);
+	printf("%-12s %8s %10s %10s\n", "", "keys", "insert ns", "lookup ns");
+	uint64_t checksum = 0;
+	for (uint32_t count = 1000; count <= max_keys; count *= 10) {
+		// Shuffle the first `count` so every lookup hits and none come in insertion order
+		for (uint32_t index = 0; index < count; index++)
+			bench.order[index] = index;
+		for (uint32_t index = count; index-- > 1;) {
+			uint32_t other = (uint32_t)rng_range(&rng, 0, (int32_t)index);
+			uint32_t swap = bench.order[index];
+			bench.order[index] = bench.order[other];
+			bench.order[other] = swap;
+		}
+
+		uint32_t rounds = max(BENCH_OPERATIONS / count, 1u);
+		Timing timings[4] = {
+			time_trie_strings(&bench, count, rounds),
+			time_map_strings(&bench, count, rounds),
+			time_trie_hashes(&bench, count, rounds),
+			time_map_hashes(&bench, count, rounds),
+		};
+		print_row("trie string", count, rounds, timings[0]);
+		print_row("map string", count, rounds, timings[1]);
+		print_row("trie hash", count, rounds, timings[2]);
+		print_row("map u64", count, rounds, timings[3]);
+
+		// Every variant must have found every key
+		for (uint32_t index = 1; index < countof(timings); index++) {
+			if (timings[index].checksum != timings[0].checksum) {
+				fprintf(stderr, "lookups disagree at %u keys\n", count);
+				return 1;
+			}
+		}
+		checksum += timings[0].checksum;
+
+		Timing concurrent;
+		if (time_trie_concurrent(&bench, count, thread_count, &concurrent) == false) {
+			fprintf(stderr, "concurrent trie disagrees at %u keys\n", count);
+			return 1;
+		}
+		char name[16];
+		snprintf(name, sizeof(name), "trie x%u", thread_count);
+		print_row(name, count, 1, concurrent);
+	}
+	printf("checksum %llu\n", (unsigned long long)checksum);
+
+	free(bench.order);
+	free(bench.hashes);
+	free(bench.strings);
+	arena_destroy(&bench.work);
+	arena_destroy(&bench.keys);
+	return 0;
+}
@@ -0,0 +1,70 @@
+// Times entity_bodies_integrate on every backend the CPU supports and
+// verifies each against the scalar path first.
+//
+//     bench_physics_batch [body_count] [iterations]
+#include "common.h"
+#include "core/clock.h"
+#include "entity_physics.h"
+#include "globals.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv) {
+	uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 4096;
+	uint32_t iterations = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 2000;
+	if (count == 0 || iterations == 0) {
+		fprintf(stderr, "usage: %s [body_count] [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	if (entity_physics_self_check() == false) {
+		fprintf(stderr, "batch physics backends are not bit-exact with scalar\n");
+		return 1;
+	}
+	printf("self check passed, default backend %s\n", entity_physics_backend_name(entity_physics_backend()));
+
+	EntityBody *bodies = malloc(count * sizeof(*bodies));
+	if (bodies == NULL)
+		return 1;
+
+	EntityMotion motion = {
+		.velocity_scale = 1.0f,
+		.drag = 1.0f,
+		.wrap = true,
+		.wrap_margin = .5f,
+		.bounds = { WINDOW_WIDTH, WINDOW_HEIGHT },
+	};
+
+	for (uint32_t backend = 0; backend < ENTITY_PHYSICS_COUNT; backend++) {
+		if (entity_physics_select(backend) == false) {
+			printf("%-8s unsupported\n", entity_physics_backend_name(backend));
+			continue;
+		}
+
+		srand(1);
+		for (uint32_t index = 0; index < count; index++) {
+			bodies[index] = (EntityBody){
+				.position = { (float)(rand() % WINDOW_WIDTH), (float)(rand() % WINDOW_HEIGHT) },
+				.velocity = { (float)(rand() % 31 - 15), (float)(rand() % 31 - 15) },
+				.size = { 16.f, 32.f },
+				.collision_shape = { 0, 0, 16.f, 32.f },
+			};
+		}
+
+		uint64_t start = clock_now_ns();
+		for (uint32_t iteration = 0; iteration < iterations; iteration++)
+			entity_bodies_integrate(bodies, count, &motion);
+		uint64_t elapsed = clock_now_ns() - start;
+
+		double checksum = 0;
+		for (uint32_t index = 0; index < count; index++)
+			checksum += bodies[index].position.x + bodies[index].collision_shape.y;
+
+		printf("%-8s %6.2f ns/body  checksum %.3f\n", entity_physics_backend_name(backend),
+			(double)elapsed / ((double)count * iterations), checksum);
+	}
+
+	free(bodies);
+	return 0;
+}
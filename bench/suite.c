@@ -0,0 +1,600 @@
+// Times the engine's hot primitives in repeated samples and prints one JSON
+// document with the median and p99 cost per operation of each case. Given a
+// baseline written by an earlier run it adds the change per case and exits
+// non-zero when any median regressed past the threshold.
+//
+//     bench [--samples count] [--filter text] [--out file] [--baseline file [--threshold percent]]
+//
+//     bench --out before.json
+//     bench --baseline before.json --threshold 5
+#include "common.h"
+#include "core/arena.h"
+#include "core/astring.h"
+#include "core/clock.h"
+#include "core/containers.h"
+#include "core/hash_map.h"
+#include "core/hash_trie.h"
+#include "core/logger.h"
+#include "core/pool.h"
+#include "core/random.h"
+#include "entity.h"
+#include "entity_physics.h"
+#include "event.h"
+#include "fsm.h"
+#include "globals.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_KEY_COUNT 1024
+#define BENCH_ENTITY_COUNT 1024
+#define BENCH_EVENT_TYPE (CORE_EVENT_COUNT + 1)
+#define BENCH_WARMUP_SAMPLES 3
+#define BENCH_MAX_CASES 32
+// Lookups by id over about as many items as the fixed MAX_* arrays hold
+#define BENCH_ID_COUNT 64
+
+typedef struct {
+	HashTrieNode node;
+	uint32_t value;
+} BenchTrieEntry;
+
+ARRAY_DEFINE(BenchBodyArray, bench_body_array, EntityBody)
+RING_DEFINE(BenchTickRing, bench_tick_ring, uint64_t)
+MAP_DEFINE(BenchIdMap, bench_id_map, uint64_t, uint32_t, hash_u64, equals_u64)
+
+typedef struct {
+	uint64_t id;
+	uint32_t value;
+} BenchIdSlot;
+
+// Everything the cases touch is built once up front so samples only time the operation
+typedef struct {
+	Arena arena, scratch, trie_arena, container_arena;
+	Pool *pool;
+	void *pool_elements[1024];
+
+	String keys[BENCH_KEY_COUNT];
+	uint32_t lookup_order[BENCH_KEY_COUNT];
+	BenchTrieEntry *lookup_root;
+	StringMap lookup_map;
+	String haystack, needle;
+
+	FSM fsm;
+	uint32_t fsm_ticks;
+
+	Entity entities[BENCH_ENTITY_COUNT];
+	EntityBody bodies[BENCH_ENTITY_COUNT];
+	EntityMotion motion;
+
+	EntityBody asteroids[MAX_ASTEROIDS];
+	EntityBody bullets[MAX_BULLETS];
+
+	EntityBody fixed_bodies[BENCH_ENTITY_COUNT];
+	uint32_t fixed_body_count;
+	BenchIdSlot id_slots[BENCH_ID_COUNT];
+	uint64_t id_lookups[BENCH_ID_COUNT];
+	BenchIdMap id_map;
+	BenchTickRing tick_ring;
+} BenchState;
+
+typedef struct {
+	const char *name;
+	// What one operation is, the costs are reported per operation
+	const char *unit;
+	uint32_t operations;
+	// Returns a checksum so the optimizer cannot drop the work
+	uint64_t (*run)(BenchState *state, uint32_t operations);
+} BenchCase;
+
+typedef struct {
+	const BenchCase *bench;
+	double median_ns, p99_ns, min_ns, mean_ns;
+
+	bool32 has_baseline;
+	double baseline_median_ns, change_percent;
+} BenchResult;
+
+static volatile uint64_t bench_sink;
+
+static uint64_t bench_arena_push(BenchState *state, uint32_t operations) {
+	arena_reset(&state->arena);
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++)
+		checksum += (uintptr)arena_push(&state->arena, 48, 16, false);
+	return checksum;
+}
+
+static uint64_t bench_pool_alloc_free(BenchState *state, uint32_t operations) {
+	uint32_t count = min(operations / 2, (uint32_t)countof(state->pool_elements));
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < count; index++)
+		checksum += (uintptr)(state->pool_elements[index] = pool_alloc(state->pool));
+	for (uint32_t index = count; index-- > 0;)
+		pool_free(state->pool, state->pool_elements[index]);
+	return checksum;
+}
+
+static uint64_t bench_hash_trie_insert(BenchState *state, uint32_t operations) {
+	arena_reset(&state->trie_arena);
+	BenchTrieEntry *root = NULL;
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++) {
+		BenchTrieEntry *entry = hash_trie_insert(&state->trie_arena, &root, state->keys[index % BENCH_KEY_COUNT], BenchTrieEntry);
+		entry->value = index;
+		checksum += entry->node.hash;
+	}
+	return checksum;
+}
+
+static uint64_t bench_hash_trie_lookup(BenchState *state, uint32_t operations) {
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++) {
+		String key = state->keys[state->lookup_order[index % BENCH_KEY_COUNT]];
+		checksum += hash_trie_lookup(&state->lookup_root, key, BenchTrieEntry)->value;
+	}
+	return checksum;
+}
+
+static uint64_t bench_string_map_insert(BenchState *state, uint32_t operations) {
+	arena_reset(&state->trie_arena);
+	StringMap map;
+	string_map_init(&map, &state->trie_arena, 0);
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++) {
+		uint32_t *value = string_map_insert_value(&state->trie_arena, &map, state->keys[index % BENCH_KEY_COUNT], uint32_t);
+		*value = index;
+		checksum += (uintptr)value;
+	}
+	return checksum;
+}
+
+static uint64_t bench_string_map_lookup(BenchState *state, uint32_t operations) {
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++) {
+		String key = state->keys[state->lookup_order[index % BENCH_KEY_COUNT]];
+		checksum += *string_map_lookup_value(&state->lookup_map, key, uint32_t);
+	}
+	return checksum;
+}
+
+static uint64_t bench_string_hash64(BenchState *state, uint32_t operations) {
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++)
+		checksum ^= string_hash64(state->keys[index % BENCH_KEY_COUNT]);
+	return checksum;
+}
+
+static uint64_t bench_string_contains(BenchState *state, uint32_t operations) {
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++)
+		checksum += (uint64_t)string_contains(state->haystack, state->needle);
+	return checksum;
+}
+
+static uint64_t bench_string_format(BenchState *state, uint32_t operations) {
+	arena_reset(&state->scratch);
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++)
+		checksum += string_format(&state->scratch, "score %u at %.2f s, %s", index, index * .016f, "boss").length;
+	return checksum;
+}
+
+static bool32 bench_on_event(Event *event) {
+	return true;
+}
+
+static uint64_t bench_event_emit(BenchState *state, uint32_t operations) {
+	Event event = { .header = { .type = BENCH_EVENT_TYPE, .size = sizeof(EventCommon) } };
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++)
+		checksum += event_emit(&event);
+	return checksum;
+}
+
+// Stays in its state most ticks and hands over every 64th, like a phase timer would
+static uint32_t bench_fsm_on_update(void *context, float dt) {
+	BenchState *state = context;
+	return (++state->fsm_ticks & 63) == 0 ? state->fsm.current ^ 1 : STATE_CHANGE_NONE;
+}
+
+static uint64_t bench_fsm_update(BenchState *state, uint32_t operations) {
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++)
+		checksum += fsm_update(&state->fsm, 1.0f / 60.0f);
+	return checksum;
+}
+
+static uint64_t bench_entity_update_physics(BenchState *state, uint32_t operations) {
+	for (uint32_t index = 0; index < operations; index++)
+		entity_update_physics(&state->entities[index % BENCH_ENTITY_COUNT], .99f, 1.0f / 60.0f);
+	return (uint64_t)state->entities[0].body.position.x;
+}
+
+static uint64_t bench_entity_bodies_integrate(BenchState *state, uint32_t operations) {
+	for (uint32_t done = 0; done < operations; done += BENCH_ENTITY_COUNT)
+		entity_bodies_integrate(state->bodies, min(operations - done, (uint32_t)BENCH_ENTITY_COUNT), &state->motion);
+	return (uint64_t)state->bodies[0].position.x;
+}
+
+// The bullet against asteroid pass from game_state_asteroids_update, counting hits instead of destroying
+static uint64_t bench_asteroid_collision(BenchState *state, uint32_t operations) {
+	uint64_t hits = 0;
+	for (uint32_t pass = 0; pass < operations; pass++) {
+		for (uint32_t bullet_index = countof(state->bullets); bullet_index-- > 0;) {
+			EntityBody *bullet = &state->bullets[bullet_index];
+
+			for (uint32_t asteroid_index = 0; asteroid_index < countof(state->asteroids); asteroid_index++) {
+				EntityBody *asteroid = &state->asteroids[asteroid_index];
+				if (asteroid->collision_active == false || bullet->collision_active == false)
+					continue;
+
+				entity_body_sync_collision(bullet);
+				if (CheckCollisionRecs(bullet->collision_shape, asteroid->collision_shape)) {
+					hits++;
+					break;
+				}
+			}
+		}
+	}
+	return hits;
+}
+
+// What gameplay code does today, a MAX_* sized array and a count
+static uint64_t bench_fixed_array_append(BenchState *state, uint32_t operations) {
+	uint64_t checksum = 0;
+	for (uint32_t done = 0; done < operations; done += BENCH_ENTITY_COUNT) {
+		state->fixed_body_count = 0;
+		for (uint32_t index = 0; index < BENCH_ENTITY_COUNT && done + index < operations; index++) {
+			if (state->fixed_body_count < countof(state->fixed_bodies))
+				state->fixed_bodies[state->fixed_body_count++] = state->bodies[index];
+		}
+		checksum += state->fixed_body_count;
+	}
+	return checksum;
+}
+
+// Starts small in a reset arena so the cost includes growing, in place as the arena's last allocation
+static uint64_t bench_array_push(BenchState *state, uint32_t operations) {
+	uint64_t checksum = 0;
+	for (uint32_t done = 0; done < operations; done += BENCH_ENTITY_COUNT) {
+		arena_reset(&state->container_arena);
+		BenchBodyArray array;
+		bench_body_array_init(&array, &state->container_arena, 16);
+		for (uint32_t index = 0; index < BENCH_ENTITY_COUNT && done + index < operations; index++)
+			bench_body_array_push(&array, state->bodies[index]);
+		checksum += array.count;
+	}
+	return checksum;
+}
+
+static uint64_t bench_ring_push_pop(BenchState *state, uint32_t operations) {
+	uint64_t checksum = 0, item;
+	for (uint32_t index = 0; index < operations; index++) {
+		bench_tick_ring_push_overwrite(&state->tick_ring, index);
+		if ((index & 3) == 3 && bench_tick_ring_pop(&state->tick_ring, &item))
+			checksum += item;
+	}
+	bench_tick_ring_clear(&state->tick_ring);
+	return checksum;
+}
+
+// The linear scan gameplay code uses to find a slot by id
+static uint64_t bench_fixed_scan_lookup(BenchState *state, uint32_t operations) {
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++) {
+		uint64_t id = state->id_lookups[index % BENCH_ID_COUNT];
+		for (uint32_t slot = 0; slot < BENCH_ID_COUNT; slot++) {
+			if (state->id_slots[slot].id == id) {
+				checksum += state->id_slots[slot].value;
+				break;
+			}
+		}
+	}
+	return checksum;
+}
+
+static uint64_t bench_hash_map_lookup(BenchState *state, uint32_t operations) {
+	uint64_t checksum = 0;
+	for (uint32_t index = 0; index < operations; index++)
+		checksum += *bench_id_map_get(&state->id_map, state->id_lookups[index % BENCH_ID_COUNT]);
+	return checksum;
+}
+
+// From an empty map in a reset arena, rehashes included
+static uint64_t bench_hash_map_insert(BenchState *state, uint32_t operations) {
+	arena_reset(&state->container_arena);
+	BenchIdMap map;
+	bench_id_map_init(&map, &state->container_arena, 0);
+	for (uint32_t index = 0; index < operations; index++)
+		*bench_id_map_put(&map, hash_u64(index)) = index;
+	return map.count;
+}
+
+static const BenchCase bench_cases[] = {
+	{ "arena_push", "push", 4096, bench_arena_push },
+	{ "pool_alloc_free", "alloc or free", 2048, bench_pool_alloc_free },
+	{ "hash_trie_insert", "insert", BENCH_KEY_COUNT, bench_hash_trie_insert },
+	{ "hash_trie_lookup", "lookup", BENCH_KEY_COUNT, bench_hash_trie_lookup },
+	{ "string_map_insert", "insert", BENCH_KEY_COUNT, bench_string_map_insert },
+	{ "string_map_lookup", "lookup", BENCH_KEY_COUNT, bench_string_map_lookup },
+	{ "string_hash64", "hash", BENCH_KEY_COUNT, bench_string_hash64 },
+	{ "string_contains", "search", 256, bench_string_contains },
+	{ "string_format", "format", 256, bench_string_format },
+	{ "event_emit", "emit", 4096, bench_event_emit },
+	{ "fsm_update", "update", 4096, bench_fsm_update },
+	{ "entity_update_physics", "entity", BENCH_ENTITY_COUNT, bench_entity_update_physics },
+	{ "entity_bodies_integrate", "body", BENCH_ENTITY_COUNT, bench_entity_bodies_integrate },
+	{ "asteroid_collision", "pass", 16, bench_asteroid_collision },
+	{ "fixed_array_append", "append", BENCH_ENTITY_COUNT, bench_fixed_array_append },
+	{ "array_push", "push", BENCH_ENTITY_COUNT, bench_array_push },
+	{ "ring_push_pop", "push", 4096, bench_ring_push_pop },
+	{ "fixed_scan_lookup", "lookup", 4096, bench_fixed_scan_lookup },
+	{ "hash_map_lookup", "lookup", 4096, bench_hash_map_lookup },
+	{ "hash_map_insert", "insert", BENCH_KEY_COUNT, bench_hash_map_insert },
+};
+
+static void bench_body_scatter(EntityBody *body, Rng *rng, float size, float speed) {
+	*body = (EntityBody){
+		.position = { rng_float_range(rng, 0.0f, WINDOW_WIDTH), rng_float_range(rng, 0.0f, WINDOW_HEIGHT) },
+		.velocity = { rng_float_range(rng, -speed, speed), rng_float_range(rng, -speed, speed) },
+		.size = { size, size },
+		.collision_active = true,
+		.collision_shape = { 0, 0, size * .8f, size * .8f },
+	};
+	entity_body_sync_collision(body);
+}
+
+static bool32 bench_state_init(BenchState *state) {
+	*state = (BenchState){ 0 };
+	Rng rng = rng_seed(1, 0);
+
+	state->arena = arena_create(MiB(1));
+	state->scratch = arena_create(MiB(1));
+	state->trie_arena = arena_create(MiB(1));
+	state->container_arena = arena_create(MiB(1));
+	state->pool = allocator_pool(64, countof(state->pool_elements));
+	if (state->arena.memory == NULL || state->scratch.memory == NULL || state->trie_arena.memory == NULL ||
+		state->container_arena.memory == NULL || state->pool == NULL)
+		return false;
+
+	// Asset style keys with a shared prefix, the lookup trie is built once and probed in shuffled order
+	for (uint32_t index = 0; index < BENCH_KEY_COUNT; index++) {
+		state->keys[index] = string_format(&state->arena, "assets/textures/sprite_%04u.png", index);
+		state->lookup_order[index] = index;
+	}
+	for (uint32_t index = BENCH_KEY_COUNT; index-- > 1;) {
+		uint32_t other = (uint32_t)rng_range(&rng, 0, (int32_t)index);
+		uint32_t swap = state->lookup_order[index];
+		state->lookup_order[index] = state->lookup_order[other];
+		state->lookup_order[other] = swap;
+	}
+	string_map_init(&state->lookup_map, &state->arena, BENCH_KEY_COUNT);
+	for (uint32_t index = 0; index < BENCH_KEY_COUNT; index++) {
+		hash_trie_insert(&state->arena, &state->lookup_root, state->keys[index], BenchTrieEntry)->value = index;
+		*string_map_insert_value(&state->arena, &state->lookup_map, state->keys[index], uint32_t) = index;
+	}
+
+	state->haystack = string_format(&state->arena, "%s", "[INFO] world.c:192: Batch: 100 worlds on 8 threads, 22 won, 78 lost, "
+												 "0 quit, 0 timed out, mean score 5056.5, 48 reached the boss after 18.06 s");
+	state->needle = S("reached the boss");
+
+	event_system_startup();
+	if (event_subscribe(BENCH_EVENT_TYPE, bench_on_event) == false)
+		return false;
+
+	StateHandler handler = { .on_update = bench_fsm_on_update };
+	fsm_create(&state->fsm, 0, state);
+	fsm_state_add(&state->fsm, 0, &handler);
+	fsm_state_add(&state->fsm, 1, &handler);
+
+	for (uint32_t index = 0; index < BENCH_ENTITY_COUNT; index++) {
+		state->entities[index].active = true;
+		bench_body_scatter(&state->entities[index].body, &rng, 32.0f, 8.0f);
+		bench_body_scatter(&state->bodies[index], &rng, 32.0f, 8.0f);
+	}
+	state->motion = (EntityMotion){
+		.velocity_scale = 1.0f,
+		.drag = .99f,
+		.wrap = true,
+		.wrap_margin = .5f,
+		.bounds = { WINDOW_WIDTH, WINDOW_HEIGHT },
+	};
+
+	for (uint32_t index = 0; index < countof(state->asteroids); index++)
+		bench_body_scatter(&state->asteroids[index], &rng, (float)rng_range(&rng, 32, 96), 0.0f);
+	for (uint32_t index = 0; index < countof(state->bullets); index++)
+		bench_body_scatter(&state->bullets[index], &rng, 8.0f, 0.0f);
+
+	// Sparse ids like entity handles, looked up in a shuffled order
+	if (bench_id_map_init(&state->id_map, &state->arena, BENCH_ID_COUNT) == false ||
+		bench_tick_ring_init(&state->tick_ring, &state->arena, 256) == false)
+		return false;
+	for (uint32_t index = 0; index < BENCH_ID_COUNT; index++) {
+		uint64_t id = hash_u64(index + 1);
+		state->id_slots[index] = (BenchIdSlot){ .id = id, .value = index };
+		*bench_id_map_put(&state->id_map, id) = index;
+	}
+	for (uint32_t index = 0; index < BENCH_ID_COUNT; index++)
+		state->id_lookups[index] = state->id_slots[state->lookup_order[index] % BENCH_ID_COUNT].id;
+
+	return true;
+}
+
+static void bench_state_destroy(BenchState *state) {
+	pool_destroy(state->pool);
+	arena_destroy(&state->container_arena);
+	arena_destroy(&state->trie_arena);
+	arena_destroy(&state->scratch);
+	arena_destroy(&state->arena);
+	event_system_shutdown();
+}
+
+static int compare_double(const void *a, const void *b) {
+	double left = *(const double *)a, right = *(const double *)b;
+	return (left > right) - (left < right);
+}
+
+static void bench_measure(BenchState *state, const BenchCase *bench, double *samples, uint32_t sample_count, BenchResult *result) {
+	for (uint32_t warmup = 0; warmup < BENCH_WARMUP_SAMPLES; warmup++)
+		bench_sink += bench->run(state, bench->operations);
+
+	double total = 0;
+	for (uint32_t sample = 0; sample < sample_count; sample++) {
+		uint64_t start = clock_now_ns();
+		bench_sink += bench->run(state, bench->operations);
+		samples[sample] = (double)(clock_now_ns() - start) / bench->operations;
+		total += samples[sample];
+	}
+
+	// Nearest rank percentiles over the sorted samples
+	qsort(samples, sample_count, sizeof(*samples), compare_double);
+	*result = (BenchResult){
+		.bench = bench,
+		.median_ns = samples[(sample_count - 1) / 2],
+		.p99_ns = samples[(sample_count * 99 + 99) / 100 - 1],
+		.min_ns = samples[0],
+		.mean_ns = total / sample_count,
+	};
+}
+
+// Reads back the median of every case from a document this program wrote, not a general JSON parser
+static bool32 bench_baseline_find(const char *baseline, const char *name, double *median_ns) {
+	char pattern[128];
+	snprintf(pattern, sizeof(pattern), "\"name\": \"%s\"", name);
+
+	const char *entry = strstr(baseline, pattern);
+	if (entry == NULL)
+		return false;
+	const char *field = strstr(entry, "\"median_ns\":");
+	const char *next_entry = strstr(entry + 1, "\"name\":");
+	if (field == NULL || (next_entry && field > next_entry))
+		return false;
+
+	return sscanf(field, "\"median_ns\": %lf", median_ns) == 1;
+}
+
+static char *bench_read_file(const char *path) {
+	FILE *file = fopen(path, "rb");
+	if (file == NULL)
+		return NULL;
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *contents = length >= 0 ? malloc((usize)length + 1) : NULL;
+	if (contents && fread(contents, 1, (usize)length, file) != (usize)length) {
+		free(contents);
+		contents = NULL;
+	}
+	if (contents)
+		contents[length] = '\0';
+
+	fclose(file);
+	return contents;
+}
+
+static void bench_write_json(FILE *out, const BenchResult *results, uint32_t count, uint32_t sample_count, double threshold) {
+	fprintf(out, "{\n");
+	fprintf(out, "  \"samples\": %u,\n", sample_count);
+	fprintf(out, "  \"physics_backend\": \"%s\",\n", entity_physics_backend_name(entity_physics_backend()));
+	fprintf(out, "  \"benchmarks\": [\n");
+	for (uint32_t index = 0; index < count; index++) {
+		const BenchResult *result = &results[index];
+		fprintf(out, "    {\n");
+		fprintf(out, "      \"name\": \"%s\",\n", result->bench->name);
+		fprintf(out, "      \"unit\": \"%s\",\n", result->bench->unit);
+		fprintf(out, "      \"operations\": %u,\n", result->bench->operations);
+		fprintf(out, "      \"median_ns\": %.3f,\n", result->median_ns);
+		fprintf(out, "      \"p99_ns\": %.3f,\n", result->p99_ns);
+		fprintf(out, "      \"min_ns\": %.3f,\n", result->min_ns);
+		fprintf(out, "      \"mean_ns\": %.3f", result->mean_ns);
+		if (result->has_baseline) {
+			fprintf(out, ",\n      \"baseline_median_ns\": %.3f,\n", result->baseline_median_ns);
+			fprintf(out, "      \"change_percent\": %.2f,\n", result->change_percent);
+			fprintf(out, "      \"regressed\": %s", result->change_percent > threshold ? "true" : "false");
+		}
+		fprintf(out, "\n    }%s\n", index + 1 < count ? "," : "");
+	}
+	fprintf(out, "  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+	// stdout carries the JSON, keep the engine's info lines out of it
+	logger_set_level(LOG_LEVEL_WARN);
+
+	uint32_t sample_count = 50;
+	const char *filter = NULL, *out_path = NULL, *baseline_path = NULL;
+	double threshold = 10.0;
+
+	for (int arg = 1; arg < argc; arg++) {
+		if (strcmp(argv[arg], "--samples") == 0 && arg + 1 < argc)
+			sample_count = (uint32_t)strtoul(argv[++arg], NULL, 10);
+		else if (strcmp(argv[arg], "--filter") == 0 && arg + 1 < argc)
+			filter = argv[++arg];
+		else if (strcmp(argv[arg], "--out") == 0 && arg + 1 < argc)
+			out_path = argv[++arg];
+		else if (strcmp(argv[arg], "--baseline") == 0 && arg + 1 < argc)
+			baseline_path = argv[++arg];
+		else if (strcmp(argv[arg], "--threshold") == 0 && arg + 1 < argc)
+			threshold = strtod(argv[++arg], NULL);
+		else
+			sample_count = 0;
+	}
+	if (sample_count == 0) {
+		fprintf(stderr, "usage: %s [--samples count] [--filter text] [--out file] [--baseline file [--threshold percent]]\n", argv[0]);
+		return 1;
+	}
+
+	char *baseline = NULL;
+	if (baseline_path && (baseline = bench_read_file(baseline_path)) == NULL) {
+		fprintf(stderr, "could not read baseline %s\n", baseline_path);
+		return 1;
+	}
+
+	BenchState *state = malloc(sizeof(*state));
+	double *samples = malloc(sample_count * sizeof(*samples));
+	if (state == NULL || samples == NULL || bench_state_init(state) == false) {
+		fprintf(stderr, "could not set up benchmark state\n");
+		return 1;
+	}
+
+	BenchResult results[BENCH_MAX_CASES];
+	uint32_t result_count = 0, regressions = 0;
+	for (uint32_t index = 0; index < countof(bench_cases) && result_count < countof(results); index++) {
+		const BenchCase *bench = &bench_cases[index];
+		if (filter && strstr(bench->name, filter) == NULL)
+			continue;
+
+		BenchResult *result = &results[result_count++];
+		bench_measure(state, bench, samples, sample_count, result);
+
+		if (baseline && bench_baseline_find(baseline, bench->name, &result->baseline_median_ns) && result->baseline_median_ns > 0) {
+			result->has_baseline = true;
+			result->change_percent = (result->median_ns / result->baseline_median_ns - 1.0) * 100.0;
+			regressions += result->change_percent > threshold;
+		}
+	}
+
+	bench_write_json(stdout, results, result_count, sample_count, threshold);
+	if (out_path) {
+		FILE *out = fopen(out_path, "wb");
+		if (out == NULL) {
+			fprintf(stderr, "could not write %s\n", out_path);
+			return 1;
+		}
+		bench_write_json(out, results, result_count, sample_count, threshold);
+		fclose(out);
+	}
+
+	if (baseline)
+		fprintf(stderr, "%u of %u benchmarks regressed more than %.1f%% against %s\n", regressions, result_count, threshold, baseline_path);
+
+	bench_state_destroy(state);
+	free(samples);
+	free(state);
+	free(baseline);
+	return regressions ? 2 : 0;
+}
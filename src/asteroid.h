@@ -1,4 +1,6 @@
 #pragma once
+#include "core/entity_store.h"
+#include "core/random.h"
 #include "entity.h"
 #include "globals.h"
 
@@ -10,27 +12,29 @@ typedef enum {
 	ASTEROID_VARIANT_COUNT
 } AsteroidVariant;
 
+// Gameplay state, body and sprite live in their own columns
 typedef struct {
-	Entity entity;
 	AsteroidVariant variant;
-
 	Vector2 inital_target;
-	Vector2 velocity;
 
 	float rotation_speed;
 } Asteroid;
 
 typedef struct {
+	ENTITY_STORE_STORAGE(MAX_ASTEROIDS);
+	EntityBody bodies[MAX_ASTEROIDS];
+	EntitySprite sprites[MAX_ASTEROIDS];
 	Asteroid asteroids[MAX_ASTEROIDS];
-    uint32_t large_count;
+	uint32_t large_count;
 
 	Texture *texture;
+	Rng rng;
 
 	float spawn_timer;
 	float spawn_rate;
 } AsteroidSystem;
 
-void asteroid_system_init(AsteroidSystem *system, Texture *atlas);
+void asteroid_system_init(AsteroidSystem *system, Texture *atlas, Rng rng);
 void asteroid_system_update(AsteroidSystem *system, float dt);
 void asteroid_system_draw(AsteroidSystem *system, bool show_debug);
 
@@ -1,7 +1,18 @@
 #include "audio_manager.h"
+#include "core/atomic.h"
+#include "core/clock.h"
 #include "core/debug.h"
 #include "core/logger.h"
+#include "core/random.h"
+#include "core/thread.h"
+#include <math.h>
 #include <raylib.h>
+#include <string.h>
+
+#define MUSIC_COMMAND_CAPACITY 64
+#define AUDIO_THREAD_PERIOD_US 4000
+// Tracks a resimulation no longer wants fade out over this long instead of cutting off
+#define MUSIC_RECONCILE_FADE 0.25f
 
 typedef struct {
 	Sound sound;
@@ -11,10 +22,136 @@ typedef struct {
 	float fade_speed; // How fast this specific sound changes
 } LoopState;
 
+typedef enum {
+	SFX_PRIORITY_LOW,
+	SFX_PRIORITY_NORMAL,
+	SFX_PRIORITY_HIGH,
+	SFX_PRIORITY_CRITICAL,
+} SfxPriority;
+
+typedef struct {
+	const char *path;
+	uint32_t voice_count;
+	SfxPriority priority;
+} ClipInfo;
+
+// Voices are sound aliases sharing the clip's sample data, so a clip can overlap itself
+static const ClipInfo clip_infos[SFX_COUNT] = {
+	[SFX_PLAYER_SHOOT] = { "assets/sfx/shoot.wav", 4, SFX_PRIORITY_LOW },
+	[SFX_PLAYER_DEATH] = { "assets/sfx/player_death.wav", 1, SFX_PRIORITY_CRITICAL },
+
+	[SFX_PADDLE_HURT] = { "assets/sfx/paddle_hurt.wav", 3, SFX_PRIORITY_NORMAL },
+	[SFX_PADDLE_DEATH] = { "assets/sfx/paddle_death.wav", 2, SFX_PRIORITY_CRITICAL },
+	[SFX_PADDLE_HIT] = { "assets/sfx/paddle_hit.wav", 2, SFX_PRIORITY_NORMAL },
+
+	[SFX_BOSS_WARNING] = { "assets/sfx/boss_siren.wav", 1, SFX_PRIORITY_HIGH },
+	[SFX_BOSS_INTRO] = { "assets/music/phase_two_intro.wav", 1, SFX_PRIORITY_HIGH },
+};
+
+typedef struct {
+	const char *path;
+
+	// Tempo used to place beat and bar aligned transitions
+	float bpm;
+	uint32_t beats_per_bar;
+} MusicInfo;
+
+static const MusicInfo music_infos[MUSIC_COUNT] = {
+	[MUSIC_MENU] = { "assets/music/menu_music.wav", 120.f, 4 },
+	[MUSIC_ASTEROID] = { "assets/music/asteroid_music.wav", 120.f, 4 },
+	[MUSIC_BOSS_PONG] = { "assets/music/boss_music.wav", 140.f, 4 },
+	[MUSIC_BOSS_BREAKOUT] = { "assets/music/phase_two_main.wav", 140.f, 4 },
+};
+
+typedef enum {
+	MUSIC_COMMAND_PLAY,
+	MUSIC_COMMAND_STOP,
+	MUSIC_COMMAND_STOP_ALL,
+	MUSIC_COMMAND_FADE_OUT,
+	MUSIC_COMMAND_CROSSFADE,
+} MusicCommandType;
+
+typedef struct {
+	MusicCommandType type;
+	MusicID id;
+	MusicSync sync;
+	float duration;
+} MusicCommand;
+
+// Single producer (game thread), single consumer (audio thread)
+typedef struct {
+	MusicCommand commands[MUSIC_COMMAND_CAPACITY];
+	uint32_t write, read;
+} MusicCommandQueue;
+
+typedef struct {
+	float volume, applied_volume;
+	float fade_target, fade_rate;
+} MusicTrack;
+
+typedef struct {
+	bool32 active;
+	MusicID id;
+	float duration;
+
+	MusicID lead;
+	float boundary, last_played;
+} MusicTransition;
+
 typedef struct {
-	Sound clips[SFX_COUNT];
+	MusicCommandQueue queue;
+
+	// Owned by the audio thread
+	MusicTrack tracks[MUSIC_COUNT];
+	MusicTransition transition;
+	uint32_t live_mask;
+
+	// Owned by the game thread, filters repeated per-frame requests before they reach the queue
+	uint32_t requested_mask;
+	// While suppressed requests only move requested_mask, issued_mask is what the queue was last told
+	bool32 suppressed;
+	uint32_t issued_mask;
+	// Written by the game thread, read by the audio thread
+	uint32_t volume_bits[MUSIC_COUNT];
+
+	Thread *thread;
+	uint32_t running;
+} MusicScheduler;
+
+typedef struct {
+	Sound alias;
+	SoundID clip;
+	bool32 playing;
+
+	float volume;
+	uint64_t start_frame;
+} Voice;
+
+typedef struct {
+	Sound source;
+	uint32_t first_voice, voice_count;
+
+	// Triggers landing on the same frame collapse into a single voice
+	uint64_t trigger_frame;
+	uint32_t trigger_voice;
+} Clip;
+
+typedef struct {
+	Clip clips[SFX_COUNT];
+	Voice voices[AUDIO_MAX_VOICES];
+	uint32_t voice_count, playing_count;
+
 	LoopState loops[LOOP_COUNT];
 	Music music[MUSIC_COUNT];
+	MusicScheduler scheduler;
+
+	uint64_t frame;
+	// Headless runs never open the device, every request is dropped until it is. Only written
+	// before and after the game loop, so worlds simulated on worker threads never touch the rest
+	bool32 initialized;
+	bool32 sfx_muted;
+	// Presentation only, kept apart from the gameplay streams so sounds never shift a replay
+	Rng rng;
 } AudioSystem;
 
 static AudioSystem audio = { 0 };
@@ -25,44 +162,309 @@ static Sound load_sound(const char *path) {
 	return LoadSound(path);
 }
 
+static void music_volume_store(MusicID id, float volume) {
+	uint32_t bits;
+	memcpy(&bits, &volume, sizeof(bits));
+	atomic_store_relaxed(&audio.scheduler.volume_bits[id], bits);
+}
+
+static float music_volume_load(MusicID id) {
+	uint32_t bits = atomic_load_relaxed(&audio.scheduler.volume_bits[id]);
+	float volume;
+	memcpy(&volume, &bits, sizeof(volume));
+	return volume;
+}
+
+static bool32 music_command_push(MusicCommand command) {
+	MusicCommandQueue *queue = &audio.scheduler.queue;
+	if (audio.scheduler.suppressed)
+		return false;
+
+	uint32_t write = atomic_load_relaxed(&queue->write);
+	uint32_t read = atomic_load_acquire(&queue->read);
+	if (write - read >= MUSIC_COMMAND_CAPACITY) {
+		LOG_WARN("Audio: music command queue full, dropping command[%d]", command.type);
+		return false;
+	}
+
+	queue->commands[write % MUSIC_COMMAND_CAPACITY] = command;
+	atomic_store_release(&queue->write, write + 1);
+	return true;
+}
+
+static bool32 music_command_pop(MusicCommand *command) {
+	MusicCommandQueue *queue = &audio.scheduler.queue;
+
+	uint32_t read = atomic_load_relaxed(&queue->read);
+	uint32_t write = atomic_load_acquire(&queue->write);
+	if (read == write)
+		return false;
+
+	*command = queue->commands[read % MUSIC_COMMAND_CAPACITY];
+	atomic_store_release(&queue->read, read + 1);
+	return true;
+}
+
+static void music_track_start(MusicID id, float volume) {
+	MusicScheduler *scheduler = &audio.scheduler;
+	MusicTrack *track = &scheduler->tracks[id];
+
+	if ((scheduler->live_mask & (1u << id)) == 0) {
+		if (IsMusicValid(audio.music[id]) == false)
+			return;
+
+		PlayMusicStream(audio.music[id]);
+		scheduler->live_mask |= 1u << id;
+		track->volume = volume;
+		track->applied_volume = -1.0f;
+	}
+}
+
+static void music_track_stop(MusicID id) {
+	MusicScheduler *scheduler = &audio.scheduler;
+
+	if (scheduler->live_mask & (1u << id)) {
+		StopMusicStream(audio.music[id]);
+		scheduler->live_mask &= ~(1u << id);
+	}
+	scheduler->tracks[id].volume = 0.0f;
+}
+
+static void music_track_fade(MusicID id, float target, float duration) {
+	MusicTrack *track = &audio.scheduler.tracks[id];
+	track->fade_target = target;
+	track->fade_rate = duration > 0.0f ? 1.0f / duration : INFINITY;
+}
+
+static void music_crossfade_begin(MusicID id, float duration) {
+	MusicScheduler *scheduler = &audio.scheduler;
+
+	for (uint32_t index = 0; index < MUSIC_COUNT; ++index) {
+		if (index != id && (scheduler->live_mask & (1u << index)))
+			music_track_fade(index, 0.0f, duration);
+	}
+
+	music_track_start(id, 0.0f);
+	music_track_fade(id, 1.0f, duration);
+}
+
+// Loudest live track that is not already fading out, the beat grid follows it
+static bool32 music_find_lead(MusicID exclude, MusicID *lead) {
+	MusicScheduler *scheduler = &audio.scheduler;
+	float loudest = 0.0f;
+	bool32 found = false;
+
+	for (uint32_t index = 0; index < MUSIC_COUNT; ++index) {
+		MusicTrack *track = &scheduler->tracks[index];
+		if (index == exclude || (scheduler->live_mask & (1u << index)) == 0 || track->fade_target <= 0.0f)
+			continue;
+
+		if (found == false || track->volume > loudest) {
+			*lead = index;
+			loudest = track->volume;
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+// A track told to go quiet must not come back when a transition to it reaches its beat or bar
+static void music_transition_cancel(MusicID id) {
+	MusicTransition *transition = &audio.scheduler.transition;
+	if (transition->active && transition->id == id)
+		transition->active = false;
+}
+
+static void music_apply_command(MusicCommand *command) {
+	MusicScheduler *scheduler = &audio.scheduler;
+
+	switch (command->type) {
+		case MUSIC_COMMAND_PLAY: {
+			music_track_start(command->id, 1.0f);
+			music_track_fade(command->id, 1.0f, 0.0f);
+		} break;
+		case MUSIC_COMMAND_STOP: {
+			music_track_stop(command->id);
+			music_transition_cancel(command->id);
+		} break;
+		case MUSIC_COMMAND_STOP_ALL: {
+			for (uint32_t index = 0; index < MUSIC_COUNT; ++index)
+				music_track_stop(index);
+			scheduler->transition.active = false;
+		} break;
+		case MUSIC_COMMAND_FADE_OUT: {
+			music_track_fade(command->id, 0.0f, command->duration);
+			music_transition_cancel(command->id);
+		} break;
+		case MUSIC_COMMAND_CROSSFADE: {
+			MusicID lead = command->id;
+			if (command->sync == MUSIC_SYNC_NONE || music_find_lead(command->id, &lead) == false) {
+				music_crossfade_begin(command->id, command->duration);
+				break;
+			}
+
+			const MusicInfo *info = &music_infos[lead];
+			float beat = 60.0f / info->bpm;
+			float unit = command->sync == MUSIC_SYNC_BAR ? beat * info->beats_per_bar : beat;
+			float played = GetMusicTimePlayed(audio.music[lead]);
+
+			scheduler->transition = (MusicTransition){
+				.active = true,
+				.id = command->id,
+				.duration = command->duration,
+				.lead = lead,
+				.boundary = (floorf(played / unit) + 1.0f) * unit,
+				.last_played = played,
+			};
+		} break;
+	}
+}
+
+static void music_transition_update(void) {
+	MusicScheduler *scheduler = &audio.scheduler;
+	MusicTransition *transition = &scheduler->transition;
+	if (transition->active == false)
+		return;
+
+	bool32 start = (scheduler->live_mask & (1u << transition->lead)) == 0;
+	if (start == false) {
+		float played = GetMusicTimePlayed(audio.music[transition->lead]);
+		// A smaller play time means the lead looped past the boundary
+		start = played >= transition->boundary || played < transition->last_played;
+		transition->last_played = played;
+	}
+
+	if (start) {
+		transition->active = false;
+		music_crossfade_begin(transition->id, transition->duration);
+	}
+}
+
+// Drains commands, advances fades and refills only the streams that are live
+static void music_service(float dt) {
+	MusicScheduler *scheduler = &audio.scheduler;
+
+	MusicCommand command;
+	while (music_command_pop(&command))
+		music_apply_command(&command);
+
+	music_transition_update();
+
+	uint32_t live = scheduler->live_mask;
+	while (live) {
+		MusicID id = __builtin_ctz(live);
+		live &= live - 1;
+
+		MusicTrack *track = &scheduler->tracks[id];
+		if (track->volume < track->fade_target)
+			track->volume = fminf(track->volume + track->fade_rate * dt, track->fade_target);
+		else if (track->volume > track->fade_target)
+			track->volume = fmaxf(track->volume - track->fade_rate * dt, track->fade_target);
+
+		if (track->volume <= 0.0f && track->fade_target <= 0.0f) {
+			music_track_stop(id);
+			continue;
+		}
+
+		float volume = track->volume * music_volume_load(id);
+		if (volume != track->applied_volume) {
+			SetMusicVolume(audio.music[id], volume);
+			track->applied_volume = volume;
+		}
+
+		UpdateMusicStream(audio.music[id]);
+	}
+}
+
+#if THREADS_AVAILABLE
+static void audio_thread_main(void *user) {
+	uint64_t last = clock_now_ns();
+
+	while (atomic_load_acquire(&audio.scheduler.running)) {
+		uint64_t now = clock_now_ns();
+		music_service((float)clock_ns_to_seconds(now - last));
+		last = now;
+
+		thread_sleep_us(AUDIO_THREAD_PERIOD_US);
+	}
+}
+#endif
+
 void audio_initialize(void) {
 	InitAudioDevice();
+	audio.rng = rng_seed(0x41554449u, 0);
+	audio.initialized = true;
+
+	for (uint32_t clip_index = 0; clip_index < SFX_COUNT; ++clip_index) {
+		const ClipInfo *info = &clip_infos[clip_index];
+		Clip *clip = &audio.clips[clip_index];
 
-	audio.clips[SFX_PLAYER_SHOOT] = load_sound("assets/sfx/shoot.wav");
-	audio.clips[SFX_PLAYER_DEATH] = load_sound("assets/sfx/player_death.wav");
+		clip->source = load_sound(info->path);
+		clip->first_voice = audio.voice_count;
+		clip->trigger_frame = UINT64_MAX;
 
-	audio.clips[SFX_PADDLE_HURT] = load_sound("assets/sfx/paddle_hurt.wav");
-	audio.clips[SFX_PADDLE_DEATH] = load_sound("assets/sfx/paddle_death.wav");
-	audio.clips[SFX_PADDLE_HIT] = load_sound("assets/sfx/paddle_hit.wav");
+		if (IsSoundValid(clip->source) == false)
+			continue;
 
-	audio.clips[SFX_BOSS_WARNING] = load_sound("assets/sfx/boss_siren.wav");
-	audio.clips[SFX_BOSS_INTRO] = load_sound("assets/music/phase_two_intro.wav");
+		ASSERT(audio.voice_count + info->voice_count <= AUDIO_MAX_VOICES);
+		for (uint32_t voice_index = 0; voice_index < info->voice_count; ++voice_index) {
+			Voice *voice = &audio.voices[audio.voice_count++];
+			voice->alias = LoadSoundAlias(clip->source);
+			voice->clip = clip_index;
+		}
+		clip->voice_count = info->voice_count;
+	}
 
 	audio.loops[LOOP_PLAYER_ROCKET].sound = load_sound("assets/sfx/rocket_loop.wav");
 	audio.loops[LOOP_PLAYER_ROCKET].fade_speed = 5.0f;
 
-    audio.music[MUSIC_MENU] = LoadMusicStream("assets/music/menu_music.wav");
-    audio.music[MUSIC_ASTEROID] = LoadMusicStream("assets/music/asteroid_music.wav");
-	audio.music[MUSIC_BOSS_PONG] = LoadMusicStream("assets/music/boss_music.wav");
-	audio.music[MUSIC_BOSS_BREAKOUT] = LoadMusicStream("assets/music/phase_two_main.wav");
+	for (uint32_t music_index = 0; music_index < MUSIC_COUNT; ++music_index) {
+		audio.music[music_index] = LoadMusicStream(music_infos[music_index].path);
+		music_volume_store(music_index, 1.0f);
+	}
 
 	for (int i = 0; i < LOOP_COUNT; i++) {
 		audio.loops[i].volume = 0.0f;
 		audio.loops[i].max_volume = 1.0f;
 		audio.loops[i].active = false;
 	}
+
+#if THREADS_AVAILABLE
+	audio.scheduler.running = true;
+	audio.scheduler.thread = thread_create(audio_thread_main, NULL);
+#endif
 }
 
 void audio_unload(void) {
+	atomic_store_release(&audio.scheduler.running, false);
+	thread_join(audio.scheduler.thread);
+	audio.scheduler.thread = NULL;
+
+	for (uint32_t music_index = 0; music_index < MUSIC_COUNT; ++music_index)
+		UnloadMusicStream(audio.music[music_index]);
+	for (uint32_t voice_index = 0; voice_index < audio.voice_count; ++voice_index)
+		UnloadSoundAlias(audio.voices[voice_index].alias);
 	for (int i = 0; i < SFX_COUNT; i++)
-		UnloadSound(audio.clips[i]);
+		UnloadSound(audio.clips[i].source);
 	for (int i = 0; i < LOOP_COUNT; i++)
 		UnloadSound(audio.loops[i].sound);
 
 	CloseAudioDevice();
+	audio.initialized = false;
 }
 
 void audio_update(float dt) {
+	audio.frame++;
+
+	audio.playing_count = 0;
+	for (uint32_t voice_index = 0; voice_index < audio.voice_count; ++voice_index) {
+		Voice *voice = &audio.voices[voice_index];
+		if (voice->playing)
+			voice->playing = IsSoundPlaying(voice->alias);
+		audio.playing_count += voice->playing ? 1 : 0;
+	}
+
 	for (int i = 0; i < LOOP_COUNT; i++) {
 		LoopState *loop = &audio.loops[i];
 
@@ -89,58 +491,191 @@ void audio_update(float dt) {
 		}
 	}
 
-	for (uint32_t index = 0; index < MUSIC_COUNT; ++index) {
-		Music *music = &audio.music[index];
+	// Without an audio thread the streams are refilled from the frame loop instead
+	if (audio.scheduler.thread == NULL)
+		music_service(dt);
+}
+
+static void voice_stop(Voice *voice) {
+	StopSound(voice->alias);
+	voice->playing = false;
+	audio.playing_count--;
+}
+
+// Oldest playing voice at or below the given priority, or NULL when every voice outranks it
+static Voice *voice_find_steal_candidate(SfxPriority priority) {
+	Voice *candidate = NULL;
+	SfxPriority candidate_priority = priority;
+
+	for (uint32_t voice_index = 0; voice_index < audio.voice_count; ++voice_index) {
+		Voice *voice = &audio.voices[voice_index];
+		SfxPriority voice_priority = clip_infos[voice->clip].priority;
+		if (voice->playing == false || voice_priority > priority)
+			continue;
 
-		UpdateMusicStream(*music);
+		if (candidate == NULL || voice_priority < candidate_priority ||
+			(voice_priority == candidate_priority && voice->start_frame < candidate->start_frame)) {
+			candidate = voice;
+			candidate_priority = voice_priority;
+		}
 	}
+
+	return candidate;
 }
 
 void audio_sfx_play(SoundID id, float volume, bool32 varying_pitch) {
-	if (id < SFX_COUNT && IsSoundPlaying(audio.clips[id]) == false) {
-		if (varying_pitch)
-			SetSoundPitch(audio.clips[id], GetRandomValue(90, 100) / 100.0f);
-		SetSoundVolume(audio.clips[id], volume);
-		PlaySound(audio.clips[id]);
+	if (audio.initialized == false || id >= SFX_COUNT || audio.clips[id].voice_count == 0 || audio.sfx_muted)
+		return;
+
+	Clip *clip = &audio.clips[id];
+	SfxPriority priority = clip_infos[id].priority;
+
+	if (clip->trigger_frame == audio.frame) {
+		Voice *voice = &audio.voices[clip->trigger_voice];
+		if (volume > voice->volume) {
+			voice->volume = volume;
+			SetSoundVolume(voice->alias, volume);
+		}
+		return;
+	}
+
+	Voice *selected = NULL, *oldest = NULL;
+	for (uint32_t voice_index = clip->first_voice; voice_index < clip->first_voice + clip->voice_count; ++voice_index) {
+		Voice *voice = &audio.voices[voice_index];
+		if (voice->playing == false) {
+			selected = voice;
+			break;
+		}
+		if (oldest == NULL || voice->start_frame < oldest->start_frame)
+			oldest = voice;
+	}
+
+	if (selected == NULL) {
+		selected = oldest;
+		voice_stop(selected);
+	} else if (audio.playing_count >= AUDIO_VOICE_BUDGET) {
+		Voice *stolen = voice_find_steal_candidate(priority);
+		if (stolen == NULL)
+			return;
+		voice_stop(stolen);
+	}
+
+	if (varying_pitch)
+		SetSoundPitch(selected->alias, rng_range(&audio.rng, 90, 100) / 100.0f);
+	SetSoundVolume(selected->alias, volume);
+	PlaySound(selected->alias);
+
+	selected->playing = true;
+	selected->volume = volume;
+	selected->start_frame = audio.frame;
+	audio.playing_count++;
+
+	clip->trigger_frame = audio.frame;
+	clip->trigger_voice = (uint32_t)(selected - audio.voices);
+}
+
+void audio_sfx_set_muted(bool32 muted) {
+	if (audio.initialized)
+		audio.sfx_muted = muted;
+}
+
+void audio_music_set_suppressed(bool32 suppressed) {
+	MusicScheduler *scheduler = &audio.scheduler;
+	if (audio.initialized == false || scheduler->suppressed == suppressed)
+		return;
+
+	scheduler->suppressed = suppressed;
+	if (suppressed) {
+		scheduler->issued_mask = scheduler->requested_mask;
+		return;
+	}
+
+	// Only the difference is sent, tracks both sides want keep playing undisturbed
+	uint32_t stopped = scheduler->issued_mask & ~scheduler->requested_mask;
+	uint32_t started = scheduler->requested_mask & ~scheduler->issued_mask;
+	for (uint32_t index = 0; index < MUSIC_COUNT; ++index) {
+		if (stopped & (1u << index))
+			music_command_push((MusicCommand){ .type = MUSIC_COMMAND_FADE_OUT, .id = index, .duration = MUSIC_RECONCILE_FADE });
+		if (started & (1u << index))
+			music_command_push((MusicCommand){ .type = MUSIC_COMMAND_PLAY, .id = index });
 	}
 }
 
+uint32_t audio_music_requested(void) {
+	return audio.scheduler.requested_mask;
+}
+
+void audio_music_set_requested(uint32_t mask) {
+	if (audio.initialized && audio.scheduler.suppressed)
+		audio.scheduler.requested_mask = mask;
+}
+
 void audio_music_play(MusicID id) {
-	if (id < MUSIC_COUNT && IsMusicStreamPlaying(audio.music[id]) == false)
-		PlayMusicStream(audio.music[id]);
+	MusicScheduler *scheduler = &audio.scheduler;
+	if (audio.initialized == false || id >= MUSIC_COUNT || (scheduler->requested_mask & (1u << id)))
+		return;
+
+	scheduler->requested_mask |= 1u << id;
+	music_command_push((MusicCommand){ .type = MUSIC_COMMAND_PLAY, .id = id });
 }
 
 void audio_music_stop(MusicID id) {
-	if (id < MUSIC_COUNT && IsMusicStreamPlaying(audio.music[id]) == true)
-		StopMusicStream(audio.music[id]);
+	MusicScheduler *scheduler = &audio.scheduler;
+	if (audio.initialized == false || id >= MUSIC_COUNT || (scheduler->requested_mask & (1u << id)) == 0)
+		return;
+
+	scheduler->requested_mask &= ~(1u << id);
+	music_command_push((MusicCommand){ .type = MUSIC_COMMAND_STOP, .id = id });
 }
-void audio_music_set_volume(MusicID id, float volume) {
-	if (id < MUSIC_COUNT && IsMusicStreamPlaying(audio.music[id]) == true)
-        SetMusicVolume(audio.music[id], volume);
 
+void audio_music_set_volume(MusicID id, float volume) {
+	if (audio.initialized && id < MUSIC_COUNT)
+		music_volume_store(id, volume);
 }
 
 void audio_music_stop_all(void) {
-	for (uint32_t music_index = 0; music_index < MUSIC_COUNT; ++music_index)
-		audio_music_stop(music_index);
+	MusicScheduler *scheduler = &audio.scheduler;
+	if (audio.initialized == false || scheduler->requested_mask == 0)
+		return;
+
+	scheduler->requested_mask = 0;
+	music_command_push((MusicCommand){ .type = MUSIC_COMMAND_STOP_ALL });
+}
+
+void audio_music_fade_out(MusicID id, float duration) {
+	MusicScheduler *scheduler = &audio.scheduler;
+	if (audio.initialized == false || id >= MUSIC_COUNT || (scheduler->requested_mask & (1u << id)) == 0)
+		return;
+
+	scheduler->requested_mask &= ~(1u << id);
+	music_command_push((MusicCommand){ .type = MUSIC_COMMAND_FADE_OUT, .id = id, .duration = duration });
+}
+
+void audio_music_crossfade(MusicID id, float duration, MusicSync sync) {
+	MusicScheduler *scheduler = &audio.scheduler;
+	if (audio.initialized == false || id >= MUSIC_COUNT || scheduler->requested_mask == (1u << id))
+		return;
+
+	scheduler->requested_mask = 1u << id;
+	music_command_push((MusicCommand){ .type = MUSIC_COMMAND_CROSSFADE, .id = id, .sync = sync, .duration = duration });
 }
 
 void audio_loop_play(LoopID id) {
-	if (id < LOOP_COUNT)
+	if (audio.initialized && id < LOOP_COUNT)
 		audio.loops[id].active = true;
 }
 
 void audio_loop_stop(LoopID id) {
-	if (id < LOOP_COUNT)
+	if (audio.initialized && id < LOOP_COUNT)
 		audio.loops[id].active = false;
 }
 
 void audio_loop_set_pitch(LoopID id, float pitch) {
-	if (id < LOOP_COUNT)
+	if (audio.initialized && id < LOOP_COUNT)
 		SetSoundPitch(audio.loops[id].sound, pitch);
 }
 
 void audio_loop_set_volume(LoopID id, float volume) {
-	if (id < LOOP_COUNT)
+	if (audio.initialized && id < LOOP_COUNT)
 		audio.loops[id].max_volume = volume;
 }
@@ -2,6 +2,10 @@
 
 #include "common.h"
 
+// Sound aliases allocated across all clips, and how many of them may mix at once
+#define AUDIO_MAX_VOICES 32
+#define AUDIO_VOICE_BUDGET 12
+
 typedef enum {
 	SFX_PLAYER_SHOOT,
 	SFX_PLAYER_DEATH,
@@ -30,12 +34,20 @@ typedef enum {
 	MUSIC_COUNT,
 } MusicID;
 
+typedef enum {
+	MUSIC_SYNC_NONE,
+	MUSIC_SYNC_BEAT,
+	MUSIC_SYNC_BAR,
+} MusicSync;
+
 void audio_initialize(void);
 void audio_unload(void);
 
 void audio_update(float dt);
 
 void audio_sfx_play(SoundID id, float volume, bool32 varying_pitch);
+// Drops one-shot effects while set, for ticks being simulated a second time
+void audio_sfx_set_muted(bool32 muted);
 void audio_loop_play(LoopID id);
 void audio_loop_stop(LoopID id);
 
@@ -44,5 +56,17 @@ void audio_music_set_volume(MusicID id, float volume);
 void audio_music_stop(MusicID id);
 void audio_music_stop_all(void);
 
+// While set, music requests are only recorded, for ticks being simulated a second time.
+// Clearing it fades out or starts whatever differs from what was requested before
+void audio_music_set_suppressed(bool32 suppressed);
+// Bit per MusicID, what the game last asked to be playing
+uint32_t audio_music_requested(void);
+// Puts back a request state saved with a snapshot, only while suppressed
+void audio_music_set_requested(uint32_t mask);
+
+// Fades every other live track out while `id` fades in, optionally waiting for the next beat or bar of the current track
+void audio_music_crossfade(MusicID id, float duration, MusicSync sync);
+void audio_music_fade_out(MusicID id, float duration);
+
 void audio_loop_set_pitch(LoopID id, float pitch);
 void audio_loop_set_volume(LoopID id, float volume);
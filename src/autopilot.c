@@ -0,0 +1,376 @@
+#include "autopilot.h"
+
+#include "globals.h"
+
+#include <math.h>
+#include <raymath.h>
+
+// Asteroids and balls move per second, the ship and its bullets per tick
+#define AUTOPILOT_TICK_DT (1.0f / 60.0f)
+#define AUTOPILOT_SHIP_RADIUS 24.0f
+#define AUTOPILOT_MAX_THREATS (MAX_ASTEROIDS + BRICK_MAX_PROJECTILES + 8)
+// Boss paddles guard the side walls, the ship keeps to a column in the middle and
+// waits above or below the spot balls launch from
+#define AUTOPILOT_HOME_SPAN_X 150.0f
+
+typedef struct {
+	Vector2 position;
+	// Per tick
+	Vector2 velocity;
+	Vector2 half_size;
+
+	// Tick the threat appears at `position`, for shots that have not been returned yet
+	float start_time;
+	// Reflects off the top and bottom of the screen like the boss balls
+	bool32 bounces;
+} Threat;
+
+typedef struct {
+	const Threat *threat;
+	// Ticks until contact and where the threat sits relative to the ship then
+	float time;
+	Vector2 offset;
+} ThreatContact;
+
+static float lerp(float from, float to, float t) {
+	return from + (to - from) * t;
+}
+
+// Shortest offset on the wrapping asteroid field
+static Vector2 wrap_offset(Vector2 offset, bool32 wrap) {
+	if (wrap == false)
+		return offset;
+
+	if (offset.x > WINDOW_WIDTH * .5f)
+		offset.x -= WINDOW_WIDTH;
+	else if (offset.x < -WINDOW_WIDTH * .5f)
+		offset.x += WINDOW_WIDTH;
+	if (offset.y > WINDOW_HEIGHT * .5f)
+		offset.y -= WINDOW_HEIGHT;
+	else if (offset.y < -WINDOW_HEIGHT * .5f)
+		offset.y += WINDOW_HEIGHT;
+	return offset;
+}
+
+// Height after bouncing between the top and bottom walls, for a body of the given half height
+static float bounce_fold(float y, float half_height) {
+	float span = WINDOW_HEIGHT - 2.0f * half_height;
+	if (span <= 0.0f)
+		return WINDOW_HEIGHT * .5f;
+
+	float folded = fmodf(y - half_height, 2.0f * span);
+	if (folded < 0.0f)
+		folded += 2.0f * span;
+	if (folded > span)
+		folded = 2.0f * span - folded;
+	return folded + half_height;
+}
+
+static Vector2 threat_position_at(const Threat *threat, float time) {
+	Vector2 position = Vector2Add(threat->position, Vector2Scale(threat->velocity, time - threat->start_time));
+	if (threat->bounces)
+		position.y = bounce_fold(position.y, threat->half_size.y);
+	return position;
+}
+
+// Rotation the ship needs to face `direction`, same convention as player_update
+static float heading_of(Vector2 direction) {
+	return atan2f(direction.x, -direction.y) * RAD2DEG;
+}
+
+static float angle_difference(float target, float current) {
+	float difference = fmodf(target - current, 360.0f);
+	if (difference > 180.0f)
+		difference -= 360.0f;
+	else if (difference < -180.0f)
+		difference += 360.0f;
+	return difference;
+}
+
+static void threat_push(Threat *threats, uint32_t *count, Threat threat) {
+	if (*count < AUTOPILOT_MAX_THREATS)
+		threats[(*count)++] = threat;
+}
+
+// Upright paddles send the ball back at where the ship is when it arrives, within 45 degrees
+// of straight across. Predicting that return lets the ship be moving before the ball turns around.
+static void threats_push_return(Threat *threats, uint32_t *count, const PaddleEncounter *boss, const Ball *ball, const EntityBody *ship) {
+	Vector2 velocity = Vector2Scale(ball->velocity, AUTOPILOT_TICK_DT);
+	if (fabsf(velocity.x) < 0.01f)
+		return;
+
+	uint32_t paddle_index = velocity.x < 0.0f ? 0 : 1;
+	const Entity *paddle = &boss->paddles[paddle_index].entity;
+	if (paddle->active == false || paddle->body.collision_shape.height <= paddle->body.collision_shape.width)
+		return;
+
+	float face = paddle->body.position.x + (paddle_index == 0 ? 1.0f : -1.0f) * (paddle->body.collision_shape.width * .5f + ball->radius);
+	float time = (face - ball->position.x) / velocity.x;
+	if (time < 0.0f)
+		return;
+
+	Vector2 impact = { face, bounce_fold(ball->position.y + velocity.y * time, ball->radius) };
+	Vector2 ship_then = Vector2Add(ship->position, Vector2Scale(ship->velocity, time));
+	float direction_x = paddle_index == 0 ? 1.0f : -1.0f;
+	float across = (ship_then.x - impact.x) * direction_x;
+	float slope = across > 0.01f ? clamp((ship_then.y - impact.y) / across, -1.0f, 1.0f) : 0.0f;
+
+	float speed = fminf(Vector2Length(ball->velocity) + 100.0f, BALL_SPEED_MAX) * AUTOPILOT_TICK_DT;
+	threat_push(threats, count, (Threat){
+		.position = impact,
+		.velocity = Vector2Scale(Vector2Normalize((Vector2){ direction_x, slope }), speed),
+		.half_size = { ball->radius, ball->radius },
+		.start_time = time,
+		.bounces = true,
+	});
+}
+
+static uint32_t threats_gather(const GameWorld *world, StateID phase, const EntityBody *ship, Threat *threats) {
+	uint32_t count = 0;
+
+	if (phase == GAME_PHASE_ASTEROIDS) {
+		const AsteroidSystem *asteroids = &world->asteroid_system;
+		for (uint32_t index = 0; index < asteroids->store.count; index++) {
+			const EntityBody *body = &asteroids->bodies[index];
+			if (body->collision_active)
+				threat_push(threats, &count, (Threat){
+					.position = body->position,
+					.velocity = Vector2Scale(body->velocity, AUTOPILOT_TICK_DT),
+					.half_size = { body->collision_shape.width * .5f, body->collision_shape.height * .5f },
+				});
+		}
+		return count;
+	}
+
+	const PaddleEncounter *boss = &world->boss;
+	// Paddles still sliding in are not solid yet but will be soon
+	for (uint32_t index = 0; index < countof(boss->paddles); index++) {
+		const EntityBody *body = &boss->paddles[index].entity.body;
+		if (boss->paddles[index].entity.active)
+			threat_push(threats, &count, (Threat){
+				.position = body->position,
+				.half_size = { body->collision_shape.width * .5f, body->collision_shape.height * .5f },
+			});
+	}
+	// A parked ball is about to launch at the ship, give it room too
+	for (uint32_t index = 0; index < countof(boss->balls); index++) {
+		const Ball *ball = &boss->balls[index];
+		if (ball->radius <= 0.0f)
+			continue;
+
+		threat_push(threats, &count, (Threat){
+			.position = ball->position,
+			.velocity = ball->active ? Vector2Scale(ball->velocity, AUTOPILOT_TICK_DT) : (Vector2){ 0 },
+			.half_size = { ball->radius, ball->radius },
+			.bounces = ball->active,
+		});
+		if (ball->active)
+			threats_push_return(threats, &count, boss, ball, ship);
+	}
+	for (uint32_t index = 0; index < boss->projectiles.store.count; index++) {
+		const EntityBody *body = &boss->projectiles.bodies[index];
+		threat_push(threats, &count, (Threat){ .position = body->position, .velocity = body->velocity, .half_size = { 6.0f, 6.0f } });
+	}
+
+	return count;
+}
+
+// Steps every threat and the drifting ship forward and keeps the one that touches it first
+static bool32 threats_earliest_contact(const Threat *threats, uint32_t count, const EntityBody *ship, bool32 wrap,
+	float horizon, float margin, ThreatContact *contact) {
+	contact->threat = NULL;
+	contact->time = horizon + 1.0f;
+
+	for (uint32_t index = 0; index < count; index++) {
+		const Threat *threat = &threats[index];
+		float reach_x = threat->half_size.x + AUTOPILOT_SHIP_RADIUS + margin;
+		float reach_y = threat->half_size.y + AUTOPILOT_SHIP_RADIUS + margin;
+
+		for (float time = ceilf(threat->start_time); time < contact->time; time += 2.0f) {
+			Vector2 ship_then = Vector2Add(ship->position, Vector2Scale(ship->velocity, time));
+			Vector2 offset = wrap_offset(Vector2Subtract(threat_position_at(threat, time), ship_then), wrap);
+			if (fabsf(offset.x) <= reach_x && fabsf(offset.y) <= reach_y) {
+				contact->threat = threat;
+				contact->time = time;
+				contact->offset = offset;
+				break;
+			}
+		}
+	}
+
+	return contact->threat != NULL;
+}
+
+// Out of the threat's path: sideways to its motion, preferring the side that needs the
+// shortest turn without crossing in front of the threat or running into the arena walls
+static Vector2 evade_direction(const ThreatContact *contact, const EntityBody *ship, bool32 walled) {
+	Vector2 away = Vector2Negate(contact->offset);
+	Vector2 relative_velocity = Vector2Subtract(contact->threat->velocity, ship->velocity);
+
+	if (Vector2LengthSqr(relative_velocity) < 0.25f || contact->time < 4.0f)
+		return Vector2Normalize(away);
+
+	Vector2 side = Vector2Normalize((Vector2){ -relative_velocity.y, relative_velocity.x });
+	Vector2 sides[2] = { side, Vector2Negate(side) };
+	float best_cost = INFINITY;
+	Vector2 best = side;
+
+	for (uint32_t index = 0; index < countof(sides); index++) {
+		float cost = fabsf(angle_difference(heading_of(sides[index]), ship->rotation));
+		// Crossing the threat's path to reach the other side is only worth it for a much shorter turn
+		if (Vector2DotProduct(away, sides[index]) < -AUTOPILOT_SHIP_RADIUS)
+			cost += 150.0f;
+
+		Vector2 landing = Vector2Add(ship->position, Vector2Scale(sides[index], 160.0f));
+		if (walled && fabsf(landing.x - WINDOW_WIDTH * .5f) > AUTOPILOT_HOME_SPAN_X * 2.0f)
+			cost += 360.0f;
+
+		if (cost < best_cost) {
+			best_cost = cost;
+			best = sides[index];
+		}
+	}
+
+	return best;
+}
+
+// Nearest asteroid or solid paddle, led by the bullet's flight time
+static bool32 target_find(const GameWorld *world, StateID phase, const Player *player, Vector2 *aim, float *distance, float *radius) {
+	const EntityBody *ship = &player->entity.body;
+	bool32 wrap = phase == GAME_PHASE_ASTEROIDS;
+	bool32 found = false;
+	*distance = INFINITY;
+
+	const EntityBody *bodies = NULL;
+	uint32_t count = 0;
+	const EntityBody *paddle_bodies[countof(world->boss.paddles)];
+	float velocity_scale = AUTOPILOT_TICK_DT;
+
+	if (phase == GAME_PHASE_ASTEROIDS) {
+		bodies = world->asteroid_system.bodies;
+		count = world->asteroid_system.store.count;
+	} else {
+		for (uint32_t index = 0; index < countof(world->boss.paddles); index++) {
+			const Entity *paddle = &world->boss.paddles[index].entity;
+			if (paddle->active && paddle->body.collision_active)
+				paddle_bodies[count++] = &paddle->body;
+		}
+		velocity_scale = 0.0f;
+	}
+
+	for (uint32_t index = 0; index < count; index++) {
+		const EntityBody *body = bodies ? &bodies[index] : paddle_bodies[index];
+		if (body->collision_active == false)
+			continue;
+
+		Vector2 offset = wrap_offset(Vector2Subtract(body->position, ship->position), wrap);
+		float length = Vector2Length(offset);
+		if (length >= *distance)
+			continue;
+
+		Vector2 velocity = Vector2Scale(body->velocity, velocity_scale);
+		for (uint32_t pass = 0; pass < 2; pass++) {
+			float flight = Vector2Length(offset) / player->info.speed;
+			offset = wrap_offset(Vector2Add(Vector2Subtract(body->position, ship->position), Vector2Scale(velocity, flight)), wrap);
+		}
+
+		*aim = offset;
+		*distance = length;
+		*radius = max(body->collision_shape.width, body->collision_shape.height) * .5f;
+		found = true;
+	}
+
+	return found;
+}
+
+static void steer_towards(Vector2 direction, const EntityBody *ship, float rotation_speed, uint16_t *down) {
+	float error = angle_difference(heading_of(direction), ship->rotation);
+	if (error > rotation_speed * .5f)
+		*down |= 1u << INPUT_TURN_RIGHT;
+	else if (error < -rotation_speed * .5f)
+		*down |= 1u << INPUT_TURN_LEFT;
+}
+
+static bool32 facing(Vector2 direction, const EntityBody *ship, float tolerance) {
+	return fabsf(angle_difference(heading_of(direction), ship->rotation)) <= tolerance;
+}
+
+static uint16_t autopilot_fly(Autopilot *autopilot, const GameWorld *world, StateID phase, const Player *player) {
+	const EntityBody *ship = &player->entity.body;
+	float aggression = clamp(autopilot->aggression, 0.0f, 1.0f);
+	bool32 wrap = phase == GAME_PHASE_ASTEROIDS;
+	uint16_t down = 0;
+
+	Threat threats[AUTOPILOT_MAX_THREATS];
+	uint32_t threat_count = threats_gather(world, phase, ship, threats);
+
+	// Careful pilots look further ahead and keep more room
+	float horizon = lerp(60.0f, 30.0f, aggression) * (wrap ? 1.0f : 1.5f);
+	float margin = lerp(40.0f, 12.0f, aggression);
+
+	Vector2 aim = { 0 };
+	float target_distance = 0.0f, target_radius = 0.0f;
+	bool32 has_target = target_find(world, phase, player, &aim, &target_distance, &target_radius);
+
+	ThreatContact contact = { 0 };
+	if (threats_earliest_contact(threats, threat_count, ship, wrap, horizon, margin, &contact)) {
+		Vector2 escape = evade_direction(&contact, ship, wrap == false);
+		steer_towards(escape, ship, player->rotation_speed, &down);
+		if (facing(escape, ship, 70.0f))
+			down |= 1u << INPUT_THRUST;
+	} else if (phase == GAME_PHASE_BOSS && fabsf(ship->position.x - WINDOW_WIDTH * .5f) > AUTOPILOT_HOME_SPAN_X) {
+		// Drifting towards a paddle, come back to the middle first
+		float home_y = ship->position.y < WINDOW_HEIGHT * .5f ? WINDOW_HEIGHT * .25f : WINDOW_HEIGHT * .75f;
+		Vector2 home = Vector2Subtract((Vector2){ WINDOW_WIDTH * .5f, home_y }, ship->position);
+		steer_towards(home, ship, player->rotation_speed, &down);
+		if (facing(home, ship, 30.0f) && Vector2Length(ship->velocity) < 4.0f)
+			down |= 1u << INPUT_THRUST;
+	} else if (has_target) {
+		steer_towards(aim, ship, player->rotation_speed, &down);
+
+		// Aggressive pilots close the distance, careful ones let targets come to them
+		float engage_distance = phase == GAME_PHASE_ASTEROIDS ? lerp(420.0f, 180.0f, aggression) : INFINITY;
+		if (target_distance > engage_distance && facing(aim, ship, 20.0f) && Vector2Length(ship->velocity) < lerp(3.0f, 6.0f, aggression))
+			down |= 1u << INPUT_THRUST;
+	}
+
+	// Shoot whenever a target lines up, even mid-dodge, as fast as fire_rate allows
+	// Wide targets forgive more, careful pilots wait until the shot is well inside the silhouette
+	float tolerance = atan2f(target_radius * lerp(.4f, .8f, aggression), target_distance) * RAD2DEG;
+	float range = player->info.speed / AUTOPILOT_TICK_DT * BULLET_LIFTIME;
+	if (has_target && target_distance < range && facing(aim, ship, tolerance) && player->info.fire_timer >= player->info.fire_rate &&
+		(autopilot->previous_down & (1u << INPUT_FIRE)) == 0)
+		down |= 1u << INPUT_FIRE;
+
+	return down;
+}
+
+void autopilot_init(Autopilot *autopilot, float aggression) {
+	*autopilot = (Autopilot){ .aggression = aggression };
+}
+
+InputState autopilot_next(Autopilot *autopilot, const GameWorld *world, uint32_t player_index) {
+	StateID phase = world->state_machine.current;
+	const Player *player = &world->players[player_index < world->player_count ? player_index : 0];
+	uint16_t down = 0;
+
+	switch (phase) {
+		case GAME_PHASE_ASTEROIDS:
+		case GAME_PHASE_BOSS:
+			if (player->entity.active)
+				down = autopilot_fly(autopilot, world, phase, player);
+			break;
+		// Screens move on with a press, tap every other tick
+		case GAME_PHASE_MENU:
+		case GAME_PHASE_WIN:
+			down = (autopilot->previous_down & (1u << INPUT_CONFIRM)) ? 0 : 1u << INPUT_CONFIRM;
+			break;
+		case GAME_PHASE_LOSE:
+			down = (autopilot->previous_down & (1u << INPUT_FIRE)) ? 0 : 1u << INPUT_FIRE;
+			break;
+	}
+
+	InputState input = { .down = down, .pressed = (uint16_t)(down & ~autopilot->previous_down) };
+	autopilot->previous_down = down;
+	return input;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "common.h"
+#include "input.h"
+#include "world.h"
+
+// Plays a ship from the same InputState a keyboard produces. It fires at the
+// nearest asteroid or paddle, dodges anything predicted to hit the ship and
+// clicks through the menu, win and lose screens, so unattended runs reach every phase.
+typedef struct {
+	// 0 keeps its distance and only takes clean shots, 1 closes in and fires at wider angles
+	float aggression;
+
+	// Buttons held last tick, a press needs the button to have been up
+	uint16_t previous_down;
+} Autopilot;
+
+void autopilot_init(Autopilot *autopilot, float aggression);
+InputState autopilot_next(Autopilot *autopilot, const GameWorld *world, uint32_t player_index);
@@ -0,0 +1,168 @@
+#include "alloc_tracker.h"
+
+#include "core/logger.h"
+#include "core/profiler.h"
+#include "core/thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if ALLOC_TRACKER_AVAILABLE
+	#include <execinfo.h>
+#endif
+
+// Violations past this many are only counted, a leak in a hot loop would bury the log
+#define ALLOC_TRACKER_REPORTS 8
+#define ALLOC_TRACKER_BACKTRACE_DEPTH 32
+
+typedef struct {
+	bool32 in_frame, steady;
+	// Set while a violation is reported, the logger and backtrace may allocate themselves
+	bool32 reporting;
+	uint32_t frame_allocations;
+
+	AllocTrackerStats stats;
+	AllocZoneCount zones[ALLOC_TRACKER_MAX_ZONES];
+	uint32_t zone_count;
+} AllocTracker;
+
+// Read inside malloc, so nothing here may allocate on first touch
+static THREAD_LOCAL AllocTracker tracker;
+static bool32 tracker_fatal;
+
+void alloc_tracker_set_fatal(bool32 fatal) {
+	tracker_fatal = fatal;
+}
+
+void alloc_tracker_frame_begin(void) {
+	tracker.in_frame = true;
+	tracker.steady = false;
+	tracker.frame_allocations = 0;
+}
+
+uint32_t alloc_tracker_frame_end(void) {
+	if (tracker.in_frame == false)
+		return 0;
+
+	tracker.in_frame = false;
+	tracker.steady = false;
+	tracker.stats.frames++;
+	tracker.stats.last_frame = tracker.frame_allocations;
+	tracker.stats.frame_max = max(tracker.stats.frame_max, tracker.frame_allocations);
+	return tracker.frame_allocations;
+}
+
+void alloc_tracker_set_steady(bool32 steady) {
+	tracker.steady = steady && tracker.in_frame;
+}
+
+AllocTrackerStats alloc_tracker_stats(void) {
+	return tracker.stats;
+}
+
+static int compare_zone_count(const void *a, const void *b) {
+	const AllocZoneCount *left = a, *right = b;
+	return (left->allocations < right->allocations) - (left->allocations > right->allocations);
+}
+
+uint32_t alloc_tracker_zones(AllocZoneCount *zones, uint32_t capacity) {
+	tracker.reporting = true;
+	AllocZoneCount sorted[ALLOC_TRACKER_MAX_ZONES];
+	memcpy(sorted, tracker.zones, tracker.zone_count * sizeof(*sorted));
+	qsort(sorted, tracker.zone_count, sizeof(*sorted), compare_zone_count);
+	tracker.reporting = false;
+
+	uint32_t count = min(capacity, tracker.zone_count);
+	memcpy(zones, sorted, count * sizeof(*zones));
+	return count;
+}
+
+#if ALLOC_TRACKER_AVAILABLE
+
+static AllocZoneCount *alloc_tracker_zone(const char *name) {
+	for (uint32_t index = 0; index < tracker.zone_count; index++)
+		if (strcmp(tracker.zones[index].zone, name) == 0)
+			return &tracker.zones[index];
+
+	// A full table lumps new zones into the last slot rather than dropping them
+	if (tracker.zone_count == ALLOC_TRACKER_MAX_ZONES) {
+		tracker.zones[ALLOC_TRACKER_MAX_ZONES - 1].zone = "other";
+		return &tracker.zones[ALLOC_TRACKER_MAX_ZONES - 1];
+	}
+	tracker.zones[tracker.zone_count] = (AllocZoneCount){ .zone = name };
+	return &tracker.zones[tracker.zone_count++];
+}
+
+static void alloc_tracker_violation(usize size, const char *zone) {
+	tracker.stats.violations++;
+	if (tracker.stats.violations > ALLOC_TRACKER_REPORTS && tracker_fatal == false)
+		return;
+
+	LOG_CAT(LOG_CATEGORY_CORE, LOG_LEVEL_ERROR, "Alloc: %llu bytes allocated in steady frame %llu, zone %s",
+		(unsigned long long)size, (unsigned long long)tracker.stats.frames, zone);
+	if (tracker.stats.violations == ALLOC_TRACKER_REPORTS && tracker_fatal == false)
+		LOG_CAT(LOG_CATEGORY_CORE, LOG_LEVEL_ERROR, "Alloc: further violations are only counted");
+	logger_flush();
+
+	void *frames[ALLOC_TRACKER_BACKTRACE_DEPTH];
+	int depth = backtrace(frames, countof(frames));
+	// Writes straight to stderr without allocating
+	backtrace_symbols_fd(frames, depth, 2);
+
+	if (tracker_fatal)
+		abort();
+}
+
+static void alloc_tracker_note(usize size) {
+	if (tracker.reporting)
+		return;
+
+	tracker.stats.allocations++;
+	tracker.stats.bytes += size;
+	if (tracker.in_frame == false)
+		return;
+
+	tracker.reporting = true;
+	tracker.frame_allocations++;
+	const char *zone = profiler_zone_current();
+	AllocZoneCount *count = alloc_tracker_zone(zone ? zone : "frame");
+	count->allocations++;
+	if (tracker.steady) {
+		count->violations++;
+		alloc_tracker_violation(size, count->zone);
+	}
+	tracker.reporting = false;
+}
+
+// glibc's own entry points, interposing them is supported as long as the whole family is replaced
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void __libc_free(void *pointer);
+
+void *malloc(size_t size) {
+	alloc_tracker_note(size);
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+	alloc_tracker_note(count * size);
+	return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+	// Shrinking to nothing frees, anything else may move the block
+	if (size)
+		alloc_tracker_note(size);
+	else if (pointer && tracker.reporting == false)
+		tracker.stats.frees++;
+	return __libc_realloc(pointer, size);
+}
+
+void free(void *pointer) {
+	if (pointer && tracker.reporting == false)
+		tracker.stats.frees++;
+	__libc_free(pointer);
+}
+
+#endif
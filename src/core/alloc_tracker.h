@@ -0,0 +1,50 @@
+#pragma once
+
+#include "common.h"
+
+// Counts heap allocations per frame and per profiler zone by interposing malloc,
+// calloc, realloc and free. Built in with the ALLOC_TRACKER CMake option, which
+// drops the sanitizers since they interpose the same functions. Without it every
+// call here does nothing and the counts stay 0.
+//
+//     alloc_tracker_frame_begin();
+//     alloc_tracker_set_steady(true);
+//     world_update(...);
+//     alloc_tracker_set_steady(false);
+//     alloc_tracker_frame_end();
+//
+// An allocation while steady is a violation, logged with its zone and a backtrace.
+
+#if defined(ALLOC_TRACKER) && defined(__linux__) && !defined(PLATFORM_WEB)
+	#define ALLOC_TRACKER_AVAILABLE 1
+#else
+	#define ALLOC_TRACKER_AVAILABLE 0
+#endif
+
+#define ALLOC_TRACKER_MAX_ZONES 32
+
+// Counts are per thread, worlds on batch threads keep their own
+typedef struct {
+	uint64_t allocations, frees, bytes;
+	uint64_t frames, violations;
+	uint32_t last_frame, frame_max;
+} AllocTrackerStats;
+
+typedef struct {
+	// Innermost profiler zone open at the allocation, "frame" outside every zone
+	const char *zone;
+	uint64_t allocations, violations;
+} AllocZoneCount;
+
+// Violations abort instead of logging
+void alloc_tracker_set_fatal(bool32 fatal);
+
+void alloc_tracker_frame_begin(void);
+// Returns the allocations made since alloc_tracker_frame_begin
+uint32_t alloc_tracker_frame_end(void);
+// Allocations from here on are violations, only meaningful inside a frame
+void alloc_tracker_set_steady(bool32 steady);
+
+AllocTrackerStats alloc_tracker_stats(void);
+// In-frame allocations by zone, busiest first, returns how many were written
+uint32_t alloc_tracker_zones(AllocZoneCount *zones, uint32_t capacity);
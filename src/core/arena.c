@@ -5,10 +5,13 @@
 #include "core/debug.h"
 #include "core/logger.h"
 #include "core/memory.h"
+#include "core/thread.h"
 
 #include <stdlib.h>
+#include <string.h>
 
-static Arena scratch_arenas[2] = { 0 };
+// Per thread so worlds simulated in parallel never hand out the same scratch memory
+static THREAD_LOCAL Arena scratch_arenas[2] = { 0 };
 
 Arena arena_create(usize size) {
 	Arena arena = { 0 };
@@ -76,6 +79,26 @@ void arena_end_temp(ArenaTemp temp) {
 	arena_set(temp.arena, temp.position);
 }
 
+FrameArenas frame_arenas_create(usize size) {
+	return (FrameArenas){ .arenas = { arena_create(size), arena_create(size) } };
+}
+
+void frame_arenas_destroy(FrameArenas *frames) {
+	arena_destroy(&frames->arenas[0]);
+	arena_destroy(&frames->arenas[1]);
+	frames->current = 0;
+}
+
+void frame_arenas_swap(FrameArenas *frames) {
+	frames->current ^= 1;
+	Arena *stale = &frames->arenas[frames->current];
+#ifndef NDEBUG
+	if (stale->memory)
+		memset(stale->memory, FRAME_ARENA_POISON, stale->offset);
+#endif
+	arena_reset(stale);
+}
+
 ArenaTemp arena_scratch(Arena *conflict) {
 	if (scratch_arenas[0].memory == NULL) {
 		scratch_arenas[0] = arena_create(MiB(4));
@@ -85,3 +108,8 @@ ArenaTemp arena_scratch(Arena *conflict) {
 	Arena *selected = conflict == &scratch_arenas[0] ? &scratch_arenas[1] : &scratch_arenas[0];
 	return arena_begin_temp(selected);
 }
+
+void arena_scratch_shutdown(void) {
+	arena_destroy(&scratch_arenas[0]);
+	arena_destroy(&scratch_arenas[1]);
+}
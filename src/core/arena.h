@@ -10,6 +10,13 @@ typedef struct {
 	usize position;
 } ArenaTemp;
 
+// Two arenas that trade places every frame, so what frame N pushed stays readable
+// through frame_arenas_previous for all of frame N+1 and is recycled after that
+typedef struct {
+	Arena arenas[2];
+	uint32_t current;
+} FrameArenas;
+
 Arena arena_create(usize size);
 Arena arena_create_from_memory(void *buffer, usize size);
 void arena_destroy(Arena *arena);
@@ -27,6 +34,24 @@ void arena_end_temp(ArenaTemp temp);
 
 ArenaTemp arena_scratch(Arena *conflict);
 #define arena_release_scratch(scratch) arena_end_temp(scratch)
+// Frees the calling thread's scratch arenas, worker threads call it before they exit
+void arena_scratch_shutdown(void);
+
+FrameArenas frame_arenas_create(usize size);
+void frame_arenas_destroy(FrameArenas *frames);
+// Call once the frame is done, the previous frame's arena becomes the current one and starts empty.
+// Debug builds fill what it held with FRAME_ARENA_POISON so stale reads stand out
+void frame_arenas_swap(FrameArenas *frames);
+
+#define FRAME_ARENA_POISON 0xDD
+
+static inline Arena *frame_arenas_current(FrameArenas *frames) {
+	return &frames->arenas[frames->current];
+}
+
+static inline Arena *frame_arenas_previous(FrameArenas *frames) {
+	return &frames->arenas[frames->current ^ 1];
+}
 
 #define arena_push_array(arena, type, count) ((type *)arena_push((arena), sizeof(type) * (count), alignof(type), false))
 #define arena_push_array_zero(arena, type, count) ((type *)arena_push((arena), sizeof(type) * (count), alignof(type), true))
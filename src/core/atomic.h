@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common.h"
+
+// Thin wrappers over the GCC/Clang __atomic builtins, C99 has no <stdatomic.h>
+#define atomic_load_relaxed(pointer) __atomic_load_n((pointer), __ATOMIC_RELAXED)
+#define atomic_load_acquire(pointer) __atomic_load_n((pointer), __ATOMIC_ACQUIRE)
+
+#define atomic_store_relaxed(pointer, value) __atomic_store_n((pointer), (value), __ATOMIC_RELAXED)
+#define atomic_store_release(pointer, value) __atomic_store_n((pointer), (value), __ATOMIC_RELEASE)
+
+// Both return the value held before the operation
+#define atomic_add(pointer, value) __atomic_fetch_add((pointer), (value), __ATOMIC_ACQ_REL)
+#define atomic_exchange(pointer, value) __atomic_exchange_n((pointer), (value), __ATOMIC_ACQ_REL)
+
+// On failure *expected is updated with the current value
+#define atomic_cas(pointer, expected, desired) \
+	__atomic_compare_exchange_n((pointer), (expected), (desired), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+#if defined(__x86_64__) || defined(__i386__)
+	#define atomic_pause() __builtin_ia32_pause()
+#else
+	#define atomic_pause() ((void)0)
+#endif
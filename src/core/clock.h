@@ -0,0 +1,9 @@
+#pragma once
+
+#include "common.h"
+
+// Monotonic wall clock, independent of the raylib window
+uint64_t clock_now_ns(void);
+
+#define clock_ns_to_seconds(ns) ((float64)(ns) * 1e-9)
+#define clock_ns_to_ms(ns) ((float64)(ns) * 1e-6)
@@ -0,0 +1,80 @@
+#include "containers.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void *container_alloc(Arena *arena, usize size, usize alignment) {
+	if (arena)
+		return arena_push(arena, size, alignment, false);
+	return malloc(size);
+}
+
+void *container_grow(Arena *arena, void *items, usize count, usize capacity, usize new_capacity, usize item_size, usize alignment) {
+	if (arena == NULL)
+		return realloc(items, new_capacity * item_size);
+
+	// The arena's last allocation can grow where it is
+	uint8_t *end = (uint8_t *)arena->memory + arena->offset;
+	usize extra = (new_capacity - capacity) * item_size;
+	if (items && (uint8_t *)items + capacity * item_size == end && arena->offset + extra <= arena->capacity) {
+		arena->offset += extra;
+		return items;
+	}
+
+	void *grown = arena_push(arena, new_capacity * item_size, alignment, false);
+	if (grown && count)
+		memcpy(grown, items, count * item_size);
+	return grown;
+}
+
+void container_free(Arena *arena, void *items) {
+	if (arena == NULL)
+		free(items);
+}
+
+bool32 container_map_resize(Arena *arena, ContainerMapSlots *slots, uint32_t capacity, uint32_t new_capacity, usize entry_size, usize alignment) {
+	ContainerMapSlots grown = {
+		.controls = container_alloc(arena, new_capacity, CONTAINER_GROUP_WIDTH),
+		.hashes = container_alloc(arena, new_capacity * sizeof(uint32_t), alignof(uint32_t)),
+		.entries = container_alloc(arena, new_capacity * entry_size, alignment),
+	};
+	if (grown.controls == NULL || grown.hashes == NULL || grown.entries == NULL) {
+		container_free(arena, grown.controls);
+		container_free(arena, grown.hashes);
+		container_free(arena, grown.entries);
+		return false;
+	}
+	memset(grown.controls, CONTAINER_CTRL_EMPTY, new_capacity);
+
+	// Nothing is removed in the new table, the first free slot on the probe path is the entry's home
+	uint32_t group_mask = new_capacity / CONTAINER_GROUP_WIDTH - 1;
+	for (uint32_t slot = 0; slot < capacity; slot++) {
+		if (slots->controls[slot] & CONTAINER_CTRL_EMPTY)
+			continue;
+
+		uint32_t hash = slots->hashes[slot], index;
+		for (uint32_t group = hash & group_mask, step = 0;; group = (group + ++step) & group_mask) {
+			uint32_t free = container_group_free(grown.controls + group * CONTAINER_GROUP_WIDTH);
+			if (free) {
+				index = group * CONTAINER_GROUP_WIDTH + container_ctz(free);
+				break;
+			}
+		}
+		grown.controls[index] = slots->controls[slot];
+		grown.hashes[index] = hash;
+		memcpy((uint8_t *)grown.entries + index * entry_size, (uint8_t *)slots->entries + slot * entry_size, entry_size);
+	}
+
+	container_free(arena, slots->controls);
+	container_free(arena, slots->hashes);
+	container_free(arena, slots->entries);
+	*slots = grown;
+	return true;
+}
+
+uint32_t container_capacity_pow2(uint32_t count) {
+	uint32_t capacity = 1;
+	while (capacity < count)
+		capacity <<= 1;
+	return capacity;
+}
@@ -0,0 +1,356 @@
+#pragma once
+
+#include "common.h"
+#include "core/arena.h"
+
+#include <string.h>
+
+// Containers specialized per element type by macro, so element sizes are compile time
+// constants on the hot paths and only growth goes out of line. Each allocates from the
+// Arena it is initialized with, or from the heap when that is NULL. Arena backed ones
+// never free, a grown array leaves its old block behind unless it was the arena's last
+// allocation, then it grows in place.
+//
+//     ARRAY_DEFINE(BodyArray, body_array, EntityBody)
+//     BodyArray bodies;
+//     body_array_init(&bodies, frame, 64);
+//     body_array_push(&bodies, body);
+//
+//     RING_DEFINE(TickRing, tick_ring, ReplayTick)
+//     MAP_DEFINE(IdMap, id_map, uint64_t, uint32_t, hash_u64, equals_u64)
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#define CONTAINERS_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define CONTAINERS_SSE2 0
+#endif
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+// Maps probe a group of slots at a time, one control byte each
+#define CONTAINER_GROUP_WIDTH 16
+#define CONTAINER_CTRL_EMPTY 0x80
+#define CONTAINER_CTRL_REMOVED 0xFE
+
+void *container_alloc(Arena *arena, usize size, usize alignment);
+// Returns a block of `new_capacity` items starting with the first `count` of `items`, NULL when out of memory
+void *container_grow(Arena *arena, void *items, usize count, usize capacity, usize new_capacity, usize item_size, usize alignment);
+// Heap blocks only, arena blocks go with their arena
+void container_free(Arena *arena, void *items);
+
+typedef struct {
+	// CONTAINER_CTRL_EMPTY, CONTAINER_CTRL_REMOVED or the top 7 bits of the slot's hash
+	uint8_t *controls;
+	// Low hash bits of each slot, a rehash places entries without hashing keys again
+	uint32_t *hashes;
+	void *entries;
+} ContainerMapSlots;
+
+// Rehashes into `new_capacity` slots, a power of two no smaller than a group, dropping removed ones
+bool32 container_map_resize(Arena *arena, ContainerMapSlots *slots, uint32_t capacity, uint32_t new_capacity, usize entry_size, usize alignment);
+
+uint32_t container_capacity_pow2(uint32_t count);
+
+static inline uint64_t hash_u64(uint64_t value) {
+	value ^= value >> 30;
+	value *= 0xbf58476d1ce4e5b9ull;
+	value ^= value >> 27;
+	value *= 0x94d049bb133111ebull;
+	return value ^ (value >> 31);
+}
+
+static inline bool32 equals_u64(uint64_t a, uint64_t b) {
+	return a == b;
+}
+
+static inline uint32_t container_ctz(uint32_t bits) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctz(bits);
+#endif
+}
+
+// Folded so hashes that only mix well into their high bits, like string_hash64, still spread
+static inline uint32_t container_hash32(uint64_t hash) {
+	return (uint32_t)(hash ^ (hash >> 32));
+}
+
+// The group index comes from the low hash bits, the control byte from the top ones
+static inline uint8_t container_control(uint32_t hash) {
+	return (uint8_t)(hash >> 25);
+}
+
+// Bit i set where slot i of the group holds `control`
+static inline uint32_t container_group_match(const uint8_t *group, uint8_t control) {
+#if CONTAINERS_SSE2
+	__m128i controls = _mm_loadu_si128((const __m128i *)group);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(controls, _mm_set1_epi8((char)control)));
+#else
+	uint32_t match = 0;
+	for (uint32_t index = 0; index < CONTAINER_GROUP_WIDTH; index++)
+		match |= (uint32_t)(group[index] == control) << index;
+	return match;
+#endif
+}
+
+// Empty and removed slots, the only control bytes with the top bit set
+static inline uint32_t container_group_free(const uint8_t *group) {
+#if CONTAINERS_SSE2
+	return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+	uint32_t match = 0;
+	for (uint32_t index = 0; index < CONTAINER_GROUP_WIDTH; index++)
+		match |= (uint32_t)(group[index] >> 7) << index;
+	return match;
+#endif
+}
+
+#define ARRAY_DEFINE(Name, name, type)                                                                                               \
+	typedef struct {                                                                                                                 \
+		type *items;                                                                                                                 \
+		uint32_t count, capacity;                                                                                                    \
+		Arena *arena;                                                                                                                \
+	} Name;                                                                                                                          \
+                                                                                                                                     \
+	static inline bool32 name##_reserve(Name *array, uint32_t capacity) {                                                            \
+		if (capacity <= array->capacity)                                                                                             \
+			return true;                                                                                                             \
+		uint32_t grown = max(max(capacity, array->capacity * 2), 8u);                                                                \
+		type *items = container_grow(array->arena, array->items, array->count, array->capacity, grown, sizeof(type), alignof(type)); \
+		if (items == NULL)                                                                                                           \
+			return false;                                                                                                            \
+		array->items = items;                                                                                                        \
+		array->capacity = grown;                                                                                                     \
+		return true;                                                                                                                 \
+	}                                                                                                                                \
+                                                                                                                                     \
+	static inline bool32 name##_init(Name *array, Arena *arena, uint32_t capacity) {                                                 \
+		*array = (Name){ .arena = arena };                                                                                           \
+		return name##_reserve(array, capacity);                                                                                      \
+	}                                                                                                                                \
+                                                                                                                                     \
+	static inline void name##_destroy(Name *array) {                                                                                 \
+		container_free(array->arena, array->items);                                                                                  \
+		*array = (Name){ 0 };                                                                                                        \
+	}                                                                                                                                \
+                                                                                                                                     \
+	/* Returns the stored copy, NULL when the array could not grow */                                                                \
+	static inline type *name##_push(Name *array, type item) {                                                                        \
+		if (array->count == array->capacity && name##_reserve(array, array->count + 1) == false)                                     \
+			return NULL;                                                                                                             \
+		array->items[array->count] = item;                                                                                           \
+		return &array->items[array->count++];                                                                                        \
+	}                                                                                                                                \
+                                                                                                                                     \
+	static inline type name##_pop(Name *array) {                                                                                     \
+		return array->items[--array->count];                                                                                         \
+	}                                                                                                                                \
+                                                                                                                                     \
+	/* Moves the last item into the hole, order is not kept */                                                                       \
+	static inline void name##_remove_swap(Name *array, uint32_t index) {                                                             \
+		array->items[index] = array->items[--array->count];                                                                          \
+	}                                                                                                                                \
+                                                                                                                                     \
+	static inline void name##_clear(Name *array) {                                                                                   \
+		array->count = 0;                                                                                                            \
+	}
+
+// Fixed capacity, rounded up to a power of two, oldest item first
+#define RING_DEFINE(Name, name, type)                                               \
+	typedef struct {                                                                \
+		type *items;                                                                \
+		uint32_t head, count, mask;                                                 \
+		Arena *arena;                                                               \
+	} Name;                                                                         \
+                                                                                    \
+	static inline bool32 name##_init(Name *ring, Arena *arena, uint32_t capacity) { \
+		uint32_t slots = container_capacity_pow2(capacity);                         \
+		*ring = (Name){ .arena = arena, .mask = slots - 1 };                        \
+		ring->items = container_alloc(arena, slots * sizeof(type), alignof(type));  \
+		return ring->items != NULL;                                                 \
+	}                                                                               \
+                                                                                    \
+	static inline void name##_destroy(Name *ring) {                                 \
+		container_free(ring->arena, ring->items);                                   \
+		*ring = (Name){ 0 };                                                        \
+	}                                                                               \
+                                                                                    \
+	static inline uint32_t name##_capacity(const Name *ring) {                      \
+		return ring->mask + 1;                                                      \
+	}                                                                               \
+                                                                                    \
+	/* Fails when full */                                                           \
+	static inline bool32 name##_push(Name *ring, type item) {                       \
+		if (ring->count > ring->mask)                                               \
+			return false;                                                           \
+		ring->items[(ring->head + ring->count++) & ring->mask] = item;              \
+		return true;                                                                \
+	}                                                                               \
+                                                                                    \
+	/* Drops the oldest item when full */                                           \
+	static inline void name##_push_overwrite(Name *ring, type item) {               \
+		if (ring->count > ring->mask) {                                             \
+			ring->head = (ring->head + 1) & ring->mask;                             \
+			ring->count--;                                                          \
+		}                                                                           \
+		ring->items[(ring->head + ring->count++) & ring->mask] = item;              \
+	}                                                                               \
+                                                                                    \
+	static inline bool32 name##_pop(Name *ring, type *item) {                       \
+		if (ring->count == 0)                                                       \
+			return false;                                                           \
+		*item = ring->items[ring->head];                                            \
+		ring->head = (ring->head + 1) & ring->mask;                                 \
+		ring->count--;                                                              \
+		return true;                                                                \
+	}                                                                               \
+                                                                                    \
+	/* 0 is the oldest item, the caller keeps index below count */                  \
+	static inline type *name##_at(Name *ring, uint32_t index) {                     \
+		return &ring->items[(ring->head + index) & ring->mask];                     \
+	}                                                                               \
+                                                                                    \
+	static inline void name##_clear(Name *ring) {                                   \
+		ring->head = ring->count = 0;                                               \
+	}
+
+
+// Open addressing over groups of CONTAINER_GROUP_WIDTH slots, SwissTable style. A probe
+// compares a whole group's control bytes at once and only reads entries whose 7 hash
+// bits matched, so a miss rarely touches a key. Keys are stored as given, String keys
+// must outlive the map.
+#define MAP_DEFINE(Name, name, key_type, value_type, hash_function, equals_function)                                               \
+	typedef struct {                                                                                                               \
+		key_type key;                                                                                                              \
+		value_type value;                                                                                                          \
+	} Name##Entry;                                                                                                                 \
+                                                                                                                                   \
+	typedef struct {                                                                                                               \
+		uint8_t *controls;                                                                                                         \
+		uint32_t *hashes;                                                                                                          \
+		Name##Entry *entries;                                                                                                      \
+		/* `used` counts removed slots too, they still lengthen probes */                                                          \
+		uint32_t count, used, capacity;                                                                                            \
+		Arena *arena;                                                                                                              \
+	} Name;                                                                                                                        \
+                                                                                                                                   \
+	static inline bool32 name##_resize(Name *map, uint32_t capacity) {                                                             \
+		ContainerMapSlots slots = { map->controls, map->hashes, map->entries };                                                    \
+		if (container_map_resize(map->arena, &slots, map->capacity, capacity, sizeof(Name##Entry), alignof(Name##Entry)) == false) \
+			return false;                                                                                                          \
+		map->controls = slots.controls;                                                                                            \
+		map->hashes = slots.hashes;                                                                                                \
+		map->entries = slots.entries;                                                                                              \
+		map->capacity = capacity;                                                                                                  \
+		map->used = map->count;                                                                                                    \
+		return true;                                                                                                               \
+	}                                                                                                                              \
+                                                                                                                                   \
+	/* Sized so `capacity` entries fit without a rehash */                                                                         \
+	static inline bool32 name##_init(Name *map, Arena *arena, uint32_t capacity) {                                                 \
+		*map = (Name){ .arena = arena };                                                                                           \
+		return name##_resize(map, container_capacity_pow2(max(capacity + capacity / 7 + 1, (uint32_t)CONTAINER_GROUP_WIDTH)));     \
+	}                                                                                                                              \
+                                                                                                                                   \
+	static inline void name##_destroy(Name *map) {                                                                                 \
+		container_free(map->arena, map->controls);                                                                                 \
+		container_free(map->arena, map->hashes);                                                                                   \
+		container_free(map->arena, map->entries);                                                                                  \
+		*map = (Name){ 0 };                                                                                                        \
+	}                                                                                                                              \
+                                                                                                                                   \
+	static inline Name##Entry *name##_find(const Name *map, key_type key) {                                                        \
+		if (map->capacity == 0)                                                                                                    \
+			return NULL;                                                                                                           \
+		uint32_t hash = container_hash32(hash_function(key)), group_mask = map->capacity / CONTAINER_GROUP_WIDTH - 1;              \
+		uint8_t control = container_control(hash);                                                                                 \
+		for (uint32_t group = hash & group_mask, step = 0;; group = (group + ++step) & group_mask) {                               \
+			const uint8_t *controls = map->controls + group * CONTAINER_GROUP_WIDTH;                                               \
+			for (uint32_t match = container_group_match(controls, control); match; match &= match - 1) {                           \
+				Name##Entry *entry = &map->entries[group * CONTAINER_GROUP_WIDTH + container_ctz(match)];                          \
+				if (equals_function(entry->key, key))                                                                              \
+					return entry;                                                                                                  \
+			}                                                                                                                      \
+			if (container_group_match(controls, CONTAINER_CTRL_EMPTY))                                                             \
+				return NULL;                                                                                                       \
+		}                                                                                                                          \
+	}                                                                                                                              \
+                                                                                                                                   \
+	static inline value_type *name##_get(const Name *map, key_type key) {                                                          \
+		Name##Entry *entry = name##_find(map, key);                                                                                \
+		return entry ? &entry->value : NULL;                                                                                       \
+	}                                                                                                                              \
+                                                                                                                                   \
+	/* Finds or inserts `key`, new values start zeroed. `inserted` may be NULL, the result is NULL                                 \
+	   when the map could not grow */                                                                                              \
+	static inline Name##Entry *name##_insert(Name *map, key_type key, bool32 *inserted) {                                          \
+		if ((map->used + 1) * 8 > map->capacity * 7 &&                                                                             \
+			name##_resize(map, container_capacity_pow2(max((map->count + 1) * 2, (uint32_t)CONTAINER_GROUP_WIDTH))) == false)      \
+			return NULL;                                                                                                           \
+                                                                                                                                   \
+		uint32_t hash = container_hash32(hash_function(key)), group_mask = map->capacity / CONTAINER_GROUP_WIDTH - 1;              \
+		uint8_t control = container_control(hash);                                                                                 \
+		uint32_t slot = INVALID_INDEX;                                                                                             \
+		for (uint32_t group = hash & group_mask, step = 0;; group = (group + ++step) & group_mask) {                               \
+			const uint8_t *controls = map->controls + group * CONTAINER_GROUP_WIDTH;                                               \
+			for (uint32_t match = container_group_match(controls, control); match; match &= match - 1) {                           \
+				Name##Entry *entry = &map->entries[group * CONTAINER_GROUP_WIDTH + container_ctz(match)];                          \
+				if (equals_function(entry->key, key)) {                                                                            \
+					if (inserted)                                                                                                  \
+						*inserted = false;                                                                                         \
+					return entry;                                                                                                  \
+				}                                                                                                                  \
+			}                                                                                                                      \
+			uint32_t free = container_group_free(controls);                                                                        \
+			if (free && slot == INVALID_INDEX)                                                                                     \
+				slot = group * CONTAINER_GROUP_WIDTH + container_ctz(free);                                                        \
+			if (container_group_match(controls, CONTAINER_CTRL_EMPTY))                                                             \
+				break;                                                                                                             \
+		}                                                                                                                          \
+                                                                                                                                   \
+		map->used += map->controls[slot] == CONTAINER_CTRL_EMPTY;                                                                  \
+		map->count++;                                                                                                              \
+		map->controls[slot] = control;                                                                                             \
+		map->hashes[slot] = hash;                                                                                                  \
+		map->entries[slot] = (Name##Entry){ .key = key };                                                                          \
+		if (inserted)                                                                                                              \
+			*inserted = true;                                                                                                      \
+		return &map->entries[slot];                                                                                                \
+	}                                                                                                                              \
+                                                                                                                                   \
+	static inline value_type *name##_put(Name *map, key_type key) {                                                                \
+		Name##Entry *entry = name##_insert(map, key, NULL);                                                                        \
+		return entry ? &entry->value : NULL;                                                                                       \
+	}                                                                                                                              \
+                                                                                                                                   \
+	static inline bool32 name##_remove(Name *map, key_type key) {                                                                  \
+		Name##Entry *entry = name##_find(map, key);                                                                                \
+		if (entry == NULL)                                                                                                         \
+			return false;                                                                                                          \
+		/* Probes stop at a group with an empty slot, so the slot of such a group can go back to empty */                          \
+		uint32_t index = (uint32_t)(entry - map->entries);                                                                         \
+		uint8_t *controls = map->controls + index / CONTAINER_GROUP_WIDTH * CONTAINER_GROUP_WIDTH;                                 \
+		bool32 reusable = container_group_match(controls, CONTAINER_CTRL_EMPTY) != 0;                                              \
+		map->controls[index] = reusable ? CONTAINER_CTRL_EMPTY : CONTAINER_CTRL_REMOVED;                                           \
+		map->used -= reusable;                                                                                                     \
+		map->count--;                                                                                                              \
+		return true;                                                                                                               \
+	}                                                                                                                              \
+                                                                                                                                   \
+	/* Walks the entries in slot order, start the cursor at 0 */                                                                   \
+	static inline Name##Entry *name##_next(Name *map, uint32_t *cursor) {                                                          \
+		for (; *cursor < map->capacity; (*cursor)++)                                                                               \
+			if ((map->controls[*cursor] & CONTAINER_CTRL_EMPTY) == 0)                                                              \
+				return &map->entries[(*cursor)++];                                                                                 \
+		return NULL;                                                                                                               \
+	}                                                                                                                              \
+                                                                                                                                   \
+	static inline void name##_clear(Name *map) {                                                                                   \
+		memset(map->controls, CONTAINER_CTRL_EMPTY, map->capacity);                                                                \
+		map->count = map->used = 0;                                                                                                \
+	}
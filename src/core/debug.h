@@ -21,6 +21,7 @@
 		do {                                                     \
 			if (!(condition)) {                                  \
 				LOG_ERROR("Assertion failed: [%s]", #condition); \
+				logger_flush();                                  \
 				debug_break();                                   \
 				abort();                                         \
 			}                                                    \
@@ -29,6 +30,7 @@
 		do {                                                                   \
 			if (!(condition)) {                                                \
 				LOG_ERROR("Assertion failed: [%s] | %s", #condition, message); \
+				logger_flush();                                                \
 				debug_break();                                                 \
 				abort();                                                       \
 			}                                                                  \
@@ -38,6 +40,7 @@
 			if (!(condition)) {                            \
 				LOG_ERROR("Assertion failed: [%s] | " fmt, \
 					#condition, __VA_ARGS__);              \
+				logger_flush();                            \
 				debug_break();                             \
 				abort();                                   \
 			}                                              \
@@ -0,0 +1,131 @@
+#include "entity_store.h"
+
+#include "core/debug.h"
+
+#include <string.h>
+
+#define STORE_AT(store, offset) ((uint8_t *)(store) + (offset))
+#define STORE_SLOTS(store) ((EntitySlot *)STORE_AT(store, (store)->slots_offset))
+#define STORE_HANDLES(store) ((EntityHandle *)STORE_AT(store, (store)->handles_offset))
+
+// Generation 0 is reserved so a zeroed handle never matches
+static uint32_t next_generation(uint32_t generation) {
+	generation = (generation + 1) & (UINT32_MAX >> ENTITY_HANDLE_INDEX_BITS);
+	return generation ? generation : 1;
+}
+
+static int32_t store_offset(EntityStore *store, void *pointer) {
+	ptrdiff_t offset = (uint8_t *)pointer - (uint8_t *)store;
+	ASSERT_MESSAGE(offset > 0 && offset <= INT32_MAX, "Entity store columns must live in the struct that owns the store");
+	return (int32_t)offset;
+}
+
+void entity_store_init(EntityStore *store, EntitySlot *slots, EntityHandle *handles, uint32_t capacity) {
+	ASSERT(capacity > 0 && capacity <= ENTITY_HANDLE_INDEX_MASK + 1);
+
+	*store = (EntityStore){ 0 };
+	store->capacity = capacity;
+	store->slots_offset = store_offset(store, slots);
+	store->handles_offset = store_offset(store, handles);
+
+	for (uint32_t index = 0; index < capacity; index++)
+		slots[index] = (EntitySlot){ .dense = index + 1, .generation = 1 };
+}
+
+void entity_store_add_column(EntityStore *store, void *column, usize stride) {
+	ASSERT(store->column_count < ENTITY_STORE_MAX_COLUMNS);
+
+	store->columns[store->column_count++] = (EntityColumn){
+		.offset = store_offset(store, column),
+		.stride = (uint32_t)stride,
+	};
+}
+
+void entity_store_clear(EntityStore *store) {
+	EntitySlot *slots = STORE_SLOTS(store);
+	EntityHandle *handles = STORE_HANDLES(store);
+
+	// Retire live handles so references from before the clear read as stale
+	for (uint32_t index = 0; index < store->count; index++) {
+		EntitySlot *slot = &slots[entity_handle_index(handles[index])];
+		slot->generation = next_generation(slot->generation);
+	}
+
+	for (uint32_t index = 0; index < store->capacity; index++)
+		slots[index].dense = index + 1;
+
+	store->free_head = 0;
+	store->count = 0;
+}
+
+EntityHandle entity_store_create(EntityStore *store) {
+	if (store->free_head >= store->capacity)
+		return ENTITY_HANDLE_NULL;
+
+	EntitySlot *slots = STORE_SLOTS(store);
+	uint32_t slot_index = store->free_head;
+	EntitySlot *slot = &slots[slot_index];
+
+	store->free_head = slot->dense;
+	slot->dense = store->count++;
+
+	EntityHandle handle = (slot->generation << ENTITY_HANDLE_INDEX_BITS) | slot_index;
+	STORE_HANDLES(store)[slot->dense] = handle;
+
+	return handle;
+}
+
+void entity_store_destroy_at(EntityStore *store, uint32_t index) {
+	ASSERT(index < store->count);
+
+	EntitySlot *slots = STORE_SLOTS(store);
+	EntityHandle *handles = STORE_HANDLES(store);
+
+	uint32_t slot_index = entity_handle_index(handles[index]);
+	uint32_t last = --store->count;
+
+	if (index != last) {
+		for (uint32_t column_index = 0; column_index < store->column_count; column_index++) {
+			EntityColumn *column = &store->columns[column_index];
+			uint8_t *base = STORE_AT(store, column->offset);
+			memcpy(base + (usize)index * column->stride, base + (usize)last * column->stride, column->stride);
+		}
+
+		handles[index] = handles[last];
+		slots[entity_handle_index(handles[index])].dense = index;
+	}
+
+	slots[slot_index].generation = next_generation(slots[slot_index].generation);
+	slots[slot_index].dense = store->free_head;
+	store->free_head = slot_index;
+}
+
+bool32 entity_store_destroy(EntityStore *store, EntityHandle handle) {
+	uint32_t index = entity_store_index(store, handle);
+	if (index == ENTITY_STORE_INVALID)
+		return false;
+
+	entity_store_destroy_at(store, index);
+	return true;
+}
+
+uint32_t entity_store_index(const EntityStore *store, EntityHandle handle) {
+	uint32_t slot_index = entity_handle_index(handle);
+	if (handle == ENTITY_HANDLE_NULL || slot_index >= store->capacity)
+		return ENTITY_STORE_INVALID;
+
+	const EntitySlot *slot = (const EntitySlot *)((const uint8_t *)store + store->slots_offset);
+	slot += slot_index;
+
+	if (slot->generation != entity_handle_generation(handle))
+		return ENTITY_STORE_INVALID;
+
+	return slot->dense;
+}
+
+EntityHandle entity_store_handle(const EntityStore *store, uint32_t index) {
+	if (index >= store->count)
+		return ENTITY_HANDLE_NULL;
+
+	return ((const EntityHandle *)((const uint8_t *)store + store->handles_offset))[index];
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "common.h"
+
+// Sparse-set storage for pooled entities. Handles are stable 32-bit ids, live
+// data is packed at the front of every column so loops only touch live entries.
+//
+//     typedef struct {
+//         ENTITY_STORE_STORAGE(MAX_BULLETS);
+//         Bullet bullets[MAX_BULLETS];
+//     } BulletSystem;
+//
+//     entity_store_init(&sys->store, sys->slots, sys->handles, MAX_BULLETS);
+//     entity_store_add_column(&sys->store, sys->bullets, sizeof(*sys->bullets));
+//
+//     for (uint32_t index = 0; index < sys->store.count; index++)
+//         update(&sys->bullets[index]);
+//
+// Columns are addressed by offset from the store, so the owning struct can be copied as a whole.
+
+#define ENTITY_HANDLE_INDEX_BITS 16
+#define ENTITY_HANDLE_INDEX_MASK ((1u << ENTITY_HANDLE_INDEX_BITS) - 1)
+#define ENTITY_HANDLE_NULL 0u
+
+#define ENTITY_STORE_MAX_COLUMNS 4
+#define ENTITY_STORE_INVALID UINT32_MAX
+
+// Low bits index the slot, high bits count how often the slot has been reused
+typedef uint32_t EntityHandle;
+
+#define entity_handle_index(handle) ((handle) & ENTITY_HANDLE_INDEX_MASK)
+#define entity_handle_generation(handle) ((handle) >> ENTITY_HANDLE_INDEX_BITS)
+
+typedef struct {
+	// Dense position while alive, next free slot otherwise
+	uint32_t dense;
+	uint32_t generation;
+} EntitySlot;
+
+typedef struct {
+	int32_t offset;
+	uint32_t stride;
+} EntityColumn;
+
+typedef struct {
+	uint32_t capacity, count;
+	uint32_t free_head;
+
+	int32_t slots_offset, handles_offset;
+
+	uint32_t column_count;
+	EntityColumn columns[ENTITY_STORE_MAX_COLUMNS];
+} EntityStore;
+
+#define ENTITY_STORE_STORAGE(capacity) \
+	EntityStore store;                 \
+	EntitySlot slots[capacity];        \
+	EntityHandle handles[capacity]
+
+void entity_store_init(EntityStore *store, EntitySlot *slots, EntityHandle *handles, uint32_t capacity);
+void entity_store_add_column(EntityStore *store, void *column, usize stride);
+void entity_store_clear(EntityStore *store);
+
+// Returns ENTITY_HANDLE_NULL when full, the new entity lives at dense index count - 1
+EntityHandle entity_store_create(EntityStore *store);
+bool32 entity_store_destroy(EntityStore *store, EntityHandle handle);
+// Swap-removes the entity at a dense index, iterate backwards when destroying inside a loop
+void entity_store_destroy_at(EntityStore *store, uint32_t index);
+
+// Dense index of a live handle, ENTITY_STORE_INVALID if it was destroyed or never existed
+uint32_t entity_store_index(const EntityStore *store, EntityHandle handle);
+EntityHandle entity_store_handle(const EntityStore *store, uint32_t index);
+
+#define entity_store_alive(store, handle) (entity_store_index((store), (handle)) != ENTITY_STORE_INVALID)
@@ -0,0 +1,128 @@
+#include "frame_pacer.h"
+
+#include "core/atomic.h"
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/profiler.h"
+#include "core/thread.h"
+
+#include <string.h>
+
+#define FRAME_PACER_SLACK_SAMPLES 8
+#define FRAME_PACER_SLACK_MIN_NS 200000ull
+#define FRAME_PACER_SLACK_MAX_NS 4000000ull
+// Vsync safety margin, grows by a step on a missed vblank and decays back to the minimum
+#define FRAME_PACER_SAFETY_MIN_NS 1000000ull
+#define FRAME_PACER_SAFETY_STEP_NS 500000ull
+// Steps longer than this are a stall or a debugger, not time the game should simulate
+#define FRAME_PACER_MAX_DELTA .1f
+
+static const char *mode_names[FRAME_PACING_MODE_COUNT] = {
+	[FRAME_PACING_SLEEP_SPIN] = "sleep",
+	[FRAME_PACING_VSYNC] = "vsync",
+};
+
+static void wait_until(uint64_t deadline_ns, uint64_t slack_ns) {
+#if defined(PLATFORM_WEB)
+	// The browser paces frames through raylib's own wait, blocking here would stall the page
+	(void)deadline_ns;
+	(void)slack_ns;
+#else
+	for (uint64_t now = clock_now_ns(); now < deadline_ns; now = clock_now_ns()) {
+		uint64_t remaining = deadline_ns - now;
+		if (remaining > slack_ns)
+			thread_sleep_us((remaining - slack_ns) / 1000);
+		else
+			atomic_pause();
+	}
+#endif
+}
+
+uint64_t frame_pacer_measure_sleep_slack(void) {
+	uint64_t worst = 0;
+	for (uint32_t sample = 0; sample < FRAME_PACER_SLACK_SAMPLES; sample++) {
+		uint64_t start = clock_now_ns();
+		thread_sleep_us(1000);
+		uint64_t slept = clock_now_ns() - start;
+		worst = max(worst, slept > 1000000ull ? slept - 1000000ull : 0);
+	}
+
+	// Headroom over the worst sample, a busy system oversleeps more than startup did
+	return clamp(worst + worst / 2, FRAME_PACER_SLACK_MIN_NS, FRAME_PACER_SLACK_MAX_NS);
+}
+
+void frame_pacer_init(FramePacer *pacer, FramePacingMode mode, float refresh_hz) {
+	uint64_t now = clock_now_ns();
+	*pacer = (FramePacer){
+		.mode = mode,
+		.period_ns = (uint64_t)(1e9 / (refresh_hz > 0.0f ? refresh_hz : 60.0f)),
+		.sleep_slack_ns = frame_pacer_measure_sleep_slack(),
+		.frame_start_ns = now,
+		.submit_ns = now,
+		.present_ns = now,
+		.deadline_ns = now,
+		.safety_ns = FRAME_PACER_SAFETY_MIN_NS,
+		.delta = 1.0f / (refresh_hz > 0.0f ? refresh_hz : 60.0f),
+	};
+
+	LOG_INFO("FramePacer: %s at %.2f Hz, sleeps stop %.2f ms early", mode_names[mode], 1e9 / pacer->period_ns,
+		pacer->sleep_slack_ns / 1e6);
+}
+
+void frame_pacer_submit(FramePacer *pacer) {
+	pacer->submit_ns = clock_now_ns();
+}
+
+void frame_pacer_wait(FramePacer *pacer) {
+	uint64_t now = clock_now_ns();
+	uint64_t interval = now - pacer->present_ns;
+	pacer->present_ns = now;
+	pacer->frames++;
+	profiler_frame_interval(interval, pacer->period_ns);
+
+	if (pacer->mode == FRAME_PACING_VSYNC) {
+		uint64_t work = pacer->submit_ns - pacer->frame_start_ns;
+		if (work > pacer->work_estimate_ns)
+			pacer->work_estimate_ns = work;
+		else
+			pacer->work_estimate_ns -= (pacer->work_estimate_ns - work) / 16;
+
+		// A present more than half a period late missed its vblank, start earlier from now on
+		if (interval > pacer->period_ns + pacer->period_ns / 2) {
+			pacer->late_frames++;
+			pacer->safety_ns = min(pacer->safety_ns + FRAME_PACER_SAFETY_STEP_NS, pacer->period_ns / 2);
+		} else if (pacer->safety_ns > FRAME_PACER_SAFETY_MIN_NS)
+			pacer->safety_ns -= (pacer->safety_ns - FRAME_PACER_SAFETY_MIN_NS) / 64 + 1;
+
+		// The swap just returned on a vblank, the next one is a period away
+		uint64_t lead = pacer->work_estimate_ns + pacer->safety_ns;
+		if (lead < pacer->period_ns)
+			wait_until(now + pacer->period_ns - lead, pacer->sleep_slack_ns);
+	} else {
+		// Too late to make the deadline, start the schedule over instead of rushing frames to catch up
+		pacer->deadline_ns += pacer->period_ns;
+		if (now > pacer->deadline_ns + pacer->period_ns / 2) {
+			pacer->late_frames++;
+			pacer->deadline_ns = now;
+		}
+		wait_until(pacer->deadline_ns, pacer->sleep_slack_ns);
+	}
+
+	uint64_t start = clock_now_ns();
+	pacer->delta = min((start - pacer->frame_start_ns) / 1e9f, FRAME_PACER_MAX_DELTA);
+	pacer->frame_start_ns = start;
+}
+
+const char *frame_pacing_mode_name(FramePacingMode mode) {
+	return mode < FRAME_PACING_MODE_COUNT ? mode_names[mode] : "unknown";
+}
+
+bool32 frame_pacing_mode_parse(const char *name, FramePacingMode *mode) {
+	for (uint32_t index = 0; index < FRAME_PACING_MODE_COUNT; index++) {
+		if (strcmp(name, mode_names[index]) == 0) {
+			*mode = index;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common.h"
+
+// Replaces SetTargetFPS. Sleeps most of the way to the next frame and spins
+// the rest, stopping short by the oversleep measured at startup. EndDrawing polls
+// input before the wait, poll again after it or every frame runs on stale input.
+//
+//     frame_pacer_init(&pacer, FRAME_PACING_SLEEP_SPIN, 60.0f);
+//     while (running) {
+//         update(pacer.delta);
+//         draw();
+//         frame_pacer_submit(&pacer);
+//         EndDrawing();
+//         frame_pacer_wait(&pacer);
+//         PollInputEvents();
+//     }
+typedef enum {
+	// Paces on its own clock, for windows without vsync
+	FRAME_PACING_SLEEP_SPIN,
+	// The swap blocks on vblank, the pacer delays the frame start so the work
+	// finishes just before the next vblank, which cuts latency and CPU
+	FRAME_PACING_VSYNC,
+
+	FRAME_PACING_MODE_COUNT
+} FramePacingMode;
+
+typedef struct {
+	FramePacingMode mode;
+	uint64_t period_ns;
+	// Sleeps end this far before the deadline and spin the rest
+	uint64_t sleep_slack_ns;
+
+	uint64_t frame_start_ns, submit_ns, present_ns;
+	// Sleep-spin: when the next frame starts
+	uint64_t deadline_ns;
+	// Vsync: how long frames take up to the submit, rises at once and decays slowly,
+	// plus a margin that grows after every missed vblank
+	uint64_t work_estimate_ns, safety_ns;
+
+	// Seconds since the previous frame start, clamped, what the simulation steps by
+	float delta;
+	uint64_t frames, late_frames;
+} FramePacer;
+
+void frame_pacer_init(FramePacer *pacer, FramePacingMode mode, float refresh_hz);
+// Marks the end of the frame's work, call right before presenting
+void frame_pacer_submit(FramePacer *pacer);
+// Call right after presenting, returns when the next frame should start.
+// Reports the present interval to the profiler.
+void frame_pacer_wait(FramePacer *pacer);
+
+// Worst oversleep of a few short sleeps, the OS timer granularity in practice
+uint64_t frame_pacer_measure_sleep_slack(void);
+
+const char *frame_pacing_mode_name(FramePacingMode mode);
+bool32 frame_pacing_mode_parse(const char *name, FramePacingMode *mode);
@@ -0,0 +1,36 @@
+#include "hash_map.h"
+
+void *string_map_traverse(Arena *arena, StringMap *map, String key, usize value_size, usize alignment) {
+	if (arena == NULL) {
+		void **value = string_map_get(map, key);
+		return value ? *value : NULL;
+	}
+
+	bool32 inserted;
+	StringMapEntry *entry = string_map_insert(map, key, &inserted);
+	if (entry == NULL)
+		return NULL;
+
+	// The caller's key may not outlive the map, the stored one must
+	if (inserted) {
+		entry->key = string_duplicate(arena, key);
+		entry->value = arena_push(arena, value_size, alignment, true);
+	}
+	return entry->value;
+}
+
+void *u64_map_traverse(Arena *arena, U64Map *map, uint64_t key, usize value_size, usize alignment) {
+	if (arena == NULL) {
+		void **value = u64_map_get(map, key);
+		return value ? *value : NULL;
+	}
+
+	bool32 inserted;
+	U64MapEntry *entry = u64_map_insert(map, key, &inserted);
+	if (entry == NULL)
+		return NULL;
+
+	if (inserted)
+		entry->value = arena_push(arena, value_size, alignment, true);
+	return entry->value;
+}
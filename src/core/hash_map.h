@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common.h"
+#include "core/astring.h"
+#include "core/containers.h"
+
+// Flat maps for the two kinds of key the hash trie serves. Values live in an arena and
+// the maps hold pointers to them, so like trie nodes they never move once inserted.
+//
+// Moving off the trie, the entry type drops its HashTrieNode header:
+//
+//     Entry *root = NULL;                                  StringMap map;
+//                                                          string_map_init(&map, arena, 0);
+//     hash_trie_insert(arena, &root, key, Entry)       ->  string_map_insert_value(arena, &map, key, Entry)
+//     hash_trie_lookup(&root, key, Entry)              ->  string_map_lookup_value(&map, key, Entry)
+//     hash_trie_insert_hash(arena, &root, hash, Entry) ->  u64_map_insert_value(arena, &map, hash, Entry)
+//     hash_trie_lookup_hash(&root, hash, Entry)        ->  u64_map_lookup_value(&map, hash, Entry)
+
+MAP_DEFINE(StringMap, string_map, String, void *, string_hash64, string_equals)
+MAP_DEFINE(U64Map, u64_map, uint64_t, void *, hash_u64, equals_u64)
+
+// Insert copies the key into the arena and returns a zeroed value, or the existing one
+#define string_map_insert_value(arena, map, key, type) ((type *)string_map_traverse((arena), (map), (key), sizeof(type), alignof(type)))
+#define string_map_lookup_value(map, key, type) ((type *)string_map_traverse(NULL, (map), (key), 0, 1))
+
+#define u64_map_insert_value(arena, map, key, type) ((type *)u64_map_traverse((arena), (map), (key), sizeof(type), alignof(type)))
+#define u64_map_lookup_value(map, key, type) ((type *)u64_map_traverse(NULL, (map), (key), 0, 1))
+
+// Without an arena only looks up
+void *string_map_traverse(Arena *arena, StringMap *map, String key, usize value_size, usize alignment);
+void *u64_map_traverse(Arena *arena, U64Map *map, uint64_t key, usize value_size, usize alignment);
@@ -1,6 +1,7 @@
 #include "hash_trie.h"
 #include "core/arena.h"
 #include "core/astring.h"
+#include "core/atomic.h"
 
 void *hash_trie_traverse_key(Arena *arena, HashTrieNode **root, String key, usize node_size) {
 	HashTrieNode **node = root;
@@ -36,9 +37,50 @@ void *hash_trie_traverse_hash(Arena *arena, HashTrieNode **root, uint64_t hash,
 	if (!arena)
 		return NULL;
 
+	// Found by hash alone, the key stays empty instead of costing a format per insert
 	*node = arena_push(arena, node_size, 1, true);
-	(*node)->key = string_format(arena, "%d", hash);
 	(*node)->hash = hash;
 
 	return *node;
 }
+
+// Publishes a node that is fully written, or finds the one another thread published first.
+// The candidate is pushed once and carried down on every lost race, and handed back to
+// the arena when the key turns out to be there already. Nodes are aligned for the CAS
+static HashTrieNode *hash_trie_publish(Arena *arena, HashTrieNode **node, String key, uint64_t hash, bool32 has_key, usize node_size) {
+	HashTrieNode *candidate = NULL;
+	usize position = 0;
+
+	for (uint64_t hash_index = hash;; hash_index <<= 2) {
+		HashTrieNode *current = atomic_load_acquire(node);
+		if (current == NULL) {
+			if (!arena)
+				return NULL;
+			if (candidate == NULL) {
+				position = arena->offset;
+				candidate = arena_push(arena, node_size, alignof(HashTrieNode), true);
+				if (has_key)
+					candidate->key = string_duplicate(arena, key);
+				candidate->hash = hash;
+			}
+			// Release on success so readers see the key and hash, on failure current is the winner
+			if (atomic_cas(node, &current, candidate))
+				return candidate;
+		}
+
+		if (has_key ? string_equals(key, current->key) : hash == current->hash) {
+			if (candidate)
+				arena_set(arena, position);
+			return current;
+		}
+		node = &current->child[hash_index >> 62];
+	}
+}
+
+void *hash_trie_traverse_key_concurrent(Arena *arena, HashTrieNode **root, String key, usize node_size) {
+	return hash_trie_publish(arena, root, key, string_hash64(key), true, node_size);
+}
+
+void *hash_trie_traverse_hash_concurrent(Arena *arena, HashTrieNode **root, uint64_t hash, usize node_size) {
+	return hash_trie_publish(arena, root, (String){ 0 }, hash, false, node_size);
+}
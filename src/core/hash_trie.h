@@ -3,6 +3,8 @@
 #include "common.h"
 #include "core/astring.h"
 
+// Insert-only, nodes never move. core/hash_map.h has flat maps with the same
+// insert and lookup calls that probe faster, and how to move over
 typedef struct hash_trie_node {
 	struct hash_trie_node *child[4];
 	String key;
@@ -17,3 +19,18 @@ typedef struct hash_trie_node {
 
 void *hash_trie_traverse_key(struct arena *arena, HashTrieNode **root, String key, usize node_size);
 void *hash_trie_traverse_hash(Arena *arena, HashTrieNode **root, uint64_t hash, usize node_size);
+
+// Variants that any number of threads may call on the same root at once, without a lock.
+// Each thread passes its own arena, a node and its key live in the arena of the thread that
+// inserted it, so every arena has to outlive the trie. A key inserted by two threads at
+// once yields one node, both get it back. Only the node header is published, fields
+// after it are the caller's to synchronize. The plain calls are safe again once every
+// concurrent insert has been joined
+#define hash_trie_insert_concurrent(arena, root, key, type) ((type *)hash_trie_traverse_key_concurrent((arena), (HashTrieNode **)(root), (key), sizeof(type)))
+#define hash_trie_lookup_concurrent(root, key, type) ((type *)hash_trie_traverse_key_concurrent(NULL, (HashTrieNode **)(root), (key), 0))
+
+#define hash_trie_lookup_hash_concurrent(root, hash, type) ((type *)hash_trie_traverse_hash_concurrent(NULL, (HashTrieNode **)(root), (hash), 0))
+#define hash_trie_insert_hash_concurrent(arena, root, hash, type) ((type *)hash_trie_traverse_hash_concurrent((arena), (HashTrieNode **)(root), (hash), sizeof(type)))
+
+void *hash_trie_traverse_key_concurrent(Arena *arena, HashTrieNode **root, String key, usize node_size);
+void *hash_trie_traverse_hash_concurrent(Arena *arena, HashTrieNode **root, uint64_t hash, usize node_size);
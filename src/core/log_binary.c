@@ -0,0 +1,333 @@
+#include "log_binary.h"
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+	const char *start;
+	usize length;
+
+	uint32_t star_count;
+	bool32 width_star, precision_star, has_precision;
+	int width, precision;
+
+	LogArgKind kind;
+	bool32 consumes;
+} FormatSpec;
+
+// Parses one conversion starting at '%', returns a pointer past it
+static const char *format_spec_next(const char *cursor, FormatSpec *spec) {
+	*spec = (FormatSpec){ .start = cursor, .consumes = true };
+	cursor++;
+
+	if (*cursor == '%') {
+		spec->consumes = false;
+		spec->length = 2;
+		return cursor + 1;
+	}
+
+	while (*cursor && strchr("-+ #0'", *cursor))
+		cursor++;
+
+	if (*cursor == '*') {
+		spec->star_count++;
+		spec->width_star = true;
+		cursor++;
+	}
+	while (*cursor >= '0' && *cursor <= '9')
+		spec->width = spec->width * 10 + (*cursor++ - '0');
+
+	if (*cursor == '.') {
+		spec->has_precision = true;
+		cursor++;
+		if (*cursor == '*') {
+			spec->star_count++;
+			spec->precision_star = true;
+			cursor++;
+		}
+		while (*cursor >= '0' && *cursor <= '9')
+			spec->precision = spec->precision * 10 + (*cursor++ - '0');
+	}
+
+	LogArgKind integer = LOG_ARG_INT;
+	bool32 long_double = false;
+	const char *modifier = cursor;
+	switch (*cursor) {
+		case 'h':
+			cursor += cursor[1] == 'h' ? 2 : 1;
+			break;
+		case 'l':
+			integer = cursor[1] == 'l' ? LOG_ARG_LONG_LONG : LOG_ARG_LONG;
+			cursor += cursor[1] == 'l' ? 2 : 1;
+			break;
+		case 'L':
+			long_double = true;
+			cursor++;
+			break;
+		case 'z':
+			integer = LOG_ARG_SIZE;
+			cursor++;
+			break;
+		case 'j':
+			integer = LOG_ARG_INTMAX;
+			cursor++;
+			break;
+		case 't':
+			integer = LOG_ARG_PTRDIFF;
+			cursor++;
+			break;
+	}
+
+	switch (*cursor) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+		case 'c':
+			spec->kind = integer;
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			spec->kind = long_double ? LOG_ARG_LONG_DOUBLE : LOG_ARG_DOUBLE;
+			break;
+		case 's':
+			// Wide strings would need the locale of the writer to render
+			if (cursor != modifier)
+				return NULL;
+			spec->kind = LOG_ARG_STRING;
+			break;
+		case 'p':
+			spec->kind = LOG_ARG_POINTER;
+			break;
+		default:
+			// %n and unknown conversions are not representable
+			return NULL;
+	}
+
+	cursor++;
+	spec->length = cursor - spec->start;
+	return cursor;
+}
+
+uint32_t log_format_parse(const char *format, uint8_t *kinds, uint32_t capacity) {
+	uint32_t count = 0;
+
+	for (const char *cursor = format; *cursor;) {
+		if (*cursor != '%') {
+			cursor++;
+			continue;
+		}
+
+		FormatSpec spec;
+		if ((cursor = format_spec_next(cursor, &spec)) == NULL)
+			return UINT32_MAX;
+		if (spec.consumes == false)
+			continue;
+
+		if (count + spec.star_count + 1 > capacity)
+			return UINT32_MAX;
+
+		for (uint32_t star = 0; star < spec.star_count; ++star)
+			kinds[count++] = LOG_ARG_INT;
+		kinds[count++] = spec.kind;
+	}
+
+	return count;
+}
+
+#define ENCODE_VALUE(type)                        \
+	do {                                          \
+		type value = va_arg(args, type);          \
+		if (offset + sizeof(value) > capacity)    \
+			return offset;                        \
+		memcpy(buffer + offset, &value, sizeof(value)); \
+		offset += sizeof(value);                  \
+	} while (0)
+
+usize log_args_encode(uint8_t *buffer, usize capacity, const uint8_t *kinds, uint32_t count, va_list args) {
+	usize offset = 0;
+
+	for (uint32_t index = 0; index < count; ++index) {
+		switch ((LogArgKind)kinds[index]) {
+			case LOG_ARG_INT:
+				ENCODE_VALUE(int);
+				break;
+			case LOG_ARG_LONG:
+				ENCODE_VALUE(long);
+				break;
+			case LOG_ARG_LONG_LONG:
+				ENCODE_VALUE(long long);
+				break;
+			case LOG_ARG_SIZE:
+				ENCODE_VALUE(size_t);
+				break;
+			case LOG_ARG_INTMAX:
+				ENCODE_VALUE(intmax_t);
+				break;
+			case LOG_ARG_PTRDIFF:
+				ENCODE_VALUE(ptrdiff_t);
+				break;
+			case LOG_ARG_DOUBLE:
+				ENCODE_VALUE(double);
+				break;
+			case LOG_ARG_LONG_DOUBLE:
+				ENCODE_VALUE(long double);
+				break;
+			case LOG_ARG_POINTER:
+				ENCODE_VALUE(void *);
+				break;
+			case LOG_ARG_STRING: {
+				const char *string = va_arg(args, const char *);
+				if (string == NULL)
+					string = "(null)";
+				if (offset + sizeof(uint16_t) > capacity)
+					return offset;
+
+				usize length = strlen(string);
+				length = min(length, capacity - offset - sizeof(uint16_t));
+				length = min(length, UINT16_MAX);
+
+				uint16_t length16 = (uint16_t)length;
+				memcpy(buffer + offset, &length16, sizeof(length16));
+				memcpy(buffer + offset + sizeof(length16), string, length);
+				offset += sizeof(length16) + length;
+			} break;
+		}
+	}
+
+	return offset;
+}
+
+typedef struct {
+	const uint8_t *data;
+	usize size, offset;
+} PayloadReader;
+
+static bool32 payload_read(PayloadReader *reader, void *out, usize size) {
+	if (reader->offset + size > reader->size)
+		return false;
+	memcpy(out, reader->data + reader->offset, size);
+	reader->offset += size;
+	return true;
+}
+
+// snprintf with 0-2 leading '*' ints followed by the value
+#define RENDER_VALUE(type)                                                                          \
+	do {                                                                                            \
+		type value;                                                                                 \
+		if (payload_read(&reader, &value, sizeof(value)) == false)                                  \
+			return length;                                                                          \
+		if (spec.star_count == 0)                                                                   \
+			written = snprintf(out, remaining, spec_text, value);                                   \
+		else if (spec.star_count == 1)                                                              \
+			written = snprintf(out, remaining, spec_text, stars[0], value);                         \
+		else                                                                                        \
+			written = snprintf(out, remaining, spec_text, stars[0], stars[1], value);               \
+	} while (0)
+
+usize log_args_render(char *buffer, usize capacity, const char *format, const uint8_t *payload, usize payload_size) {
+	PayloadReader reader = { .data = payload, .size = payload_size };
+	usize length = 0;
+
+	if (capacity)
+		buffer[0] = '\0';
+
+	for (const char *cursor = format; *cursor;) {
+		char *out = buffer + min(length, capacity ? capacity - 1 : 0);
+		usize remaining = capacity > length ? capacity - length : 0;
+		int written = 0;
+
+		if (*cursor != '%') {
+			const char *next = strchr(cursor, '%');
+			usize literal = next ? (usize)(next - cursor) : strlen(cursor);
+			written = snprintf(out, remaining, "%.*s", (int)literal, cursor);
+			cursor += literal;
+			length += written;
+			continue;
+		}
+
+		FormatSpec spec;
+		if ((cursor = format_spec_next(cursor, &spec)) == NULL)
+			break;
+
+		char spec_text[32];
+		if (spec.length >= sizeof(spec_text))
+			break;
+		memcpy(spec_text, spec.start, spec.length);
+		spec_text[spec.length] = '\0';
+
+		if (spec.consumes == false) {
+			written = snprintf(out, remaining, "%%");
+			length += written;
+			continue;
+		}
+
+		int stars[2] = { 0 };
+		for (uint32_t star = 0; star < spec.star_count; ++star) {
+			if (payload_read(&reader, &stars[star], sizeof(int)) == false)
+				return length;
+		}
+
+		switch (spec.kind) {
+			case LOG_ARG_INT:
+				RENDER_VALUE(int);
+				break;
+			case LOG_ARG_LONG:
+				RENDER_VALUE(long);
+				break;
+			case LOG_ARG_LONG_LONG:
+				RENDER_VALUE(long long);
+				break;
+			case LOG_ARG_SIZE:
+				RENDER_VALUE(size_t);
+				break;
+			case LOG_ARG_INTMAX:
+				RENDER_VALUE(intmax_t);
+				break;
+			case LOG_ARG_PTRDIFF:
+				RENDER_VALUE(ptrdiff_t);
+				break;
+			case LOG_ARG_DOUBLE:
+				RENDER_VALUE(double);
+				break;
+			case LOG_ARG_LONG_DOUBLE:
+				RENDER_VALUE(long double);
+				break;
+			case LOG_ARG_POINTER:
+				RENDER_VALUE(void *);
+				break;
+			case LOG_ARG_STRING: {
+				uint16_t string_length;
+				if (payload_read(&reader, &string_length, sizeof(string_length)) == false ||
+					reader.offset + string_length > reader.size)
+					return length;
+
+				// Encoded strings are not terminated, clamp the precision to the stored length
+				const char *string = (const char *)reader.data + reader.offset;
+				reader.offset += string_length;
+
+				int width = spec.width_star ? stars[0] : spec.width;
+				int precision = string_length;
+				if (spec.precision_star)
+					precision = min(precision, stars[spec.width_star ? 1 : 0]);
+				else if (spec.has_precision)
+					precision = min(precision, spec.precision);
+
+				bool32 left = memchr(spec_text, '-', spec.length) != NULL;
+				written = snprintf(out, remaining, left ? "%-*.*s" : "%*.*s", width, precision, string);
+			} break;
+		}
+
+		length += written > 0 ? written : 0;
+	}
+
+	return length;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "common.h"
+
+// Binary log stream: a header followed by site definitions and messages.
+// A site is written once, before its first message; messages carry only
+// the site id, a timestamp and the raw printf argument bytes.
+#define LOG_BINARY_MAGIC 0x474F4C41u // "ALOG"
+#define LOG_BINARY_VERSION 1u
+#define LOG_BINARY_MAX_ARGS 16
+
+typedef enum {
+	LOG_RECORD_SITE = 1,
+	LOG_RECORD_MESSAGE = 2,
+} LogRecordTag;
+
+typedef enum {
+	LOG_ARG_INT,
+	LOG_ARG_LONG,
+	LOG_ARG_LONG_LONG,
+	LOG_ARG_SIZE,
+	LOG_ARG_INTMAX,
+	LOG_ARG_PTRDIFF,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_LONG_DOUBLE,
+	LOG_ARG_POINTER,
+	LOG_ARG_STRING,
+} LogArgKind;
+
+typedef struct {
+	uint32_t magic, version;
+	// Wall clock at open, message timestamps are monotonic offsets from it
+	int64_t base_unix_ns;
+} LogBinaryHeader;
+
+// Messages whose format cannot be encoded go through a site with an empty file, the caller's
+// file and line lead the formatted text and stand in for the site's when printed
+#define LOG_TEXT_SITE_FILE ""
+#define LOG_TEXT_SITE_FORMAT "%s:%d: %s"
+
+// SITE:    tag u8, id u32, level u8, line u32, file_length u16, format_length u16, file, format
+// MESSAGE: tag u8, id u32, timestamp_ns u64, indent u8, payload_size u16, payload
+#define LOG_SITE_RECORD_SIZE (1 + 4 + 1 + 4 + 2 + 2)
+#define LOG_MESSAGE_RECORD_SIZE (1 + 4 + 8 + 1 + 2)
+
+// Returns the number of arguments the format consumes, or UINT32_MAX if it cannot be encoded
+uint32_t log_format_parse(const char *format, uint8_t *kinds, uint32_t capacity);
+
+// Copies the arguments as raw bytes, strings are length prefixed and truncated to fit
+usize log_args_encode(uint8_t *buffer, usize capacity, const uint8_t *kinds, uint32_t count, va_list args);
+// Re-runs the format over encoded arguments, returns the formatted length
+usize log_args_render(char *buffer, usize capacity, const char *format, const uint8_t *payload, usize payload_size);
@@ -1,24 +1,97 @@
+#define _POSIX_C_SOURCE 200809L
 #include "logger.h"
 
 #include "common.h"
+#include "core/atomic.h"
+#include "core/clock.h"
+#include "core/log_binary.h"
+#include "core/thread.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <time.h>
 
+#define LOG_RING_CAPACITY 1024
+#define LOG_MESSAGE_SIZE 224
+#define LOG_WRITER_IDLE_US 1000
+#define LOG_BINARY_BUFFER_SIZE KiB(64)
+
+STATIC_ASSERT((LOG_RING_CAPACITY & (LOG_RING_CAPACITY - 1)) == 0);
+STATIC_ASSERT(LOG_SITE_MAX_ARGS == LOG_BINARY_MAX_ARGS);
+
+// Fixed-size record, formatting of everything but the message is left to the writer thread.
+// Binary records carry the site and encoded arguments in `message` instead of text.
+typedef struct {
+	uint32_t sequence;
+
+	LogLevel level;
+	int line;
+	uint32_t indent;
+	const char *file;
+	time_t timestamp;
+
+	LogSite *site;
+	uint64_t timestamp_ns;
+	uint16_t payload_size;
+
+	char message[LOG_MESSAGE_SIZE];
+} LogRecord;
+
+// Bounded multi-producer, single-consumer ring, each slot sequence tells whose turn it is
+typedef struct {
+	LogRecord records[LOG_RING_CAPACITY];
+	uint32_t write, read;
+
+	Thread *writer;
+	uint32_t running;
+	bool32 exit_registered;
+} LogRing;
+
 typedef struct {
 	LogLevel level;
 	bool32 quiet;
 	uint32_t indent;
 } Logger;
 
+typedef struct {
+	FILE *file;
+	uint32_t enabled;
+
+	uint64_t base_ns;
+	uint32_t next_site;
+	// Bumped per opened file, sites defined in an older one are defined again
+	uint32_t generation;
+
+	// Messages that cannot be encoded are formatted and stored through these, one per level
+	LogSite text_sites[LOG_LEVEL_FATAL + 1];
+} LogBinarySink;
+
 static Logger g_logger = { LOG_LEVEL_TRACE, false, 0 };
+static LogRing g_ring = { 0 };
+static LogBinarySink g_binary = { 0 };
 static const char *g_level_strings[] = {
 	"TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL"
 };
 static const char *g_log_level_colors[] = {
 	"\x1b[94m", "\x1b[36m", "\x1b[32m", "\x1b[33m", "\x1b[31m", "\x1b[35m"
 };
+static const char *g_category_strings[LOG_CATEGORY_COUNT] = {
+	[LOG_CATEGORY_CORE] = "core",
+	[LOG_CATEGORY_AUDIO] = "audio",
+	[LOG_CATEGORY_GAME] = "game",
+	[LOG_CATEGORY_PLAYER] = "player",
+	[LOG_CATEGORY_BOSS] = "boss",
+};
+
+uint32_t logger_category_masks[LOG_CATEGORY_COUNT] = {
+	[LOG_CATEGORY_CORE] = LOG_MASK_ALL,
+	[LOG_CATEGORY_AUDIO] = LOG_MASK_ALL,
+	[LOG_CATEGORY_GAME] = LOG_MASK_ALL,
+	[LOG_CATEGORY_PLAYER] = LOG_MASK_ALL,
+	[LOG_CATEGORY_BOSS] = LOG_MASK_ALL,
+};
 
 const char *logger_level_to_string(LogLevel level) {
 	return g_level_strings[level];
@@ -30,6 +103,58 @@ void logger_set_quiet(bool32 enable) {
 	g_logger.quiet = enable;
 }
 
+void logger_category_set_mask(LogCategory category, uint32_t mask) {
+	if (category < LOG_CATEGORY_COUNT)
+		logger_category_masks[category] = mask & LOG_MASK_ALL;
+}
+
+void logger_category_set_level(LogCategory category, LogLevel level) {
+	logger_category_set_mask(category, LOG_MASK_FROM(level));
+}
+
+static bool32 token_equals(const char *token, usize length, const char *string) {
+	return strlen(string) == length && strncmp(token, string, length) == 0;
+}
+
+bool32 logger_category_configure(const char *spec) {
+	bool32 valid = true;
+
+	while (spec && *spec) {
+		const char *end = strchr(spec, ',');
+		usize length = end ? (usize)(end - spec) : strlen(spec);
+
+		const char *separator = memchr(spec, '=', length);
+		if (separator == NULL) {
+			valid = false;
+		} else {
+			usize name_length = separator - spec;
+			const char *value = separator + 1;
+			usize value_length = length - name_length - 1;
+
+			uint32_t mask = UINT32_MAX;
+			if (token_equals(value, value_length, "off"))
+				mask = 0;
+			for (uint32_t level = 0; level < countof(g_level_strings) && mask == UINT32_MAX; ++level) {
+				if (value_length == strlen(g_level_strings[level]) && strncasecmp(value, g_level_strings[level], value_length) == 0)
+					mask = LOG_MASK_FROM(level);
+			}
+
+			bool32 matched = false;
+			for (uint32_t category = 0; category < LOG_CATEGORY_COUNT && mask != UINT32_MAX; ++category) {
+				if (token_equals(spec, name_length, "all") || token_equals(spec, name_length, g_category_strings[category])) {
+					logger_category_set_mask(category, mask);
+					matched = true;
+				}
+			}
+			valid = valid && matched;
+		}
+
+		spec = end ? end + 1 : NULL;
+	}
+
+	return valid;
+}
+
 static const char *basename(const char *path) {
 	const char *last_slash = strrchr(path, '/');
 	const char *last_backslash = strrchr(path, '\\');
@@ -54,37 +179,356 @@ void logger_dedent(void) {
 		g_logger.indent--;
 }
 
-void logger_log(LogLevel level, const char *file, int line, const char *format, ...) {
-	if (level < g_logger.level) {
-		return;
-	}
-
-	time_t t = time(NULL);
-	struct tm *tm_info = localtime(&t);
+void logger_print(LogLevel level, const char *file, int line, uint32_t indent, int64_t unix_seconds, const char *message) {
+	time_t timestamp = (time_t)unix_seconds;
+	// Synchronous logging prints from whichever thread logs, localtime shares one buffer between them
+	struct tm tm_info;
+#if defined(_WIN32)
+	localtime_s(&tm_info, &timestamp);
+#else
+	localtime_r(&timestamp, &tm_info);
+#endif
 
 	char time_buffer[16];
-	strftime(time_buffer, sizeof(time_buffer), "%H:%M:%S", tm_info);
+	strftime(time_buffer, sizeof(time_buffer), "%H:%M:%S", &tm_info);
 
 	char indent_buffer[32];
 	memset(indent_buffer, ' ', sizeof(indent_buffer));
-	int32_t indent_space = min(g_logger.indent, 15) * 2;
+	int32_t indent_space = min(indent, 15) * 2;
 	indent_buffer[indent_space] = '\0';
 
-	va_list arg_ptr;
-	va_start(arg_ptr, format);
 	printf(
-		"%s %s%s[%s]\x1b[0m \x1b[37m%s:%d:\x1b[0m ",
+		"%s %s%s[%s]\x1b[0m \x1b[37m%s:%d:\x1b[0m %s%s\x1b[0m\n",
 		time_buffer, // Timestamp
 		g_log_level_colors[level], // Start color for the level
 		indent_buffer,
 		g_level_strings[level], // Log level string
 		basename(file), // Source file name
-		line // Line number in source file
-	);
-	if (level >= LOG_LEVEL_ERROR)
-		printf("%s", g_log_level_colors[level]);
-	vprintf(format, arg_ptr);
-	printf("\x1b[0m\n");
+		line, // Line number in source file
+		level >= LOG_LEVEL_ERROR ? g_log_level_colors[level] : "",
+		message);
+}
+
+static void binary_write_site(LogSite *site) {
+	uint8_t header[LOG_SITE_RECORD_SIZE];
+	uint16_t file_length = (uint16_t)strlen(site->file);
+	uint16_t format_length = (uint16_t)strlen(site->format);
+	uint8_t level = (uint8_t)site->level;
+	uint32_t line = (uint32_t)site->line;
+
+	header[0] = LOG_RECORD_SITE;
+	memcpy(header + 1, &site->id, 4);
+	memcpy(header + 5, &level, 1);
+	memcpy(header + 6, &line, 4);
+	memcpy(header + 10, &file_length, 2);
+	memcpy(header + 12, &format_length, 2);
+
+	fwrite(header, 1, sizeof(header), g_binary.file);
+	fwrite(site->file, 1, file_length, g_binary.file);
+	fwrite(site->format, 1, format_length, g_binary.file);
+	site->generation = g_binary.generation;
+}
+
+// Binary records are only written by one thread at a time: the writer, or the caller in sync mode
+static void binary_write_message(LogSite *site, uint64_t timestamp_ns, uint32_t indent, const uint8_t *payload, uint16_t payload_size) {
+	if (g_binary.file == NULL)
+		return;
+	if (site->generation != g_binary.generation)
+		binary_write_site(site);
+
+	uint8_t header[LOG_MESSAGE_RECORD_SIZE];
+	uint8_t indent8 = (uint8_t)min(indent, 255);
+
+	header[0] = LOG_RECORD_MESSAGE;
+	memcpy(header + 1, &site->id, 4);
+	memcpy(header + 5, &timestamp_ns, 8);
+	memcpy(header + 13, &indent8, 1);
+	memcpy(header + 14, &payload_size, 2);
+
+	fwrite(header, 1, sizeof(header), g_binary.file);
+	fwrite(payload, 1, payload_size, g_binary.file);
+}
+
+// Assigns an id and argument layout on first use, returns false if the format cannot be encoded
+static bool32 binary_site_register(LogSite *site, LogLevel level, const char *file, int line, const char *format) {
+	uint32_t state = atomic_load_acquire(&site->state);
+	if (state == 0 && atomic_cas(&site->state, &state, 1)) {
+		site->level = level;
+		site->file = file;
+		site->line = line;
+		site->format = format;
+		site->arg_count = log_format_parse(format, site->arg_kinds, countof(site->arg_kinds));
+		site->id = atomic_add(&g_binary.next_site, 1) + 1;
+
+		atomic_store_release(&site->state, 2);
+		return site->arg_count != UINT32_MAX;
+	}
+
+	while (atomic_load_acquire(&site->state) != 2)
+		atomic_pause();
+
+	return site->arg_count != UINT32_MAX;
+}
+
+// Consumer side, only ever called from the writer thread or after it has been joined
+static uint32_t logger_drain(void) {
+	uint32_t count = 0;
+
+	for (;;) {
+		uint32_t read = g_ring.read;
+		LogRecord *record = &g_ring.records[read & (LOG_RING_CAPACITY - 1)];
+		if (atomic_load_acquire(&record->sequence) != read + 1)
+			break;
+
+		if (record->site)
+			binary_write_message(record->site, record->timestamp_ns, record->indent, (uint8_t *)record->message, record->payload_size);
+		else
+			logger_print(record->level, record->file, record->line, record->indent, record->timestamp, record->message);
+
+		atomic_store_release(&record->sequence, read + LOG_RING_CAPACITY);
+		atomic_store_release(&g_ring.read, read + 1);
+		count++;
+	}
+
+	if (count) {
+		fflush(stdout);
+		if (g_binary.file)
+			fflush(g_binary.file);
+	}
+
+	return count;
+}
+
+static void logger_writer_main(void *user) {
+	while (atomic_load_acquire(&g_ring.running)) {
+		if (logger_drain() == 0)
+			thread_sleep_us(LOG_WRITER_IDLE_US);
+	}
+}
+
+static LogRecord *ring_acquire(uint32_t *sequence) {
+	LogRecord *record = NULL;
+
+	uint32_t write = atomic_load_relaxed(&g_ring.write);
+	for (;;) {
+		record = &g_ring.records[write & (LOG_RING_CAPACITY - 1)];
+		int32_t difference = (int32_t)(atomic_load_acquire(&record->sequence) - write);
+
+		if (difference == 0) {
+			if (atomic_cas(&g_ring.write, &write, write + 1))
+				break;
+		} else if (difference < 0) {
+			// Ring is full, wait for the writer rather than lose the message
+			thread_sleep_us(50);
+			write = atomic_load_relaxed(&g_ring.write);
+		} else
+			write = atomic_load_relaxed(&g_ring.write);
+	}
+
+	*sequence = write + 1;
+	return record;
+}
+
+static void logger_enqueue(LogLevel level, const char *file, int line, const char *format, va_list args) {
+	uint32_t sequence;
+	LogRecord *record = ring_acquire(&sequence);
+
+	record->site = NULL;
+	record->level = level;
+	record->file = file;
+	record->line = line;
+	record->indent = g_logger.indent;
+	record->timestamp = time(NULL);
+	vsnprintf(record->message, sizeof(record->message), format, args);
+
+	atomic_store_release(&record->sequence, sequence);
+}
+
+static void logger_enqueue_binary(LogSite *site, va_list args) {
+	uint64_t timestamp_ns = clock_now_ns() - g_binary.base_ns;
+
+	if (atomic_load_relaxed(&g_ring.running) == false) {
+		uint8_t payload[LOG_MESSAGE_SIZE];
+		usize size = log_args_encode(payload, sizeof(payload), site->arg_kinds, site->arg_count, args);
+		binary_write_message(site, timestamp_ns, g_logger.indent, payload, (uint16_t)size);
+		return;
+	}
+
+	uint32_t sequence;
+	LogRecord *record = ring_acquire(&sequence);
+
+	record->site = site;
+	record->indent = g_logger.indent;
+	record->timestamp_ns = timestamp_ns;
+	record->payload_size = (uint16_t)log_args_encode((uint8_t *)record->message, sizeof(record->message), site->arg_kinds, site->arg_count, args);
+
+	atomic_store_release(&record->sequence, sequence);
+}
+
+static void logger_enqueue_binary_va(LogSite *site, ...) {
+	va_list args;
+	va_start(args, site);
+	logger_enqueue_binary(site, args);
+	va_end(args);
+}
+
+static void logger_log_text_site(LogLevel level, const char *file, int line, const char *message) {
+	LogSite *site = &g_binary.text_sites[level];
+	binary_site_register(site, level, LOG_TEXT_SITE_FILE, 0, LOG_TEXT_SITE_FORMAT);
+	logger_enqueue_binary_va(site, basename(file), line, message);
+}
+
+static void logger_log_binary(LogSite *site, LogLevel level, const char *file, int line, const char *format, va_list args) {
+	if (binary_site_register(site, level, file, line, format)) {
+		logger_enqueue_binary(site, args);
+		return;
+	}
+
+	char message[LOG_MESSAGE_SIZE];
+	vsnprintf(message, sizeof(message), format, args);
+	logger_log_text_site(level, file, line, message);
+}
+
+bool32 logger_binary_open(const char *path) {
+	logger_binary_close();
+
+	FILE *file = fopen(path, "wb");
+	if (file == NULL) {
+		LOG_WARN("Logger: failed to open binary log '%s'", path);
+		return false;
+	}
+	setvbuf(file, NULL, _IOFBF, LOG_BINARY_BUFFER_SIZE);
+
+	g_binary.base_ns = clock_now_ns();
+	LogBinaryHeader header = {
+		.magic = LOG_BINARY_MAGIC,
+		.version = LOG_BINARY_VERSION,
+		.base_unix_ns = (int64_t)time(NULL) * 1000000000LL,
+	};
+	fwrite(&header, sizeof(header), 1, file);
+
+	g_binary.file = file;
+	g_binary.generation++;
+	atomic_store_release(&g_binary.enabled, true);
+	return true;
+}
+
+void logger_binary_close(void) {
+	if (g_binary.file == NULL)
+		return;
+
+	// Stop the writer so nothing is mid-write when the file goes away
+	atomic_store_release(&g_binary.enabled, false);
+	bool32 async = g_ring.writer != NULL;
+	logger_set_async(false);
+
+	fclose(g_binary.file);
+	g_binary.file = NULL;
+
+	if (async)
+		logger_set_async(true);
+}
+
+// Early returns from main would otherwise leave their last messages queued
+static void logger_exit(void) {
+	logger_set_async(false);
+}
+
+void logger_set_async(bool32 enable) {
+	if (enable && g_ring.exit_registered == false)
+		g_ring.exit_registered = atexit(logger_exit) == 0;
+
+	if (enable && g_ring.writer == NULL) {
+		for (uint32_t index = 0; index < LOG_RING_CAPACITY; ++index)
+			g_ring.records[index].sequence = index;
+		g_ring.write = g_ring.read = 0;
+
+		atomic_store_release(&g_ring.running, true);
+		g_ring.writer = thread_create(logger_writer_main, NULL);
+		if (g_ring.writer == NULL)
+			atomic_store_release(&g_ring.running, false);
+	} else if (enable == false && g_ring.writer) {
+		atomic_store_release(&g_ring.running, false);
+		thread_join(g_ring.writer);
+		g_ring.writer = NULL;
+
+		logger_drain();
+	}
+}
+
+void logger_flush(void) {
+	if (atomic_load_acquire(&g_ring.running) == false)
+		return;
+
+	uint32_t target = atomic_load_acquire(&g_ring.write);
+	while ((int32_t)(atomic_load_acquire(&g_ring.read) - target) < 0)
+		thread_sleep_us(50);
+}
+
+// Call sites are shared by every thread that reaches them, worlds on batch threads included.
+// One caller wins the window turnover, counts from calls racing it may land on either side
+bool32 logger_site_allow(LogSite *site, uint32_t per_second, LogLevel level, const char *file, int line) {
+	uint64_t now = clock_now_ns();
+
+	uint64_t start = atomic_load_acquire(&site->window_start);
+	if ((start == 0 || now - start >= 1000000000ULL) && atomic_cas(&site->window_start, &start, now)) {
+		atomic_exchange(&site->emitted, 0);
+		uint32_t suppressed = atomic_exchange(&site->suppressed, 0);
+		if (suppressed)
+			logger_log(level, file, line, "(suppressed %u messages from this site in the last second)", suppressed);
+	}
+
+	if (atomic_add(&site->emitted, 1) < per_second)
+		return true;
+
+	atomic_add(&site->suppressed, 1);
+	return false;
+}
+
+static void logger_logv(LogSite *site, LogLevel level, const char *file, int line, const char *format, va_list args) {
+	if (site && atomic_load_acquire(&g_binary.enabled)) {
+		va_list binary_args;
+		va_copy(binary_args, args);
+		logger_log_binary(site, level, file, line, format, binary_args);
+		va_end(binary_args);
+
+		// Errors are also kept on screen
+		if (level < LOG_LEVEL_ERROR)
+			return;
+	}
+
+	if (level < LOG_LEVEL_FATAL && atomic_load_relaxed(&g_ring.running)) {
+		logger_enqueue(level, file, line, format, args);
+		return;
+	}
+
+	// Fatal messages bypass the ring so they are on screen before the process dies
+	logger_flush();
+
+	char message[1024];
+	vsnprintf(message, sizeof(message), format, args);
+	logger_print(level, file, line, g_logger.indent, time(NULL), message);
 	fflush(stdout);
+}
+
+void logger_log(LogLevel level, const char *file, int line, const char *format, ...) {
+	if (level < g_logger.level) {
+		return;
+	}
+
+	va_list arg_ptr;
+	va_start(arg_ptr, format);
+	logger_logv(NULL, level, file, line, format, arg_ptr);
+	va_end(arg_ptr);
+}
+
+void logger_log_site(LogSite *site, LogLevel level, const char *file, int line, const char *format, ...) {
+	if (level < g_logger.level) {
+		return;
+	}
+
+	va_list arg_ptr;
+	va_start(arg_ptr, format);
+	logger_logv(site, level, file, line, format, arg_ptr);
 	va_end(arg_ptr);
 }
@@ -11,25 +11,109 @@ typedef enum {
 	LOG_LEVEL_FATAL
 } LogLevel;
 
+typedef enum {
+	LOG_CATEGORY_CORE = 0,
+	LOG_CATEGORY_AUDIO,
+	LOG_CATEGORY_GAME,
+	LOG_CATEGORY_PLAYER,
+	LOG_CATEGORY_BOSS,
+
+	LOG_CATEGORY_COUNT
+} LogCategory;
+
+#define LOG_LEVEL_BIT(level) (1u << (level))
+#define LOG_MASK_ALL 0x3Fu
+#define LOG_MASK_FROM(level) (LOG_MASK_ALL & ~(LOG_LEVEL_BIT(level) - 1))
+
+// One bit per LogLevel, read directly at the call site so a disabled category costs a single branch
+extern uint32_t logger_category_masks[LOG_CATEGORY_COUNT];
+
+#define LOG_SITE_MAX_ARGS 16
+
+// Per call-site state, every LOG_* macro declares one static instance
+typedef struct {
+	// Binary sink registration, filled on the first message while the sink is open. The
+	// definition is written again for every file the sink opens, `generation` is the last one
+	uint32_t state, id;
+	uint32_t generation;
+	LogLevel level;
+	const char *file, *format;
+	int line;
+	uint32_t arg_count;
+	uint8_t arg_kinds[LOG_SITE_MAX_ARGS];
+
+	// Rate limiting, see LOG_CAT_LIMIT. Only touched atomically, sites are shared across threads
+	uint64_t window_start;
+	uint32_t emitted, suppressed;
+} LogSite;
+
+#define LOG_AT_(level, ...)                                                   \
+	do {                                                                      \
+		static LogSite log_site_;                                             \
+		logger_log_site(&log_site_, (level), __FILE__, __LINE__, __VA_ARGS__); \
+	} while (0)
+
 #ifndef NDEBUG
-#define LOG_TRACE(...) logger_log(LOG_LEVEL_TRACE, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_DEBUG(...) logger_log(LOG_LEVEL_DEBUG, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_INFO(...) logger_log(LOG_LEVEL_INFO, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_WARN(...) logger_log(LOG_LEVEL_WARN, __FILE__, __LINE__, __VA_ARGS__)
+#define LOG_TRACE(...) LOG_AT_(LOG_LEVEL_TRACE, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT_(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT_(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT_(LOG_LEVEL_WARN, __VA_ARGS__)
 #else
 #define LOG_TRACE(...)
 #define LOG_DEBUG(...)
 #define LOG_INFO(...)
 #define LOG_WARN(...)
 #endif
-#define LOG_ERROR(...) logger_log(LOG_LEVEL_ERROR, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_FATAL(...) logger_log(LOG_LEVEL_FATAL, __FILE__, __LINE__, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT_(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_FATAL(...) LOG_AT_(LOG_LEVEL_FATAL, __VA_ARGS__)
+
+#ifndef NDEBUG
+	#define LOG_CAT_ENABLED(category, level) (logger_category_masks[(category)] & LOG_LEVEL_BIT(level))
+#else
+	#define LOG_CAT_ENABLED(category, level) ((level) >= LOG_LEVEL_ERROR && (logger_category_masks[(category)] & LOG_LEVEL_BIT(level)))
+#endif
+
+#define LOG_CAT(category, level, ...)      \
+	do {                                   \
+		if (LOG_CAT_ENABLED(category, level)) \
+			LOG_AT_((level), __VA_ARGS__);  \
+	} while (0)
+
+// At most `per_second` messages per second from this call site, the rest are summarised
+#define LOG_CAT_LIMIT(category, level, per_second, ...)                                                     \
+	do {                                                                                                     \
+		static LogSite log_site_;                                                                            \
+		if (LOG_CAT_ENABLED(category, level) &&                                                              \
+			logger_site_allow(&log_site_, (per_second), (level), __FILE__, __LINE__))                       \
+			logger_log_site(&log_site_, (level), __FILE__, __LINE__, __VA_ARGS__);                           \
+	} while (0)
 
 const char *logger_level_to_string(LogLevel level);
 void logger_set_level(LogLevel level);
 void logger_set_quiet(bool32 enable);
 
+void logger_category_set_mask(LogCategory category, uint32_t mask);
+void logger_category_set_level(LogCategory category, LogLevel level);
+// Parses "boss=warn,player=off" style lists, "all" addresses every category
+bool32 logger_category_configure(const char *spec);
+
+bool32 logger_site_allow(LogSite *site, uint32_t per_second, LogLevel level, const char *file, int line);
+
 void logger_indent(void);
 void logger_dedent(void);
 
+// Hands formatting and I/O to a background writer thread, callers only fill a ring record.
+// Whatever is still queued when the process exits normally is written out at exit
+void logger_set_async(bool32 enable);
+// Blocks until every message queued so far has been written
+void logger_flush(void);
+
+// While open, messages below LOG_LEVEL_ERROR go only to the binary stream, see tools/log_print.c
+bool32 logger_binary_open(const char *path);
+void logger_binary_close(void);
+
 void logger_log(LogLevel level, const char *file, int line, const char *fmt, ...);
+void logger_log_site(LogSite *site, LogLevel level, const char *file, int line, const char *fmt, ...);
+
+// Writes one line in the colored text format, shared with the offline pretty-printer
+void logger_print(LogLevel level, const char *file, int line, uint32_t indent, int64_t unix_seconds, const char *message);
@@ -49,11 +49,9 @@ Pool *allocator_pool_from_arena(Arena *arena, uint32_t capacity, usize slot_size
 	return pool;
 }
 
+// Only for allocator_pool, the slots share its allocation. Arena pools go with their arena
 void pool_destroy(Pool *pool) {
-	if (pool) {
-		free(pool->slots);
-		free(pool);
-	}
+	free(pool);
 }
 
 void *pool_alloc(Pool *pool) {
@@ -0,0 +1,214 @@
+#include "profiler.h"
+
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+	const char *name;
+	uint64_t start_ns, duration_ns;
+	// Time spent in nested zones, the rest is this zone's own
+	uint64_t child_ns;
+	uint32_t depth;
+} ZoneRecord;
+
+typedef struct {
+	bool32 enabled, in_frame;
+	float budget_ms, hitch_ms;
+	uint64_t pacing_target_ns;
+
+	uint64_t frame_index, frame_start_ns;
+	ZoneRecord zones[PROFILER_MAX_ZONES];
+	uint32_t zone_count;
+	uint32_t stack[PROFILER_MAX_DEPTH];
+	uint32_t depth;
+
+	// Ring of finished frames, head is the next one written
+	ProfilerFrame history[PROFILER_HISTORY];
+	uint32_t history_head, history_count;
+} Profiler;
+
+// One per thread so worlds updating on batch threads never share zones
+static THREAD_LOCAL Profiler profiler = { .budget_ms = 1000.0f / 60.0f };
+
+void profiler_enable(bool32 enable) {
+	profiler.enabled = enable;
+	profiler.in_frame = false;
+}
+
+void profiler_set_budget_ms(float budget_ms) {
+	profiler.budget_ms = budget_ms;
+}
+
+void profiler_set_hitch_ms(float hitch_ms) {
+	profiler.hitch_ms = hitch_ms;
+}
+
+void profiler_frame_begin(void) {
+	if (profiler.enabled == false)
+		return;
+
+	profiler.in_frame = true;
+	profiler.zone_count = 0;
+	profiler.depth = 0;
+	profiler.frame_start_ns = clock_now_ns();
+}
+
+uint32_t profiler_zone_begin(const char *name) {
+	if (profiler.in_frame == false || profiler.zone_count >= PROFILER_MAX_ZONES || profiler.depth >= PROFILER_MAX_DEPTH)
+		return INVALID_INDEX;
+
+	uint32_t zone = profiler.zone_count++;
+	profiler.zones[zone] = (ZoneRecord){ .name = name, .depth = profiler.depth, .start_ns = clock_now_ns() };
+	profiler.stack[profiler.depth++] = zone;
+	return zone;
+}
+
+void profiler_zone_end(uint32_t zone) {
+	if (zone == INVALID_INDEX || profiler.in_frame == false)
+		return;
+
+	// Closing an outer zone closes anything left open inside it
+	uint64_t now = clock_now_ns();
+	while (profiler.depth > 0) {
+		uint32_t top = profiler.stack[--profiler.depth];
+		ZoneRecord *record = &profiler.zones[top];
+		record->duration_ns = now - record->start_ns;
+		if (profiler.depth > 0)
+			profiler.zones[profiler.stack[profiler.depth - 1]].child_ns += record->duration_ns;
+		if (top == zone)
+			break;
+	}
+}
+
+const char *profiler_zone_current(void) {
+	if (profiler.in_frame == false || profiler.depth == 0)
+		return NULL;
+	return profiler.zones[profiler.stack[profiler.depth - 1]].name;
+}
+
+static void profiler_hitch_log(const ProfilerFrame *frame) {
+	LOG_CAT(LOG_CATEGORY_CORE, LOG_LEVEL_WARN, "Profiler: hitch on frame %llu, %.2f ms against a %.2f ms threshold",
+		(unsigned long long)frame->index, frame->duration_ns / 1e6, profiler.hitch_ms);
+
+	for (uint32_t index = 0; index < profiler.zone_count; index++) {
+		const ZoneRecord *record = &profiler.zones[index];
+		LOG_CAT(LOG_CATEGORY_CORE, LOG_LEVEL_WARN, "Profiler: %*s%s %.3f ms, self %.3f ms", (int)record->depth * 2, "", record->name,
+			record->duration_ns / 1e6, (record->duration_ns - record->child_ns) / 1e6);
+	}
+}
+
+void profiler_frame_end(void) {
+	if (profiler.in_frame == false)
+		return;
+
+	while (profiler.depth > 0)
+		profiler_zone_end(profiler.stack[0]);
+	profiler.in_frame = false;
+
+	ProfilerFrame *frame = &profiler.history[profiler.history_head];
+	*frame = (ProfilerFrame){ .index = profiler.frame_index++, .duration_ns = clock_now_ns() - profiler.frame_start_ns };
+	profiler.history_head = (profiler.history_head + 1) % PROFILER_HISTORY;
+	profiler.history_count = min(profiler.history_count + 1, (uint32_t)PROFILER_HISTORY);
+
+	// Self time summed by name, a zone entered several times a frame counts once
+	ProfilerZoneTime totals[PROFILER_MAX_ZONES + 1];
+	uint32_t total_count = 0;
+	uint64_t other_ns = frame->duration_ns;
+
+	for (uint32_t index = 0; index < profiler.zone_count; index++) {
+		const ZoneRecord *record = &profiler.zones[index];
+		if (record->depth == 0)
+			other_ns -= min(other_ns, record->duration_ns);
+
+		uint32_t total = 0;
+		while (total < total_count && strcmp(totals[total].name, record->name) != 0)
+			total++;
+		if (total == total_count)
+			totals[total_count++] = (ProfilerZoneTime){ .name = record->name };
+		totals[total].duration_ns += record->duration_ns - record->child_ns;
+	}
+	totals[total_count++] = (ProfilerZoneTime){ .name = "other", .duration_ns = other_ns };
+
+	for (uint32_t slot = 0; slot < PROFILER_TOP_ZONES && slot < total_count; slot++) {
+		uint32_t heaviest = slot;
+		for (uint32_t index = slot + 1; index < total_count; index++)
+			if (totals[index].duration_ns > totals[heaviest].duration_ns)
+				heaviest = index;
+
+		ProfilerZoneTime swap = totals[slot];
+		totals[slot] = totals[heaviest];
+		totals[heaviest] = swap;
+		frame->top[slot] = totals[slot];
+	}
+
+	if (profiler.hitch_ms > 0.0f && frame->duration_ns / 1e6 > profiler.hitch_ms)
+		profiler_hitch_log(frame);
+}
+
+void profiler_frame_interval(uint64_t interval_ns, uint64_t target_ns) {
+	if (profiler.enabled == false || profiler.history_count == 0)
+		return;
+
+	profiler.history[(profiler.history_head + PROFILER_HISTORY - 1) % PROFILER_HISTORY].interval_ns = interval_ns;
+	profiler.pacing_target_ns = target_ns;
+}
+
+static int compare_float(const void *a, const void *b) {
+	float left = *(const float *)a, right = *(const float *)b;
+	return (left > right) - (left < right);
+}
+
+ProfilerStats profiler_stats(void) {
+	ProfilerStats stats = { .frame_count = profiler.history_count, .budget_ms = profiler.budget_ms };
+	if (profiler.history_count == 0)
+		return stats;
+
+	float frame_ms[PROFILER_HISTORY];
+	uint32_t count = profiler_history(frame_ms, countof(frame_ms));
+
+	float jitter_ms[PROFILER_HISTORY];
+	uint32_t jitter_count = 0;
+	double jitter_total = 0;
+
+	uint32_t oldest = (profiler.history_head + PROFILER_HISTORY - count) % PROFILER_HISTORY;
+	double total = 0;
+	for (uint32_t index = 0; index < count; index++) {
+		const ProfilerFrame *frame = &profiler.history[(oldest + index) % PROFILER_HISTORY];
+		if (stats.slowest == NULL || frame->duration_ns > stats.slowest->duration_ns)
+			stats.slowest = frame;
+
+		total += frame_ms[index];
+		stats.over_budget += frame_ms[index] > profiler.budget_ms;
+
+		if (frame->interval_ns) {
+			int64_t error = (int64_t)frame->interval_ns - (int64_t)profiler.pacing_target_ns;
+			jitter_ms[jitter_count] = (error < 0 ? -error : error) / 1e6f;
+			jitter_total += jitter_ms[jitter_count++];
+		}
+	}
+
+	if (jitter_count) {
+		qsort(jitter_ms, jitter_count, sizeof(*jitter_ms), compare_float);
+		stats.jitter_ms = (float)(jitter_total / jitter_count);
+		stats.jitter_p99_ms = jitter_ms[(jitter_count * 99 + 99) / 100 - 1];
+	}
+
+	qsort(frame_ms, count, sizeof(*frame_ms), compare_float);
+	stats.min_ms = frame_ms[0];
+	stats.max_ms = frame_ms[count - 1];
+	stats.p99_ms = frame_ms[(count * 99 + 99) / 100 - 1];
+	stats.average_ms = (float)(total / count);
+	return stats;
+}
+
+uint32_t profiler_history(float *frame_ms, uint32_t capacity) {
+	uint32_t count = min(capacity, profiler.history_count);
+	uint32_t oldest = (profiler.history_head + PROFILER_HISTORY - count) % PROFILER_HISTORY;
+	for (uint32_t index = 0; index < count; index++)
+		frame_ms[index] = profiler.history[(oldest + index) % PROFILER_HISTORY].duration_ns / 1e6f;
+	return count;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "common.h"
+
+// Per-frame zone timings for the thread that enables it. Zones nest and are
+// cheap enough to leave in shipping builds, threads that never enable the
+// profiler pay one branch per zone.
+//
+//     profiler_frame_begin();
+//     uint32_t zone = profiler_zone_begin("update");
+//     world_update(...);
+//     profiler_zone_end(zone);
+//     profiler_frame_end();
+
+#define PROFILER_HISTORY 240
+#define PROFILER_MAX_ZONES 128
+#define PROFILER_MAX_DEPTH 16
+#define PROFILER_TOP_ZONES 3
+
+typedef struct {
+	// Must outlive the frame, string literals in practice
+	const char *name;
+	uint64_t duration_ns;
+} ProfilerZoneTime;
+
+typedef struct {
+	uint64_t index;
+	uint64_t duration_ns;
+	// Present to present as the frame pacer saw it, 0 when nothing paces the frames
+	uint64_t interval_ns;
+	// Heaviest zones by self time, time outside every zone counts as "other"
+	ProfilerZoneTime top[PROFILER_TOP_ZONES];
+} ProfilerFrame;
+
+// Over the frames still in the history window
+typedef struct {
+	uint32_t frame_count;
+	float min_ms, average_ms, p99_ms, max_ms;
+	uint32_t over_budget;
+	float budget_ms;
+
+	// How far present intervals strayed from the pacing target
+	float jitter_ms, jitter_p99_ms;
+
+	const ProfilerFrame *slowest;
+} ProfilerStats;
+
+void profiler_enable(bool32 enable);
+// Frames longer than the budget count as over budget, longer than the hitch threshold log their zones. 0 turns hitch logging off
+void profiler_set_budget_ms(float budget_ms);
+void profiler_set_hitch_ms(float hitch_ms);
+
+void profiler_frame_begin(void);
+void profiler_frame_end(void);
+
+// Returns a handle for profiler_zone_end, calls outside a frame or on a disabled thread do nothing
+uint32_t profiler_zone_begin(const char *name);
+void profiler_zone_end(uint32_t zone);
+// Innermost open zone on this thread, NULL outside every zone
+const char *profiler_zone_current(void);
+
+// Called once the frame is presented, lands on the frame profiler_frame_end last closed
+void profiler_frame_interval(uint64_t interval_ns, uint64_t target_ns);
+
+ProfilerStats profiler_stats(void);
+// Frame times in milliseconds, oldest first, returns how many were written
+uint32_t profiler_history(float *frame_ms, uint32_t capacity);
@@ -0,0 +1,110 @@
+#include "random.h"
+
+#define PCG_MULTIPLIER 6364136223846793005ull
+
+static inline uint32_t pcg_step(uint64_t *state, uint64_t increment) {
+	uint64_t old = *state;
+	*state = old * PCG_MULTIPLIER + increment;
+
+	uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+	uint32_t rotation = (uint32_t)(old >> 59u);
+	return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31));
+}
+
+// Lemire's multiply-shift with rejection, `range` of 0 means the full 32 bits
+static inline uint32_t pcg_bounded(uint64_t *state, uint64_t increment, uint32_t range) {
+	uint32_t value = pcg_step(state, increment);
+	if (range == 0)
+		return value;
+
+	uint64_t product = (uint64_t)value * range;
+	uint32_t low = (uint32_t)product;
+	if (low < range) {
+		uint32_t threshold = (0u - range) % range;
+		while (low < threshold) {
+			value = pcg_step(state, increment);
+			product = (uint64_t)value * range;
+			low = (uint32_t)product;
+		}
+	}
+
+	return (uint32_t)(product >> 32);
+}
+
+static inline float unit_float(uint32_t value) {
+	return (float)(value >> 8) * (1.0f / 16777216.0f);
+}
+
+Rng rng_seed(uint64_t seed, uint64_t stream) {
+	Rng rng = { .state = 0, .increment = (stream << 1u) | 1u };
+
+	pcg_step(&rng.state, rng.increment);
+	rng.state += seed;
+	pcg_step(&rng.state, rng.increment);
+
+	return rng;
+}
+
+Rng rng_fork(Rng *parent, uint64_t stream) {
+	uint64_t high = rng_next(parent);
+	uint64_t seed = (high << 32) | rng_next(parent);
+	return rng_seed(seed, stream);
+}
+
+uint32_t rng_next(Rng *rng) {
+	return pcg_step(&rng->state, rng->increment);
+}
+
+int32_t rng_range(Rng *rng, int32_t min, int32_t max) {
+	if (min > max) {
+		int32_t swap = min;
+		min = max;
+		max = swap;
+	}
+
+	uint32_t range = (uint32_t)((int64_t)max - (int64_t)min + 1);
+	return (int32_t)((int64_t)min + pcg_bounded(&rng->state, rng->increment, range));
+}
+
+float rng_float(Rng *rng) {
+	return unit_float(rng_next(rng));
+}
+
+float rng_float_range(Rng *rng, float min, float max) {
+	return min + (max - min) * rng_float(rng);
+}
+
+void rng_fill_u32(Rng *rng, uint32_t *out, usize count) {
+	uint64_t state = rng->state;
+	for (usize index = 0; index < count; index++)
+		out[index] = pcg_step(&state, rng->increment);
+	rng->state = state;
+}
+
+void rng_fill_range(Rng *rng, int32_t *out, usize count, usize stride, int32_t min, int32_t max) {
+	if (min > max) {
+		int32_t swap = min;
+		min = max;
+		max = swap;
+	}
+
+	uint32_t range = (uint32_t)((int64_t)max - (int64_t)min + 1);
+	uint64_t state = rng->state;
+	uint8_t *cursor = (uint8_t *)out;
+
+	for (usize index = 0; index < count; index++, cursor += stride)
+		*(int32_t *)cursor = (int32_t)((int64_t)min + pcg_bounded(&state, rng->increment, range));
+
+	rng->state = state;
+}
+
+void rng_fill_float_range(Rng *rng, float *out, usize count, usize stride, float min, float max) {
+	float span = max - min;
+	uint64_t state = rng->state;
+	uint8_t *cursor = (uint8_t *)out;
+
+	for (usize index = 0; index < count; index++, cursor += stride)
+		*(float *)cursor = min + span * unit_float(pcg_step(&state, rng->increment));
+
+	rng->state = state;
+}
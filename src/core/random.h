@@ -0,0 +1,28 @@
+#pragma once
+
+#include "common.h"
+
+// PCG32 (XSH-RR). Each generator is 16 bytes of plain state so systems can own
+// their own stream and snapshot it with the rest of their data. Generators with
+// the same seed but different stream ids produce independent sequences.
+typedef struct {
+	uint64_t state;
+	uint64_t increment;
+} Rng;
+
+Rng rng_seed(uint64_t seed, uint64_t stream);
+// Derives a new generator for `stream`, advancing the parent once
+Rng rng_fork(Rng *parent, uint64_t stream);
+
+uint32_t rng_next(Rng *rng);
+// Inclusive on both ends like GetRandomValue, unbiased
+int32_t rng_range(Rng *rng, int32_t min, int32_t max);
+// [0, 1)
+float rng_float(Rng *rng);
+float rng_float_range(Rng *rng, float min, float max);
+
+// Batched generation. `stride` is the distance in bytes between outputs so a single
+// field of an array of structs can be filled in place, pass sizeof(element) for a plain array.
+void rng_fill_u32(Rng *rng, uint32_t *out, usize count);
+void rng_fill_range(Rng *rng, int32_t *out, usize count, usize stride, int32_t min, int32_t max);
+void rng_fill_float_range(Rng *rng, float *out, usize count, usize stride, float min, float max);
@@ -0,0 +1,73 @@
+#define _POSIX_C_SOURCE 200809L
+#include "thread.h"
+
+#include "core/logger.h"
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#if THREADS_AVAILABLE
+	#include <pthread.h>
+#endif
+
+struct thread {
+#if THREADS_AVAILABLE
+	pthread_t handle;
+#endif
+	PFN_thread_entry entry;
+	void *user;
+};
+
+#if THREADS_AVAILABLE
+static void *thread_trampoline(void *argument) {
+	Thread *thread = argument;
+	thread->entry(thread->user);
+	return NULL;
+}
+#endif
+
+Thread *thread_create(PFN_thread_entry entry, void *user) {
+#if THREADS_AVAILABLE
+	Thread *thread = malloc(sizeof(Thread));
+	thread->entry = entry;
+	thread->user = user;
+
+	if (pthread_create(&thread->handle, NULL, thread_trampoline, thread) != 0) {
+		LOG_WARN("Thread: failed to spawn thread");
+		free(thread);
+		return NULL;
+	}
+
+	return thread;
+#else
+	return NULL;
+#endif
+}
+
+void thread_join(Thread *thread) {
+	if (thread == NULL)
+		return;
+
+#if THREADS_AVAILABLE
+	pthread_join(thread->handle, NULL);
+#endif
+	free(thread);
+}
+
+void thread_sleep_us(uint64_t microseconds) {
+	struct timespec duration = {
+		.tv_sec = (time_t)(microseconds / 1000000ULL),
+		.tv_nsec = (long)((microseconds % 1000000ULL) * 1000ULL),
+	};
+	nanosleep(&duration, NULL);
+}
+
+uint32_t thread_hardware_concurrency(void) {
+#if THREADS_AVAILABLE
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (uint32_t)count : 1;
+#else
+	return 1;
+#endif
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "common.h"
+
+#if defined(PLATFORM_WEB)
+	#define THREADS_AVAILABLE 0
+#else
+	#define THREADS_AVAILABLE 1
+#endif
+
+// Storage duration of one copy per thread, C99 has no _Thread_local
+#if defined(_MSC_VER)
+	#define THREAD_LOCAL __declspec(thread)
+#else
+	#define THREAD_LOCAL __thread
+#endif
+
+typedef struct thread Thread;
+typedef void (*PFN_thread_entry)(void *user);
+
+// Returns NULL when threads are unavailable, callers fall back to doing the work inline
+Thread *thread_create(PFN_thread_entry entry, void *user);
+void thread_join(Thread *thread);
+
+void thread_sleep_us(uint64_t microseconds);
+uint32_t thread_hardware_concurrency(void);
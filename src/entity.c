@@ -1,35 +1,63 @@
 #include "entity.h"
 
-void entity_update_physics(Entity *entity, float drag, float dt) {
-	entity->position = Vector2Add(entity->position, entity->velocity);
-	entity->velocity = Vector2Scale(entity->velocity, drag);
+// Only the render thread draws, worlds on batch threads never touch it
+static uint32_t entity_draw_count;
+
+void entity_body_update_physics(EntityBody *body, float drag, float dt) {
+	body->position = Vector2Add(body->position, body->velocity);
+	body->velocity = Vector2Scale(body->velocity, drag);
 }
 
-void entity_sync_collision(Entity *entity) {
-	entity->collision_shape.x = entity->position.x - entity->collision_shape.width * .5f;
-	entity->collision_shape.y = entity->position.y - entity->collision_shape.height * .5f;
+void entity_body_sync_collision(EntityBody *body) {
+	body->collision_shape.x = body->position.x - body->collision_shape.width * .5f;
+	body->collision_shape.y = body->position.y - body->collision_shape.height * .5f;
 }
 
-void entity_draw(Entity *entity) {
+void entity_body_draw(const EntityBody *body, const EntitySprite *sprite) {
+	entity_draw_count++;
+
 	Rectangle dest = {
-		.x = entity->position.x,
-		.y = entity->position.y,
-		.width = entity->size.x,
-		.height = entity->size.y
+		.x = body->position.x,
+		.y = body->position.y,
+		.width = body->size.x,
+		.height = body->size.y
 	};
 
-	if (entity->texture) {
-		Vector2 origin = { entity->size.x * .5f, entity->size.y * .5f };
+	if (sprite->texture) {
+		Vector2 origin = { body->size.x * .5f, body->size.y * .5f };
 		DrawTexturePro(
-			*entity->texture,
-			entity->area,
+			*sprite->texture,
+			sprite->area,
 			dest,
 			origin,
-			entity->rotation,
-			entity->tint);
+			body->rotation,
+			sprite->tint);
 
 	} else
-		DrawRectanglePro(dest, (Vector2){ entity->size.x * .5f, entity->size.y * .5f }, entity->rotation, entity->tint);
+		DrawRectanglePro(dest, (Vector2){ body->size.x * .5f, body->size.y * .5f }, body->rotation, sprite->tint);
 
 	// DrawCircleV(sprite.position, 5.f, RED);
 }
+
+void entity_bodies_draw(const EntityBody *bodies, const EntitySprite *sprites, uint32_t count) {
+	for (uint32_t index = 0; index < count; index++)
+		entity_body_draw(&bodies[index], &sprites[index]);
+}
+
+uint32_t entity_draw_count_take(void) {
+	uint32_t count = entity_draw_count;
+	entity_draw_count = 0;
+	return count;
+}
+
+void entity_update_physics(Entity *entity, float drag, float dt) {
+	entity_body_update_physics(&entity->body, drag, dt);
+}
+
+void entity_sync_collision(Entity *entity) {
+	entity_body_sync_collision(&entity->body);
+}
+
+void entity_draw(Entity *entity) {
+	entity_body_draw(&entity->body, &entity->sprite);
+}
@@ -5,25 +5,42 @@
 #include <raylib.h>
 #include <raymath.h>
 
+// Touched every tick by movement and collision. Size stays here since
+// wrapping and collision setup read it as the physical extent.
 typedef struct {
-	bool32 active;
-
 	Vector2 position;
 	Vector2 velocity;
 	Vector2 size;
 	float rotation;
 
-    bool collision_active;
+	bool32 collision_active;
 	Rectangle collision_shape;
+} EntityBody;
 
-    float bullet_damage;
-    float bullet_life_timer;
-
+// Only read when drawing
+typedef struct {
 	Rectangle area;
 	Color tint;
 	Texture2D *texture;
+} EntitySprite;
+
+// Single entities embed both halves, pooled systems keep them in separate columns.
+// Batch movement over body columns lives in entity_physics.h
+typedef struct {
+	bool32 active;
+
+	EntityBody body;
+	EntitySprite sprite;
 } Entity;
 
+void entity_body_update_physics(EntityBody *body, float drag, float dt);
+void entity_body_sync_collision(EntityBody *body);
+void entity_body_draw(const EntityBody *body, const EntitySprite *sprite);
+
+void entity_bodies_draw(const EntityBody *bodies, const EntitySprite *sprites, uint32_t count);
+// Bodies drawn since the last call, frame benchmarks take it once per frame
+uint32_t entity_draw_count_take(void);
+
 void entity_update_physics(Entity *entity, float drag, float dt);
 void entity_sync_collision(Entity *entity);
 void entity_draw(Entity *entity);
@@ -0,0 +1,321 @@
+#include "entity_physics.h"
+
+#include "core/logger.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+	#define ENTITY_PHYSICS_X86 1
+	#include <cpuid.h>
+	#include <immintrin.h>
+#else
+	#define ENTITY_PHYSICS_X86 0
+#endif
+
+// The vector paths load position and velocity as one 4-float row
+STATIC_ASSERT(offsetof(EntityBody, velocity) == offsetof(EntityBody, position) + sizeof(Vector2));
+
+#define SELF_CHECK_BODIES 1027
+
+typedef void (*PFN_integrate)(EntityBody *bodies, uint32_t count, const EntityMotion *motion);
+
+static void integrate_scalar(EntityBody *bodies, uint32_t count, const EntityMotion *motion);
+#if ENTITY_PHYSICS_X86
+static void integrate_sse2(EntityBody *bodies, uint32_t count, const EntityMotion *motion);
+static void integrate_avx2(EntityBody *bodies, uint32_t count, const EntityMotion *motion);
+#endif
+
+static const char *backend_names[ENTITY_PHYSICS_COUNT] = {
+	[ENTITY_PHYSICS_SCALAR] = "scalar",
+	[ENTITY_PHYSICS_SSE2] = "sse2",
+	[ENTITY_PHYSICS_AVX2] = "avx2",
+};
+
+static PFN_integrate backend_functions[ENTITY_PHYSICS_COUNT] = {
+	[ENTITY_PHYSICS_SCALAR] = integrate_scalar,
+#if ENTITY_PHYSICS_X86
+	[ENTITY_PHYSICS_SSE2] = integrate_sse2,
+	[ENTITY_PHYSICS_AVX2] = integrate_avx2,
+#endif
+};
+
+static struct {
+	bool32 initialized;
+	uint32_t supported_mask;
+
+	EntityPhysicsBackend backend;
+	PFN_integrate integrate;
+} physics = { 0 };
+
+static void integrate_scalar(EntityBody *bodies, uint32_t count, const EntityMotion *motion) {
+	for (uint32_t index = 0; index < count; index++) {
+		EntityBody *body = &bodies[index];
+
+		body->position.x = body->position.x + body->velocity.x * motion->velocity_scale;
+		body->position.y = body->position.y + body->velocity.y * motion->velocity_scale;
+		body->velocity.x = body->velocity.x * motion->drag;
+		body->velocity.y = body->velocity.y * motion->drag;
+
+		if (motion->wrap) {
+			float margin_x = body->size.x * motion->wrap_margin;
+			float margin_y = body->size.y * motion->wrap_margin;
+			float high_x = motion->bounds.x + margin_x;
+			float high_y = motion->bounds.y + margin_y;
+
+			if (body->position.x < -margin_x)
+				body->position.x = high_x;
+			else if (body->position.x > high_x)
+				body->position.x = -margin_x;
+
+			if (body->position.y < -margin_y)
+				body->position.y = high_y;
+			else if (body->position.y > high_y)
+				body->position.y = -margin_y;
+		}
+
+		body->collision_shape.x = body->position.x - body->collision_shape.width * .5f;
+		body->collision_shape.y = body->position.y - body->collision_shape.height * .5f;
+	}
+}
+
+#if ENTITY_PHYSICS_X86
+
+// x and y of one body per register, lanes 2 and 3 are ignored
+__attribute__((target("sse2"))) static inline void integrate_one_sse2(EntityBody *body, const EntityMotion *motion, __m128 bounds) {
+	const __m128 scale = _mm_set1_ps(motion->velocity_scale);
+	const __m128 drag = _mm_set1_ps(motion->drag);
+	const __m128 half = _mm_set1_ps(.5f);
+
+	__m128 position_velocity = _mm_loadu_ps(&body->position.x);
+	__m128 velocity = _mm_movehl_ps(position_velocity, position_velocity);
+	__m128 position = _mm_add_ps(position_velocity, _mm_mul_ps(velocity, scale));
+	velocity = _mm_mul_ps(velocity, drag);
+
+	if (motion->wrap) {
+		__m128 size = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)&body->size);
+		__m128 margin = _mm_mul_ps(size, _mm_set1_ps(motion->wrap_margin));
+		__m128 low = _mm_xor_ps(margin, _mm_set1_ps(-0.0f));
+		__m128 high = _mm_add_ps(bounds, margin);
+
+		__m128 below = _mm_cmplt_ps(position, low);
+		__m128 above = _mm_andnot_ps(below, _mm_cmpgt_ps(position, high));
+
+		position = _mm_or_ps(_mm_and_ps(below, high), _mm_andnot_ps(below, position));
+		position = _mm_or_ps(_mm_and_ps(above, low), _mm_andnot_ps(above, position));
+	}
+
+	_mm_storeu_ps(&body->position.x, _mm_movelh_ps(position, velocity));
+
+	__m128 shape = _mm_loadu_ps(&body->collision_shape.x);
+	__m128 extent = _mm_movehl_ps(shape, shape);
+	__m128 corner = _mm_sub_ps(position, _mm_mul_ps(extent, half));
+	_mm_storeu_ps(&body->collision_shape.x, _mm_movelh_ps(corner, extent));
+}
+
+__attribute__((target("sse2"))) static void integrate_sse2(EntityBody *bodies, uint32_t count, const EntityMotion *motion) {
+	const __m128 bounds = _mm_setr_ps(motion->bounds.x, motion->bounds.y, 0.0f, 0.0f);
+
+	for (uint32_t index = 0; index < count; index++)
+		integrate_one_sse2(&bodies[index], motion, bounds);
+}
+
+// Two bodies per register, one in each 128-bit half, laid out like the SSE2 path
+__attribute__((target("avx2"))) static inline __m256 load_pair(const float *a, const float *b) {
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(a)), _mm_loadu_ps(b), 1);
+}
+
+__attribute__((target("avx2"))) static inline void store_pair(float *a, float *b, __m256 value) {
+	_mm_storeu_ps(a, _mm256_castps256_ps128(value));
+	_mm_storeu_ps(b, _mm256_extractf128_ps(value, 1));
+}
+
+__attribute__((target("avx2"))) static void integrate_avx2(EntityBody *bodies, uint32_t count, const EntityMotion *motion) {
+	const __m256 scale = _mm256_set1_ps(motion->velocity_scale);
+	const __m256 drag = _mm256_set1_ps(motion->drag);
+	const __m256 wrap_margin = _mm256_set1_ps(motion->wrap_margin);
+	const __m256 sign = _mm256_set1_ps(-0.0f);
+	const __m256 half = _mm256_set1_ps(.5f);
+	const __m256 bounds = _mm256_setr_ps(motion->bounds.x, motion->bounds.y, 0.0f, 0.0f, motion->bounds.x, motion->bounds.y, 0.0f, 0.0f);
+
+	uint32_t index = 0;
+	for (; index + 2 <= count; index += 2) {
+		EntityBody *a = &bodies[index];
+		EntityBody *b = &bodies[index + 1];
+
+		__m256 position_velocity = load_pair(&a->position.x, &b->position.x);
+		__m256 velocity = _mm256_permute_ps(position_velocity, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 position = _mm256_add_ps(position_velocity, _mm256_mul_ps(velocity, scale));
+		velocity = _mm256_mul_ps(velocity, drag);
+
+		if (motion->wrap) {
+			// Lanes 2 and 3 pick up rotation and the collision flag, they are never stored
+			__m256 size = load_pair(&a->size.x, &b->size.x);
+			__m256 margin = _mm256_mul_ps(size, wrap_margin);
+			__m256 low = _mm256_xor_ps(margin, sign);
+			__m256 high = _mm256_add_ps(bounds, margin);
+
+			__m256 below = _mm256_cmp_ps(position, low, _CMP_LT_OQ);
+			__m256 above = _mm256_andnot_ps(below, _mm256_cmp_ps(position, high, _CMP_GT_OQ));
+
+			position = _mm256_blendv_ps(position, high, below);
+			position = _mm256_blendv_ps(position, low, above);
+		}
+
+		store_pair(&a->position.x, &b->position.x, _mm256_shuffle_ps(position, velocity, _MM_SHUFFLE(1, 0, 1, 0)));
+
+		__m256 shape = load_pair(&a->collision_shape.x, &b->collision_shape.x);
+		__m256 extent = _mm256_permute_ps(shape, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 corner = _mm256_sub_ps(position, _mm256_mul_ps(extent, half));
+		store_pair(&a->collision_shape.x, &b->collision_shape.x, _mm256_shuffle_ps(corner, shape, _MM_SHUFFLE(3, 2, 1, 0)));
+	}
+
+	if (index < count)
+		integrate_sse2(bodies + index, count - index, motion);
+}
+
+static uint32_t detect_supported(void) {
+	uint32_t mask = 1u << ENTITY_PHYSICS_SCALAR;
+	unsigned int eax, ebx, ecx, edx;
+
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+		return mask;
+
+	if (edx & bit_SSE2)
+		mask |= 1u << ENTITY_PHYSICS_SSE2;
+
+	// AVX state has to be enabled by the OS as well, XCR0 bits 1 and 2
+	bool32 os_avx = false;
+	if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX)) {
+		unsigned int xcr0_low, xcr0_high;
+		__asm__ volatile("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+		os_avx = (xcr0_low & 0x6) == 0x6;
+	}
+
+	if (os_avx && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2))
+		mask |= 1u << ENTITY_PHYSICS_AVX2;
+
+	return mask;
+}
+
+#else
+
+static uint32_t detect_supported(void) {
+	return 1u << ENTITY_PHYSICS_SCALAR;
+}
+
+#endif
+
+static void physics_initialize(void) {
+	if (physics.initialized)
+		return;
+
+	physics.initialized = true;
+	physics.supported_mask = detect_supported();
+
+	EntityPhysicsBackend best = ENTITY_PHYSICS_SCALAR;
+	for (uint32_t backend = 0; backend < ENTITY_PHYSICS_COUNT; backend++)
+		if (physics.supported_mask & (1u << backend))
+			best = backend;
+
+	entity_physics_select(best);
+	LOG_CAT(LOG_CATEGORY_CORE, LOG_LEVEL_INFO, "Physics: using %s batch integration", backend_names[best]);
+}
+
+void entity_bodies_integrate(EntityBody *bodies, uint32_t count, const EntityMotion *motion) {
+	if (physics.initialized == false)
+		physics_initialize();
+
+	physics.integrate(bodies, count, motion);
+}
+
+EntityPhysicsBackend entity_physics_backend(void) {
+	physics_initialize();
+	return physics.backend;
+}
+
+bool32 entity_physics_backend_supported(EntityPhysicsBackend backend) {
+	physics_initialize();
+	return backend < ENTITY_PHYSICS_COUNT && (physics.supported_mask & (1u << backend));
+}
+
+bool32 entity_physics_select(EntityPhysicsBackend backend) {
+	physics_initialize();
+	if (entity_physics_backend_supported(backend) == false)
+		return false;
+
+	physics.backend = backend;
+	physics.integrate = backend_functions[backend];
+	return true;
+}
+
+const char *entity_physics_backend_name(EntityPhysicsBackend backend) {
+	return backend < ENTITY_PHYSICS_COUNT ? backend_names[backend] : "unknown";
+}
+
+static uint32_t check_next(uint32_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static float check_float(uint32_t *state, float low, float high) {
+	return low + (high - low) * ((float)(check_next(state) >> 8) / (float)(1u << 24));
+}
+
+bool32 entity_physics_self_check(void) {
+	static EntityBody reference[SELF_CHECK_BODIES], candidate[SELF_CHECK_BODIES];
+
+	const EntityMotion motions[] = {
+		{ .velocity_scale = 1.0f, .drag = 1.0f, .wrap = true, .wrap_margin = .5f, .bounds = { 1280, 720 } },
+		{ .velocity_scale = 1.0f / 60.0f, .drag = .95f, .wrap = true, .wrap_margin = 1.0f, .bounds = { 1280, 720 } },
+		{ .velocity_scale = 1.0f, .drag = 1.0f, .wrap = false },
+	};
+
+	uint32_t state = 0x9E3779B9u;
+	for (uint32_t index = 0; index < SELF_CHECK_BODIES; index++) {
+		Vector2 size = { check_float(&state, 1, 128), check_float(&state, 1, 128) };
+		reference[index] = (EntityBody){
+			.position = { check_float(&state, -300, 1580), check_float(&state, -300, 1020) },
+			.velocity = { check_float(&state, -900, 900), check_float(&state, -900, 900) },
+			.size = size,
+			.rotation = check_float(&state, 0, 360),
+			.collision_active = index & 1,
+			.collision_shape = { 0, 0, size.x * .8f, size.y * .8f },
+		};
+	}
+
+	// Land a few bodies exactly on the wrap edges, where a comparison mismatch would show
+	for (uint32_t index = 0; index < 8; index++) {
+		EntityBody *body = &reference[index];
+		body->velocity = (Vector2){ 0 };
+		body->position.x = index & 1 ? -body->size.x * .5f : 1280 + body->size.x * .5f;
+		body->position.y = index & 2 ? -body->size.y * .5f : 720 + body->size.y * .5f;
+	}
+
+	EntityPhysicsBackend selected = entity_physics_backend();
+	bool32 result = true;
+
+	for (uint32_t motion_index = 0; motion_index < countof(motions); motion_index++) {
+		static EntityBody expected[SELF_CHECK_BODIES];
+		memcpy(expected, reference, sizeof(reference));
+		integrate_scalar(expected, SELF_CHECK_BODIES, &motions[motion_index]);
+
+		for (uint32_t backend = ENTITY_PHYSICS_SCALAR + 1; backend < ENTITY_PHYSICS_COUNT; backend++) {
+			if (entity_physics_backend_supported(backend) == false)
+				continue;
+
+			memcpy(candidate, reference, sizeof(reference));
+			backend_functions[backend](candidate, SELF_CHECK_BODIES, &motions[motion_index]);
+
+			if (memcmp(candidate, expected, sizeof(expected)) != 0) {
+				LOG_ERROR("Physics: %s batch integration differs from scalar (motion %u)", backend_names[backend], motion_index);
+				result = false;
+			}
+		}
+	}
+
+	entity_physics_select(selected);
+	return result;
+}
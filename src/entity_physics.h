@@ -0,0 +1,36 @@
+#pragma once
+
+#include "common.h"
+#include "entity.h"
+
+// One pass over a body column: integrate, apply drag, wrap around the screen and
+// sync the collision rectangle. The same order the per-system loops used to run.
+typedef struct {
+	// 1 when velocity is per tick, dt when it is per second
+	float velocity_scale;
+	float drag;
+
+	// Bodies may leave the bounds by size * wrap_margin before wrapping to the other side
+	bool32 wrap;
+	float wrap_margin;
+	Vector2 bounds;
+} EntityMotion;
+
+typedef enum {
+	ENTITY_PHYSICS_SCALAR,
+	ENTITY_PHYSICS_SSE2,
+	ENTITY_PHYSICS_AVX2,
+
+	ENTITY_PHYSICS_COUNT
+} EntityPhysicsBackend;
+
+void entity_bodies_integrate(EntityBody *bodies, uint32_t count, const EntityMotion *motion);
+
+// Backend is picked from CPUID on first use, selecting one the CPU lacks returns false
+EntityPhysicsBackend entity_physics_backend(void);
+bool32 entity_physics_backend_supported(EntityPhysicsBackend backend);
+bool32 entity_physics_select(EntityPhysicsBackend backend);
+const char *entity_physics_backend_name(EntityPhysicsBackend backend);
+
+// Runs every supported backend over the same bodies and compares against scalar bit for bit
+bool32 entity_physics_self_check(void);
@@ -1,4 +1,5 @@
 #include "event.h"
+#include "core/atomic.h"
 #include "core/logger.h"
 
 // typedef struct {
@@ -13,23 +14,34 @@ typedef struct event_listener_list {
 } EventListenerList;
 
 static EventListenerList layers[MAX_EVENT_TYPES];
+// Serializes subscribers. Emitters take no lock: a listener is written before the
+// count that publishes it, so worlds on other threads only ever see complete entries
+static uint32_t layers_lock;
 
 bool32 event_system_startup(void) { return true; }
 bool32 event_system_shutdown(void) { return false; }
 
 bool32 event_subscribe(uint16_t type_enum, PFN_on_event on_event) {
-	if (type_enum == CORE_EVENT_NULL || type_enum > MAX_EVENT_TYPES) {
+	if (type_enum == CORE_EVENT_NULL || type_enum >= MAX_EVENT_TYPES) {
 		LOG_WARN("Event: type id[%d] outside valid range, ignoring subscribe request", type_enum);
 		return false;
 	}
-	if (layers[type_enum].count >= 16) {
+
+	while (atomic_exchange(&layers_lock, 1))
+		atomic_pause();
+
+	EventListenerList *listeners = &layers[type_enum];
+	uint32_t count = atomic_load_relaxed(&listeners->count);
+	if (count >= 16) {
+		atomic_store_release(&layers_lock, 0);
 		LOG_WARN("Event: type id[%d] storage full, ignoring subscribe request", type_enum);
 		return false;
 	}
 
-	EventListenerList *listeners = &layers[type_enum];
-	listeners->on_event[listeners->count++] = on_event;
+	listeners->on_event[count] = on_event;
+	atomic_store_release(&listeners->count, count + 1);
 
+	atomic_store_release(&layers_lock, 0);
 	return true;
 }
 bool32 event_unsubscribe(uint16_t event_type, PFN_on_event on_event) {
@@ -38,14 +50,15 @@ bool32 event_unsubscribe(uint16_t event_type, PFN_on_event on_event) {
 }
 
 bool32 event_emit(Event *event) {
-	if (event->header.type == CORE_EVENT_NULL || event->header.size >= MAX_EVENT_SIZE) {
+	if (event->header.type == CORE_EVENT_NULL || event->header.type >= MAX_EVENT_TYPES || event->header.size >= MAX_EVENT_SIZE) {
 		LOG_WARN("Event: type id[%d] outside valid range, ignoring emit request", event->header.type);
 		return false;
 	}
 
 	EventListenerList *listeners = &layers[event->header.type];
 
-	for (uint32_t index = 0; index < listeners->count; ++index) {
+	uint32_t count = atomic_load_acquire(&listeners->count);
+	for (uint32_t index = 0; index < count; ++index) {
 		listeners->on_event[index](event);
 	}
 
@@ -2,8 +2,11 @@
 
 #include "event.h"
 
+// time_ns is the clock_now_ns reading of the pump that first saw the change
+
 typedef struct {
 	EventCommon header;
+	uint64_t time_ns;
 
 	uint32_t key, mods;
 	bool32 leave;
@@ -11,6 +14,7 @@ typedef struct {
 
 typedef struct {
 	EventCommon header;
+	uint64_t time_ns;
 	double x, y;
 	double dx, dy;
 
@@ -19,6 +23,7 @@ typedef struct {
 
 typedef struct {
 	EventCommon header;
+	uint64_t time_ns;
 	uint32_t button;
 	double x, y;
 	uint32_t mods;
@@ -0,0 +1,228 @@
+#include "frame_bench.h"
+
+#include "autopilot.h"
+#include "core/clock.h"
+#include "core/logger.h"
+#include "entity.h"
+#include "world.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_BENCH_TICK_DT (1.0f / 60.0f)
+// Frames kept after the run ends so the win or lose screen shows up in the report
+#define FRAME_BENCH_END_FRAMES 120
+// Bucket 0 holds frames under 1 us, bucket i frames under 2^i us, the last one everything slower
+#define FRAME_BENCH_HISTOGRAM_BUCKETS 20
+
+static const char *backend_names[FRAME_BENCH_BACKEND_COUNT] = {
+	[FRAME_BENCH_NULL] = "null",
+	[FRAME_BENCH_RAYLIB] = "raylib",
+};
+
+static const char *phase_names[GAME_PHASE_COUNT + 1] = {
+	[GAME_PHASE_MENU] = "menu",
+	[GAME_PHASE_ASTEROIDS] = "asteroids",
+	[GAME_PHASE_BOSS] = "boss",
+	[GAME_PHASE_WIN] = "win",
+	[GAME_PHASE_LOSE] = "lose",
+	[GAME_PHASE_COUNT] = "all",
+};
+
+typedef struct {
+	uint32_t frame_ns, update_ns, draw_ns;
+	// Frame arena bytes in use before the reset, everything transient the frame allocated
+	uint32_t arena_bytes;
+	uint32_t entity_draws;
+	// Phase the frame started in
+	uint32_t phase;
+} FrameSample;
+
+typedef struct {
+	double p50, p95, p99, max, mean;
+} FrameStats;
+
+static int compare_u32(const void *a, const void *b) {
+	uint32_t left = *(const uint32_t *)a, right = *(const uint32_t *)b;
+	return (left > right) - (left < right);
+}
+
+// Copies one field of every frame in `phase` into `values`, GAME_PHASE_COUNT takes all of them
+static uint32_t samples_gather(const FrameSample *samples, uint32_t count, uint32_t phase, usize field, uint32_t *values) {
+	uint32_t gathered = 0;
+	for (uint32_t index = 0; index < count; index++)
+		if (phase == GAME_PHASE_COUNT || samples[index].phase == phase)
+			values[gathered++] = *(const uint32_t *)((const uint8_t *)&samples[index] + field);
+	return gathered;
+}
+
+// Nearest rank percentiles, sorts `values` in place
+static FrameStats stats_compute(uint32_t *values, uint32_t count, double scale) {
+	if (count == 0)
+		return (FrameStats){ 0 };
+
+	qsort(values, count, sizeof(*values), compare_u32);
+	double total = 0;
+	for (uint32_t index = 0; index < count; index++)
+		total += values[index];
+
+	return (FrameStats){
+		.p50 = values[(count * 50 + 99) / 100 - 1] * scale,
+		.p95 = values[(count * 95 + 99) / 100 - 1] * scale,
+		.p99 = values[(count * 99 + 99) / 100 - 1] * scale,
+		.max = values[count - 1] * scale,
+		.mean = total / count * scale,
+	};
+}
+
+static void stats_write(FILE *out, const char *name, FrameStats stats, bool32 last) {
+	fprintf(out, "      \"%s\": { \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f, \"mean\": %.3f }%s\n", name, stats.p50,
+		stats.p95, stats.p99, stats.max, stats.mean, last ? "" : ",");
+}
+
+static void phase_write(FILE *out, const FrameSample *samples, uint32_t count, uint32_t phase, uint32_t *values, bool32 last) {
+	uint32_t frames = samples_gather(samples, count, phase, offsetof(FrameSample, frame_ns), values);
+
+	uint32_t histogram[FRAME_BENCH_HISTOGRAM_BUCKETS] = { 0 };
+	for (uint32_t index = 0; index < frames; index++) {
+		uint32_t bucket = 0;
+		for (uint32_t us = values[index] / 1000; us && bucket < FRAME_BENCH_HISTOGRAM_BUCKETS - 1; us >>= 1)
+			bucket++;
+		histogram[bucket]++;
+	}
+
+	fprintf(out, "    {\n");
+	fprintf(out, "      \"phase\": \"%s\",\n", phase_names[phase]);
+	fprintf(out, "      \"frames\": %u,\n", frames);
+
+	stats_write(out, "frame_us", stats_compute(values, frames, 1e-3), false);
+	samples_gather(samples, count, phase, offsetof(FrameSample, update_ns), values);
+	stats_write(out, "update_us", stats_compute(values, frames, 1e-3), false);
+	samples_gather(samples, count, phase, offsetof(FrameSample, draw_ns), values);
+	stats_write(out, "draw_us", stats_compute(values, frames, 1e-3), false);
+	samples_gather(samples, count, phase, offsetof(FrameSample, arena_bytes), values);
+	stats_write(out, "frame_arena_bytes", stats_compute(values, frames, 1.0), false);
+	samples_gather(samples, count, phase, offsetof(FrameSample, entity_draws), values);
+	stats_write(out, "entity_draws", stats_compute(values, frames, 1.0), false);
+
+	fprintf(out, "      \"histogram_us\": { \"upper_bounds\": [");
+	for (uint32_t bucket = 0; bucket < FRAME_BENCH_HISTOGRAM_BUCKETS - 1; bucket++)
+		fprintf(out, "%s%u", bucket ? ", " : "", 1u << bucket);
+	fprintf(out, ", null], \"counts\": [");
+	for (uint32_t bucket = 0; bucket < FRAME_BENCH_HISTOGRAM_BUCKETS; bucket++)
+		fprintf(out, "%s%u", bucket ? ", " : "", histogram[bucket]);
+	fprintf(out, "] }\n");
+
+	fprintf(out, "    }%s\n", last ? "" : ",");
+}
+
+bool32 frame_bench_run(const FrameBenchConfig *config, Texture *atlas, Shader *white) {
+	FrameSample *samples = malloc(config->max_ticks * sizeof(*samples));
+	uint32_t *values = malloc(config->max_ticks * sizeof(*values));
+	FILE *out = fopen(config->out_path, "wb");
+	if (samples == NULL || values == NULL || out == NULL) {
+		LOG_ERROR("FrameBench: could not set up %u frames or open %s", config->max_ticks, config->out_path);
+		free(samples);
+		free(values);
+		if (out)
+			fclose(out);
+		return false;
+	}
+
+	Replay replay = { 0 };
+	uint64_t seed = config->seed;
+	if (config->replay) {
+		replay = *config->replay;
+		replay_rewind(&replay);
+		seed = replay.seed;
+	}
+
+	GameWorld world;
+	world_init(&world, atlas, white, seed);
+	Autopilot pilot;
+	autopilot_init(&pilot, config->aggression);
+
+	bool32 draw = config->backend == FRAME_BENCH_RAYLIB;
+	uint32_t count = 0, end_frames = FRAME_BENCH_END_FRAMES;
+	entity_draw_count_take();
+
+	while (count < config->max_ticks && world.running && end_frames > 0) {
+		ReplayTick tick = { .dt = FRAME_BENCH_TICK_DT };
+		if (config->replay) {
+			if (replay_next(&replay, &tick) == false)
+				break;
+		} else
+			tick.input = autopilot_next(&pilot, &world, 0);
+
+		StateID phase = world.state_machine.current;
+		uint64_t start = clock_now_ns();
+		world_update(&world, &tick.input, tick.dt);
+		uint64_t updated = clock_now_ns();
+		if (draw) {
+			BeginDrawing();
+			ClearBackground(BLACK);
+			world_draw(&world);
+			EndDrawing();
+		}
+		uint64_t drawn = clock_now_ns();
+
+		samples[count++] = (FrameSample){
+			.frame_ns = (uint32_t)(drawn - start),
+			.update_ns = (uint32_t)(updated - start),
+			.draw_ns = (uint32_t)(drawn - updated),
+			.arena_bytes = (uint32_t)frame_arenas_current(&world.frames)->offset,
+			.entity_draws = entity_draw_count_take(),
+			.phase = phase < GAME_PHASE_COUNT ? phase : GAME_PHASE_MENU,
+		};
+		frame_arenas_swap(&world.frames);
+
+		StateID current = world.state_machine.current;
+		if (current == GAME_PHASE_WIN || current == GAME_PHASE_LOSE)
+			end_frames--;
+		if (draw && WindowShouldClose())
+			break;
+	}
+
+	const char *result = world.state_machine.current == GAME_PHASE_WIN ? "win" : world.state_machine.current == GAME_PHASE_LOSE ? "lose" : "timeout";
+
+	fprintf(out, "{\n");
+	fprintf(out, "  \"backend\": \"%s\",\n", frame_bench_backend_name(config->backend));
+	fprintf(out, "  \"seed\": %llu,\n", (unsigned long long)seed);
+	fprintf(out, "  \"session\": \"%s\",\n", config->replay ? "replay" : "autopilot");
+	fprintf(out, "  \"frames\": %u,\n", count);
+	fprintf(out, "  \"result\": \"%s\",\n", result);
+	fprintf(out, "  \"score\": %u,\n", world.score);
+	fprintf(out, "  \"phases\": [\n");
+	for (uint32_t phase = 0; phase <= GAME_PHASE_COUNT; phase++) {
+		if (phase < GAME_PHASE_COUNT && samples_gather(samples, count, phase, offsetof(FrameSample, frame_ns), values) == 0)
+			continue;
+		phase_write(out, samples, count, phase, values, phase == GAME_PHASE_COUNT);
+	}
+	fprintf(out, "  ]\n}\n");
+	fclose(out);
+
+	uint32_t all = samples_gather(samples, count, GAME_PHASE_COUNT, offsetof(FrameSample, frame_ns), values);
+	FrameStats stats = stats_compute(values, all, 1e-3);
+	LOG_INFO("FrameBench: %u frames on %s ending in %s, p50 %.1f us, p99 %.1f us, max %.1f us, written to %s", count,
+		frame_bench_backend_name(config->backend), result, stats.p50, stats.p99, stats.max, config->out_path);
+
+	world_destroy(&world);
+	free(values);
+	free(samples);
+	return true;
+}
+
+const char *frame_bench_backend_name(FrameBenchBackend backend) {
+	return backend < FRAME_BENCH_BACKEND_COUNT ? backend_names[backend] : "unknown";
+}
+
+bool32 frame_bench_backend_parse(const char *name, FrameBenchBackend *backend) {
+	for (uint32_t index = 0; index < FRAME_BENCH_BACKEND_COUNT; index++) {
+		if (strcmp(name, backend_names[index]) == 0) {
+			*backend = index;
+			return true;
+		}
+	}
+	return false;
+}
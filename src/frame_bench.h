@@ -0,0 +1,36 @@
+#pragma once
+
+#include "common.h"
+#include "replay.h"
+
+#include <raylib.h>
+
+typedef enum {
+	// world_update alone, no window or GPU needed
+	FRAME_BENCH_NULL,
+	// world_update plus world_draw into a hidden window, the caller opens it
+	FRAME_BENCH_RAYLIB,
+
+	FRAME_BENCH_BACKEND_COUNT
+} FrameBenchBackend;
+
+// Plays one fixed session through the real update and draw path and writes
+// per-phase frame time percentiles, a histogram, frame arena use and entity
+// draws as JSON, so two builds can be diffed.
+typedef struct {
+	FrameBenchBackend backend;
+	uint64_t seed;
+	uint32_t max_ticks;
+
+	// The session follows the replay when set, otherwise the autopilot from `seed`
+	const Replay *replay;
+	float aggression;
+
+	const char *out_path;
+} FrameBenchConfig;
+
+// Atlas and shader are only used by the raylib backend and may be NULL for null
+bool32 frame_bench_run(const FrameBenchConfig *config, Texture *atlas, Shader *white);
+
+const char *frame_bench_backend_name(FrameBenchBackend backend);
+bool32 frame_bench_backend_parse(const char *name, FrameBenchBackend *backend);
@@ -8,7 +8,7 @@ bool32 fsm_create(FSM *fsm, StateID initial_state, void *context) {
 	ASSERT(initial_state < MAX_STATES);
 
 	fsm->context = context;
-	fsm->current = &fsm->states[initial_state];
+	fsm->current = initial_state;
 
 	return true;
 }
@@ -25,7 +25,7 @@ bool32 fsm_state_add(FSM *fsm, StateID id, StateHandler *handler) {
 
 bool32 fsm_state_remove(FSM *fsm, StateID id) {
 	ASSERT(id < MAX_STATES);
-	ASSERT(id != fsm->current->id);
+	ASSERT(id != fsm->current);
 
 	fsm->states[id]
 		.id = INVALID_INDEX;
@@ -36,17 +36,17 @@ bool32 fsm_state_remove(FSM *fsm, StateID id) {
 
 bool32 fsm_state_set(FSM *fsm, StateID id) {
 	ASSERT(id < MAX_STATES);
-	fsm->current = &fsm->states[id];
+	fsm->current = id;
 
-	if (fsm->current->handler.on_enter)
-		fsm->current->handler.on_enter(fsm->context);
+	if (fsm->states[id].handler.on_enter)
+		fsm->states[id].handler.on_enter(fsm->context);
 
 	return true;
 }
 
 StateID fsm_state_get(FSM *fsm) {
-    ASSERT(fsm->current);
-	return fsm->current->id;
+	ASSERT(fsm->current < MAX_STATES);
+	return fsm->current;
 }
 
 void fsm_context_set(FSM *fsm, void *context) {
@@ -54,13 +54,13 @@ void fsm_context_set(FSM *fsm, void *context) {
 }
 
 bool32 fsm_update(FSM *fsm, float dt) {
-	ASSERT(fsm->current);
-	StateHandler *current = &fsm->current->handler;
+	ASSERT(fsm->current < MAX_STATES);
+	StateHandler *current = &fsm->states[fsm->current].handler;
 	ASSERT(current->on_update);
 
 	StateID next_id = current->on_update(fsm->context, dt);
 
-	if (next_id < MAX_STATES && next_id != fsm->current->id) {
+	if (next_id < MAX_STATES && next_id != fsm->current) {
 		StateHandler *next = &fsm->states[next_id].handler;
 
 		if (current->on_exit)
@@ -68,7 +68,7 @@ bool32 fsm_update(FSM *fsm, float dt) {
 		if (next->on_enter)
 			next->on_enter(fsm->context);
 
-		fsm->current = &fsm->states[next_id];
+		fsm->current = next_id;
 
 		return true;
 	}
@@ -18,9 +18,10 @@ typedef struct {
 	StateHandler handler;
 } State;
 
+// Current state is kept as an id rather than a pointer so the machine can be copied by value
 typedef struct {
 	State states[MAX_STATES];
-	State *current;
+	StateID current;
 
 	void *context;
 } FSM;
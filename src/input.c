@@ -0,0 +1,208 @@
+#include "input.h"
+
+#include "core/clock.h"
+#include "event.h"
+#include "events/platform_events.h"
+
+#include <raylib.h>
+#include <stdlib.h>
+
+STATIC_ASSERT(INPUT_BUTTON_COUNT <= 16);
+
+#define INPUT_LATENCY_SAMPLES 256
+
+// What the late latch draws, other changes only show once a tick has run on them
+#define INPUT_POSE_BUTTONS ((1u << INPUT_THRUST) | (1u << INPUT_TURN_LEFT) | (1u << INPUT_TURN_RIGHT))
+
+static const int input_keys[INPUT_BUTTON_COUNT] = {
+	[INPUT_THRUST] = KEY_W,
+	[INPUT_TURN_LEFT] = KEY_A,
+	[INPUT_TURN_RIGHT] = KEY_D,
+	[INPUT_FIRE] = KEY_SPACE,
+	[INPUT_CONFIRM] = KEY_ENTER,
+	[INPUT_BACK] = KEY_ESCAPE,
+	[INPUT_TOGGLE_UI] = KEY_TAB,
+	[INPUT_TOGGLE_DEBUG] = KEY_C,
+	[INPUT_TOGGLE_COLLISIONS] = KEY_N,
+};
+
+static const int input_mouse_buttons[] = { MOUSE_BUTTON_LEFT, MOUSE_BUTTON_RIGHT, MOUSE_BUTTON_MIDDLE };
+
+// Input is only read on the main thread
+static struct {
+	bool32 initialized;
+
+	// What the pump last reported, changes against it become events
+	uint16_t keys_down;
+	uint8_t mouse_down;
+	Vector2 mouse;
+	// When raylib last read the platform, the time every change the pump finds is stamped with
+	uint64_t polled_ns;
+
+	// Built from the events, `pressed` collects until the next poll
+	uint16_t down, pressed;
+
+	// Per button the oldest change not yet handed over, and the oldest handed over but not yet on screen
+	uint64_t pending_ns[INPUT_BUTTON_COUNT];
+	uint64_t shown_ns;
+
+	uint32_t latency_ns[INPUT_LATENCY_SAMPLES];
+	uint32_t latency_head, latency_count;
+} input;
+
+static int input_button_of(uint32_t key) {
+	for (uint32_t button = 0; button < INPUT_BUTTON_COUNT; button++)
+		if (input_keys[button] == (int)key)
+			return (int)button;
+	return -1;
+}
+
+static bool32 input_on_key(Event *event) {
+	KeyEvent *key = (KeyEvent *)event;
+	int button = input_button_of(key->key);
+	if (button < 0)
+		return false;
+
+	uint16_t bit = (uint16_t)(1u << button);
+	if (key->header.type == CORE_EVENT_KEY_PRESSED) {
+		input.down |= bit;
+		input.pressed |= bit;
+	} else
+		input.down &= (uint16_t)~bit;
+
+	if (input.pending_ns[button] == 0)
+		input.pending_ns[button] = key->time_ns;
+	return true;
+}
+
+void input_init(void) {
+	if (input.initialized)
+		return;
+
+	event_subscribe(CORE_EVENT_KEY_PRESSED, input_on_key);
+	event_subscribe(CORE_EVENT_KEY_RELEASED, input_on_key);
+	input.initialized = true;
+}
+
+void input_pump(void) {
+	uint64_t now = input.polled_ns ? input.polled_ns : clock_now_ns();
+
+	for (uint32_t button = 0; button < INPUT_BUTTON_COUNT; button++) {
+		uint16_t bit = (uint16_t)(1u << button);
+		bool32 down = IsKeyDown(input_keys[button]);
+		if (down == ((input.keys_down & bit) != 0))
+			continue;
+
+		input.keys_down ^= bit;
+		KeyEvent event = { .header = { .type = down ? CORE_EVENT_KEY_PRESSED : CORE_EVENT_KEY_RELEASED, .size = sizeof(KeyEvent) } };
+		event.time_ns = now;
+		event.key = (uint32_t)input_keys[button];
+		event_emit((Event *)&event);
+	}
+
+	Vector2 mouse = GetMousePosition();
+	if (mouse.x != input.mouse.x || mouse.y != input.mouse.y) {
+		MouseMotionEvent event = { .header = { .type = CORE_EVENT_MOUSE_MOTION, .size = sizeof(MouseMotionEvent) } };
+		event.time_ns = now;
+		event.x = mouse.x;
+		event.y = mouse.y;
+		event.dx = mouse.x - input.mouse.x;
+		event.dy = mouse.y - input.mouse.y;
+		input.mouse = mouse;
+		event_emit((Event *)&event);
+	}
+
+	for (uint32_t index = 0; index < countof(input_mouse_buttons); index++) {
+		uint8_t bit = (uint8_t)(1u << index);
+		bool32 down = IsMouseButtonDown(input_mouse_buttons[index]);
+		if (down == ((input.mouse_down & bit) != 0))
+			continue;
+
+		input.mouse_down ^= bit;
+		MouseButtonEvent event = {
+			.header = { .type = down ? CORE_EVENT_MOUSE_BUTTON_PRESSED : CORE_EVENT_MOUSE_BUTTON_RELEASED, .size = sizeof(MouseButtonEvent) }
+		};
+		event.time_ns = now;
+		event.button = (uint32_t)input_mouse_buttons[index];
+		event.x = mouse.x;
+		event.y = mouse.y;
+		event_emit((Event *)&event);
+	}
+}
+
+void input_platform_polled(void) {
+	input.polled_ns = clock_now_ns();
+	input_pump();
+}
+
+void input_platform_poll(void) {
+	PollInputEvents();
+	input_platform_polled();
+}
+
+// Changes to these buttons handed over so far will be on the next present
+static void input_mark_shown(uint32_t buttons) {
+	for (uint32_t button = 0; button < INPUT_BUTTON_COUNT; button++) {
+		uint64_t pending = input.pending_ns[button];
+		if (((buttons >> button) & 1u) == 0 || pending == 0)
+			continue;
+		if (input.shown_ns == 0 || pending < input.shown_ns)
+			input.shown_ns = pending;
+		input.pending_ns[button] = 0;
+	}
+}
+
+InputState input_poll(void) {
+	input_init();
+	input_pump();
+
+	InputState state = { .down = input.down, .pressed = input.pressed };
+	input.pressed = 0;
+	input_mark_shown(UINT32_MAX);
+	return state;
+}
+
+InputState input_latch_late(void) {
+	// The last poll was before the tick ran, this picks up whatever arrived while it was simulated
+	input_platform_poll();
+
+	// Only the ship's pose is drawn from this, a fire or confirm waits for the tick that reads it
+	input_mark_shown(INPUT_POSE_BUTTONS);
+	return (InputState){ .down = input.down };
+}
+
+void input_present(uint64_t present_ns) {
+	if (input.shown_ns == 0)
+		return;
+
+	uint64_t latency = present_ns > input.shown_ns ? present_ns - input.shown_ns : 0;
+	input.latency_ns[input.latency_head] = (uint32_t)min(latency, (uint64_t)UINT32_MAX);
+	input.latency_head = (input.latency_head + 1) % INPUT_LATENCY_SAMPLES;
+	input.latency_count = min(input.latency_count + 1, (uint32_t)INPUT_LATENCY_SAMPLES);
+	input.shown_ns = 0;
+}
+
+static int compare_u32(const void *a, const void *b) {
+	uint32_t left = *(const uint32_t *)a, right = *(const uint32_t *)b;
+	return (left > right) - (left < right);
+}
+
+InputLatencyStats input_latency_stats(void) {
+	InputLatencyStats stats = { .count = input.latency_count };
+	if (input.latency_count == 0)
+		return stats;
+
+	uint32_t sorted[INPUT_LATENCY_SAMPLES];
+	double total = 0;
+	for (uint32_t index = 0; index < input.latency_count; index++) {
+		sorted[index] = input.latency_ns[index];
+		total += sorted[index];
+	}
+	qsort(sorted, input.latency_count, sizeof(*sorted), compare_u32);
+
+	stats.min_ms = sorted[0] / 1e6f;
+	stats.max_ms = sorted[input.latency_count - 1] / 1e6f;
+	stats.p99_ms = sorted[(input.latency_count * 99 + 99) / 100 - 1] / 1e6f;
+	stats.average_ms = (float)(total / input.latency_count / 1e6);
+	return stats;
+}
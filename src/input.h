@@ -0,0 +1,61 @@
+#pragma once
+
+#include "common.h"
+
+// Every key the simulation reads. The world is handed one InputState per tick
+// instead of polling the keyboard, so a recording can stand in for the player.
+typedef enum {
+	INPUT_THRUST,
+	INPUT_TURN_LEFT,
+	INPUT_TURN_RIGHT,
+	INPUT_FIRE,
+	INPUT_CONFIRM,
+	INPUT_BACK,
+	INPUT_TOGGLE_UI,
+	INPUT_TOGGLE_DEBUG,
+	INPUT_TOGGLE_COLLISIONS,
+
+	INPUT_BUTTON_COUNT
+} InputButton;
+
+typedef struct {
+	// One bit per InputButton, `pressed` is only set on the tick the key went down
+	uint16_t down;
+	uint16_t pressed;
+} InputState;
+
+// Input-to-present latency over the last frames that showed a key change
+typedef struct {
+	uint32_t count;
+	float min_ms, average_ms, p99_ms, max_ms;
+} InputLatencyStats;
+
+// Subscribes the latch to the key events input_pump emits, call once before polling
+void input_init(void);
+
+// Turns raylib's key and mouse state into platform_events.h events stamped with the
+// time raylib last polled the platform. Call as often as is useful, every change is emitted once.
+void input_pump(void);
+// Call right after anything that polled the platform, EndDrawing included, so what it
+// captured is stamped with that moment and not with when a pump first looked
+void input_platform_polled(void);
+// Polls the platform, then input_platform_polled
+void input_platform_poll(void);
+
+// Pumps and hands over everything latched since the last poll, call once per tick
+InputState input_poll(void);
+// Polls the platform again right before render and returns what is held now, `pressed`
+// stays latched for the next tick. For presentation only, the simulation keeps the tick's input.
+InputState input_latch_late(void);
+
+// Call once the frame is on screen, closes the latency samples of every change it showed
+void input_present(uint64_t present_ns);
+InputLatencyStats input_latency_stats(void);
+
+static inline bool32 input_down(const InputState *input, InputButton button) {
+	return (input->down >> button) & 1u;
+}
+
+static inline bool32 input_pressed(const InputState *input, InputButton button) {
+	return (input->pressed >> button) & 1u;
+}
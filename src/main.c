@@ -1,5 +1,25 @@
 #include "audio_manager.h"
+#include "autopilot.h"
+#include "core/alloc_tracker.h"
+#include "core/clock.h"
+#include "core/debug.h"
+#include "core/frame_pacer.h"
+#include "core/logger.h"
+#include "core/profiler.h"
+#include "entity_physics.h"
+#include "frame_bench.h"
+#include "perf_hud.h"
+#include "replay.h"
+#include "rollback.h"
 #include "world.h"
+#include "world_batch.h"
+#include "world_hash.h"
+#include "world_snapshot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 typedef struct {
 	Arena frame_arena;
@@ -14,6 +34,14 @@ typedef struct {
 
 typedef Rectangle TextureArea;
 
+// A few seconds of history, stepped through with backspace while the debug view is on
+static WorldRewind rewind_ring;
+
+// Co-op peers, the test runs both ends in this process
+static GameWorld coop_worlds[2];
+static RollbackSession coop_sessions[2];
+static NetWire coop_wire;
+
 #ifdef PLATFORM_WEB
 const char *FLASH_SHADER_CODE =
 	"precision mediump float;\n"
@@ -41,35 +69,478 @@ const char *FLASH_SHADER_CODE =
 	"}\n";
 #endif
 
-int main(void) {
+// Ticks that may still allocate, everything after must run off the arenas alone
+#define ALLOC_WARMUP_TICKS 1
+// Co-op catches up at most this many fixed ticks per frame after a slow one
+#define COOP_MAX_TICKS_PER_FRAME 4
+
+// Logs what the allocation tracker saw, returns false when a steady frame allocated
+static bool32 alloc_report(void) {
+	if (ALLOC_TRACKER_AVAILABLE == false)
+		return true;
+
+	AllocTrackerStats stats = alloc_tracker_stats();
+	LOG_INFO("Alloc: %llu frames, at most %u allocations in one, %llu in steady frames", (unsigned long long)stats.frames,
+		stats.frame_max, (unsigned long long)stats.violations);
+
+	AllocZoneCount zones[ALLOC_TRACKER_MAX_ZONES];
+	uint32_t zone_count = alloc_tracker_zones(zones, countof(zones));
+	for (uint32_t index = 0; index < zone_count; index++)
+		LOG_INFO("Alloc:   %s %llu, %llu steady", zones[index].zone, (unsigned long long)zones[index].allocations,
+			(unsigned long long)zones[index].violations);
+	return stats.violations == 0;
+}
+
+// Simulates every recorded tick without a window, audio or textures. With the
+// allocation tracker built in, a tick past warmup that allocates fails the run
+static int run_headless(Replay *replay, WorldHashStream *hashes) {
+	GameWorld world = { 0 };
+	world_init(&world, NULL, NULL, replay->seed);
+	// Names the zone an allocation came from
+	profiler_enable(ALLOC_TRACKER_AVAILABLE);
+
+	uint64_t start = clock_now_ns();
+	ReplayTick tick;
+	while (world.running && replay_next(replay, &tick)) {
+		profiler_frame_begin();
+		alloc_tracker_frame_begin();
+		alloc_tracker_set_steady(replay->tick_index > ALLOC_WARMUP_TICKS);
+		world_update(&world, &tick.input, tick.dt);
+		frame_arenas_swap(&world.frames);
+		alloc_tracker_frame_end();
+		profiler_frame_end();
+
+		if (hashes->file) {
+			WorldHash hash;
+			world_hash_compute(&world, &hash);
+			if (world_hash_stream_tick(hashes, &hash) == false)
+				break;
+		}
+	}
+	uint64_t elapsed = clock_now_ns() - start;
+
+	LOG_INFO("Replay: simulated %u/%u ticks in %.3f ms, %.2f us/tick, final score %u", replay->tick_index, replay->tick_count,
+		elapsed / 1e6, replay->tick_index ? elapsed / 1e3 / replay->tick_index : 0.0, world.score);
+	bool32 allocation_free = alloc_report();
+
+	world_destroy(&world);
+	return replay->tick_index == replay->tick_count && hashes->diverged == false && allocation_free ? 0 : 1;
+}
+
+static InputState input_mirrored(InputState input) {
+	uint16_t turns = (1u << INPUT_TURN_LEFT) | (1u << INPUT_TURN_RIGHT);
+	uint16_t down = input.down & turns;
+	input.down = (input.down & ~turns) | (uint16_t)(down == turns || down == 0 ? down : down ^ turns);
+	return input;
+}
+
+// Two rollback peers over a simulated link on virtual time. Player 0 plays the
+// replay and player 1 plays it mirrored, then both must settle on the same state.
+static int run_coop_test(Replay *replay, NetConditions conditions) {
+	NetLink links[2];
+	net_link_open_simulated(&links[0], &links[1], &coop_wire, conditions, replay->seed);
+
+	for (uint32_t peer = 0; peer < 2; peer++) {
+		world_init(&coop_worlds[peer], NULL, NULL, replay->seed);
+		world_set_player_count(&coop_worlds[peer], 2);
+		rollback_session_init(&coop_sessions[peer], &coop_worlds[peer], &links[peer], peer, 0);
+	}
+
+	uint64_t frame = 0;
+	ReplayTick tick;
+	while (replay_next(replay, &tick)) {
+		uint64_t now_ns = frame++ * 1000000000ull / 60;
+		rollback_advance(&coop_sessions[0], tick.input, now_ns);
+		rollback_advance(&coop_sessions[1], input_mirrored(tick.input), now_ns);
+		// One swap per frame however many ticks the sessions ran, as the windowed loop does
+		frame_arenas_swap(&coop_worlds[0].frames);
+		frame_arenas_swap(&coop_worlds[1].frames);
+	}
+
+	// Stop both at the same tick and let the last inputs arrive
+	uint32_t target = max(coop_sessions[0].tick, coop_sessions[1].tick);
+	for (uint32_t attempt = 0; attempt < 100000; attempt++) {
+		if (coop_sessions[0].tick == target && coop_sessions[1].tick == target &&
+			rollback_settled(&coop_sessions[0]) && rollback_settled(&coop_sessions[1]))
+			break;
+
+		uint64_t now_ns = frame++ * 1000000000ull / 60;
+		for (uint32_t peer = 0; peer < 2; peer++) {
+			if (coop_sessions[peer].tick < target)
+				rollback_advance(&coop_sessions[peer], (InputState){ 0 }, now_ns);
+			else
+				rollback_poll(&coop_sessions[peer], now_ns);
+			frame_arenas_swap(&coop_worlds[peer].frames);
+		}
+	}
+
+	WorldHash hashes[2];
+	for (uint32_t peer = 0; peer < 2; peer++) {
+		RollbackStats *stats = &coop_sessions[peer].stats;
+		LOG_INFO("Coop: peer %u at tick %u, %u rollbacks (%.2f ticks avg, %u deepest), %.2f us per rollback, worst frame %.2f us, %u stalls, %u/%u packets dropped",
+			peer, coop_sessions[peer].tick, stats->rollbacks, stats->rollbacks ? (double)stats->resimulated_ticks / stats->rollbacks : 0.0,
+			stats->deepest_rollback, stats->rollbacks ? stats->resimulation_ns / 1e3 / stats->rollbacks : 0.0,
+			stats->worst_frame_resimulation_ns / 1e3, stats->stalls, links[peer].dropped, links[peer].sent);
+
+		world_hash_compute(&coop_worlds[peer], &hashes[peer]);
+		world_destroy(&coop_worlds[peer]);
+	}
+
+	bool32 match = coop_sessions[0].tick == coop_sessions[1].tick && memcmp(&hashes[0], &hashes[1], sizeof(hashes[0])) == 0;
+	if (match)
+		LOG_INFO("Coop: peers agree at tick %u, score %u", coop_sessions[0].tick, coop_worlds[0].score);
+	else
+		LOG_ERROR("Coop: peers diverged (%016llx vs %016llx)", (unsigned long long)world_hash_combined(&hashes[0]),
+			(unsigned long long)world_hash_combined(&hashes[1]));
+
+	return match ? 0 : 1;
+}
+
+// Draws the world and, with debug on, the perf HUD. Closes the profiler frame before
+// EndDrawing so the frame time is the work done and not the wait for the next frame
+static void frame_present(GameWorld *world, FramePacer *pacer) {
+	uint32_t zone = profiler_zone_begin("draw");
+	BeginDrawing();
+	world_draw(world);
+	profiler_zone_end(zone);
+
+	if (world->show_debug) {
+		zone = profiler_zone_begin("perf_hud");
+		perf_hud_draw(frame_arenas_current(&world->frames), WINDOW_WIDTH - 270.0f, 10.0f);
+		profiler_zone_end(zone);
+	}
+
+	profiler_frame_end();
+	alloc_tracker_frame_end();
+	frame_pacer_submit(pacer);
+	EndDrawing();
+	input_platform_polled();
+	frame_pacer_wait(pacer);
+	input_present(pacer->present_ns);
+	// EndDrawing polled before the wait, the next frame starts from what is held now
+	input_platform_poll();
+}
+
+int main(int argc, char **argv) {
+	const char *record_path = NULL, *replay_path = NULL;
+	const char *hash_out_path = NULL, *hash_check_path = NULL;
+	bool32 headless = false;
+
+	bool32 coop = false, coop_test = false;
+	uint32_t coop_player = 0;
+	uint16_t coop_port = 0, coop_peer_port = 0;
+	const char *coop_peer = NULL;
+	NetConditions conditions = { 0 };
+
+	bool32 batch = false;
+	WorldBatchConfig batch_config = { 0 };
+
+	bool32 autopilot = false;
+	float aggression = .5f;
+
+	// Frames over this log their zone breakdown, 0 turns the hitch log off
+	float hitch_ms = 2000.0f / 60.0f;
+	FramePacingMode pacing = FRAME_PACING_SLEEP_SPIN;
+
+	bool32 frame_bench = false;
+	FrameBenchConfig frame_bench_config = { 0 };
+
+	for (int arg = 1; arg < argc; arg++) {
+		if (strcmp(argv[arg], "--record") == 0 && arg + 1 < argc)
+			record_path = argv[++arg];
+		else if (strcmp(argv[arg], "--replay") == 0 && arg + 1 < argc)
+			replay_path = argv[++arg];
+		else if (strcmp(argv[arg], "--hash-out") == 0 && arg + 1 < argc)
+			hash_out_path = argv[++arg];
+		else if (strcmp(argv[arg], "--hash-check") == 0 && arg + 1 < argc)
+			hash_check_path = argv[++arg];
+		else if (strcmp(argv[arg], "--headless") == 0)
+			headless = true;
+		else if (strcmp(argv[arg], "--coop") == 0 && arg + 4 < argc) {
+			coop = true;
+			coop_player = (uint32_t)strtoul(argv[++arg], NULL, 10) & 1;
+			coop_port = (uint16_t)strtoul(argv[++arg], NULL, 10);
+			coop_peer = argv[++arg];
+			coop_peer_port = (uint16_t)strtoul(argv[++arg], NULL, 10);
+		} else if (strcmp(argv[arg], "--coop-test") == 0 && arg + 2 < argc) {
+			coop_test = true;
+			conditions.latency_ms = (uint32_t)strtoul(argv[++arg], NULL, 10);
+			conditions.loss_percent = (uint32_t)strtoul(argv[++arg], NULL, 10);
+			conditions.jitter_ms = conditions.latency_ms / 4;
+		} else if (strcmp(argv[arg], "--batch") == 0 && arg + 2 < argc) {
+			batch = true;
+			batch_config.world_count = (uint32_t)strtoul(argv[++arg], NULL, 10);
+			batch_config.max_ticks = (uint32_t)strtoul(argv[++arg], NULL, 10);
+		} else if (strcmp(argv[arg], "--threads") == 0 && arg + 1 < argc)
+			batch_config.thread_count = (uint32_t)strtoul(argv[++arg], NULL, 10);
+		else if (strcmp(argv[arg], "--autopilot") == 0 && arg + 1 < argc) {
+			autopilot = true;
+			aggression = strtof(argv[++arg], NULL);
+		} else if (strcmp(argv[arg], "--frame-bench") == 0 && arg + 2 < argc) {
+			frame_bench = true;
+			frame_bench_config.out_path = argv[++arg];
+			frame_bench_config.max_ticks = (uint32_t)strtoul(argv[++arg], NULL, 10);
+		} else if (strcmp(argv[arg], "--frame-backend") == 0 && arg + 1 < argc && frame_bench_backend_parse(argv[arg + 1], &frame_bench_config.backend))
+			arg++;
+		else if (strcmp(argv[arg], "--hitch-ms") == 0 && arg + 1 < argc)
+			hitch_ms = strtof(argv[++arg], NULL);
+		else if (strcmp(argv[arg], "--pacing") == 0 && arg + 1 < argc && frame_pacing_mode_parse(argv[arg + 1], &pacing))
+			arg++;
+		else if (strcmp(argv[arg], "--alloc-fatal") == 0)
+			alloc_tracker_set_fatal(true);
+		else {
+			fprintf(stderr,
+				"usage: %s [--record file | --replay file [--headless]] [--hash-out file | --hash-check file]\n"
+				"          [--coop player local_port peer_ip peer_port] [--replay file --coop-test latency_ms loss_percent]\n"
+				"          [--batch worlds max_ticks [--threads count] [--replay file]] [--autopilot aggression]\n"
+				"          [--frame-bench out.json max_ticks [--frame-backend null|raylib] [--replay file]] [--hitch-ms ms] [--pacing sleep|vsync]\n"
+				"          [--alloc-fatal]\n",
+				argv[0]);
+			return 1;
+		}
+	}
+
+	logger_set_async(true);
+	if (getenv("ASTROIDS_LOG") && logger_category_configure(getenv("ASTROIDS_LOG")) == false) {
+		LOG_WARN("Logger: could not fully parse ASTROIDS_LOG=\"%s\"", getenv("ASTROIDS_LOG"));
+	}
+	if (getenv("ASTROIDS_LOG_BINARY"))
+		logger_binary_open(getenv("ASTROIDS_LOG_BINARY"));
+
+	// SIMD physics paths must match the scalar one bit for bit or replays diverge between machines
+	ASSERT_MESSAGE(entity_physics_self_check(), "batch physics backends disagree with scalar");
+
+	Replay replay = { 0 };
+	if (replay_path && replay_load(&replay, replay_path) == false)
+		return 1;
+
+	// Per-tick state hashes, written next to a replay or checked against an earlier run of it
+	WorldHashStream hashes = { 0 };
+	if (hash_out_path && world_hash_stream_create(&hashes, hash_out_path) == false)
+		return 1;
+	if (hash_check_path && world_hash_stream_open(&hashes, hash_check_path) == false)
+		return 1;
+
+	// Unattended runs for tuning and regressions, world i plays seed + i from the replay or a random script
+	if (batch) {
+		batch_config.replay = replay_path ? &replay : NULL;
+		batch_config.autopilot = autopilot;
+		batch_config.aggression = aggression;
+		batch_config.seed = replay_path ? replay.seed : getenv("ASTROIDS_SEED") ? strtoull(getenv("ASTROIDS_SEED"), NULL, 0) : 1;
+
+		WorldBatch runner;
+		bool32 ran = world_batch_run(&runner, &batch_config);
+		if (ran)
+			world_batch_report(&runner);
+		world_batch_destroy(&runner);
+
+		replay_unload(&replay);
+		logger_binary_close();
+		logger_set_async(false);
+		return ran ? 0 : 1;
+	}
+
+	// One fixed session through world_update and world_draw, frame times per phase go to JSON for diffing builds
+	if (frame_bench) {
+		frame_bench_config.replay = replay_path ? &replay : NULL;
+		frame_bench_config.aggression = autopilot ? aggression : 1.0f;
+		frame_bench_config.seed = getenv("ASTROIDS_SEED") ? strtoull(getenv("ASTROIDS_SEED"), NULL, 0) : 1;
+
+		Texture atlas = { 0 };
+		Shader flash_shader = { 0 };
+		bool32 window = frame_bench_config.backend == FRAME_BENCH_RAYLIB;
+		if (window) {
+			// Hidden and without a target FPS, so the timings are the frame's own cost
+			SetConfigFlags(FLAG_WINDOW_HIDDEN);
+			InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Astroids frame bench");
+			atlas = LoadTexture("assets/sprites/atlas.png");
+			flash_shader = LoadShaderFromMemory(NULL, FLASH_SHADER_CODE);
+		}
+
+		bool32 ran = frame_bench_run(&frame_bench_config, window ? &atlas : NULL, window ? &flash_shader : NULL);
+
+		if (window) {
+			UnloadShader(flash_shader);
+			UnloadTexture(atlas);
+			CloseWindow();
+		}
+		replay_unload(&replay);
+		logger_binary_close();
+		logger_set_async(false);
+		return ran ? 0 : 1;
+	}
+
+	if (headless || coop_test) {
+		if (replay_path == NULL) {
+			LOG_ERROR("Headless runs need a --replay to drive them");
+			return 1;
+		}
+
+		int result = coop_test ? run_coop_test(&replay, conditions) : run_headless(&replay, &hashes);
+		world_hash_stream_close(&hashes);
+		replay_unload(&replay);
+		logger_binary_close();
+		logger_set_async(false);
+		return result;
+	}
+
+	if (pacing == FRAME_PACING_VSYNC)
+		SetConfigFlags(FLAG_VSYNC_HINT);
 	InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Astroids");
+#if defined(PLATFORM_WEB)
 	SetTargetFPS(60);
+#endif
 	audio_initialize();
 
 	Texture atlas = LoadTexture("assets/sprites/atlas.png");
 	Shader flash_shader = LoadShaderFromMemory(NULL, FLASH_SHADER_CODE);
 
+	// A fixed ASTROIDS_SEED makes every gameplay stream repeat from run to run
+	uint64_t seed = getenv("ASTROIDS_SEED") ? strtoull(getenv("ASTROIDS_SEED"), NULL, 0) : (uint64_t)time(NULL);
+	// Co-op peers have no handshake yet, they agree on a seed by default
+	if (coop && getenv("ASTROIDS_SEED") == NULL)
+		seed = 1;
+	if (replay_path)
+		seed = replay.seed;
+	LOG_INFO("World: seed %llu", (unsigned long long)seed);
+
+	ReplayRecorder recorder = { 0 };
+	if (record_path)
+		replay_recorder_open(&recorder, record_path, seed);
+
 	GameWorld world = { 0 };
-	world_init(&world, &atlas, &flash_shader);
+	world_init(&world, &atlas, &flash_shader, seed);
+
+	Autopilot pilot;
+	autopilot_init(&pilot, aggression);
 	SetExitKey(KEY_NULL);
+	input_init();
+
+	NetLink coop_link = { 0 };
+	InputState coop_input = { 0 };
+	float coop_time = 0.0f;
+	if (coop) {
+		if (net_link_open_udp(&coop_link, coop_port, coop_peer, coop_peer_port) == false)
+			return 1;
+
+		world_set_player_count(&world, 2);
+		rollback_session_init(&coop_sessions[0], &world, &coop_link, coop_player, 2);
+	}
+
+	profiler_enable(true);
+	profiler_set_hitch_ms(hitch_ms);
+
+	// Vsync paces at the display's rate, the simulation steps by whatever time passed
+	FramePacer pacer;
+	frame_pacer_init(&pacer, pacing, pacing == FRAME_PACING_VSYNC ? (float)GetMonitorRefreshRate(GetCurrentMonitor()) : 60.0f);
 
 	Color DARK = { 20, 20, 20, 255 };
 	while (world.running && WindowShouldClose() == false) {
-		float dt = GetFrameTime();
-		audio_update(dt);
+		profiler_frame_begin();
+		alloc_tracker_frame_begin();
+
+		// Rewinding rewrites history, so only live unrecorded sessions may do it
+		if (world.show_debug && replay_path == NULL && record_path == NULL && coop == false && IsKeyDown(KEY_BACKSPACE) &&
+			world_rewind_step_back(&rewind_ring, &world)) {
+			frame_present(&world, &pacer);
+			frame_arenas_swap(&world.frames);
+			continue;
+		}
 
-		world_update(&world, dt);
+		if (coop) {
+			audio_update(pacer.delta);
+			// A stalled tick takes no input, presses wait for the tick that does instead of being lost
+			InputState polled = input_poll();
+			coop_input.down = polled.down;
+			coop_input.pressed |= polled.pressed;
 
-		BeginDrawing();
-		world_draw(&world);
-		EndDrawing();
+			// Both peers tick at the fixed rollback rate whatever their displays refresh at,
+			// frames in between only receive so late inputs still roll back promptly
+			uint32_t zone = profiler_zone_begin("rollback");
+			coop_time = min(coop_time + pacer.delta, ROLLBACK_TICK_DT * COOP_MAX_TICKS_PER_FRAME);
+			if (coop_time < ROLLBACK_TICK_DT)
+				rollback_poll(&coop_sessions[0], clock_now_ns());
+			while (coop_time >= ROLLBACK_TICK_DT) {
+				if (rollback_advance(&coop_sessions[0], coop_input, clock_now_ns()) == false)
+					break;
+				coop_input.pressed = 0;
+				coop_time -= ROLLBACK_TICK_DT;
+			}
+			profiler_zone_end(zone);
 
-		arena_reset(&world.frame);
+			frame_present(&world, &pacer);
+			frame_arenas_swap(&world.frames);
+			continue;
+		}
+
+		uint32_t zone = profiler_zone_begin("input");
+		ReplayTick tick = { .input = input_poll(), .dt = pacer.delta };
+		// The keyboard still works on top, for toggles or to take over for a moment
+		InputState piloted = { 0 };
+		if (autopilot) {
+			piloted = autopilot_next(&pilot, &world, 0);
+			tick.input.down |= piloted.down;
+			tick.input.pressed |= piloted.pressed;
+		}
+		if (replay_path && replay_next(&replay, &tick) == false)
+			break;
+		replay_recorder_push(&recorder, &tick);
+		profiler_zone_end(zone);
+
+		zone = profiler_zone_begin("audio");
+		audio_update(tick.dt);
+		profiler_zone_end(zone);
+
+		zone = profiler_zone_begin("update");
+		alloc_tracker_set_steady(pacer.frames > ALLOC_WARMUP_TICKS);
+		world_update(&world, &tick.input, tick.dt);
+		alloc_tracker_set_steady(false);
+		profiler_zone_end(zone);
+
+		zone = profiler_zone_begin("history");
+		if (hashes.file) {
+			WorldHash hash;
+			world_hash_compute(&world, &hash);
+			world_hash_stream_tick(&hashes, &hash);
+		}
+		world_rewind_tick(&rewind_ring, &world);
+		profiler_zone_end(zone);
+
+		// Keys that changed while the tick ran show on this frame's ship instead of the next one's.
+		// A replay draws exactly what it recorded
+		if (replay_path == NULL) {
+			zone = profiler_zone_begin("late_latch");
+			InputState late = input_latch_late();
+			late.down |= piloted.down;
+			player_latch_input(&world.players[0], &tick.input, &late);
+			profiler_zone_end(zone);
+		}
+
+		frame_present(&world, &pacer);
+
+		frame_arenas_swap(&world.frames);
 	}
 
+	alloc_report();
+	InputLatencyStats latency = input_latency_stats();
+	// Release builds are the ones worth measuring, so this is printed whatever the log level
+	if (latency.count) {
+		logger_flush();
+		printf("Input: %u changes shown, input to present min %.2f avg %.2f p99 %.2f max %.2f ms\n", latency.count, latency.min_ms,
+			latency.average_ms, latency.p99_ms, latency.max_ms);
+		fflush(stdout);
+	}
+
+	world_hash_stream_close(&hashes);
+	replay_recorder_close(&recorder);
+	replay_unload(&replay);
+	net_link_close(&coop_link);
+
 	audio_unload();
 	UnloadShader(flash_shader);
 	CloseWindow();
 
-	arena_destroy(&world.frame);
+	world_destroy(&world);
+	logger_binary_close();
+	logger_set_async(false);
 }
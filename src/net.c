@@ -0,0 +1,146 @@
+#define _POSIX_C_SOURCE 200809L
+#include "net.h"
+#include "core/logger.h"
+
+#include <string.h>
+
+#if NET_UDP_AVAILABLE
+	#include <arpa/inet.h>
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <netinet/in.h>
+	#include <sys/socket.h>
+	#include <unistd.h>
+#endif
+
+bool32 net_link_open_udp(NetLink *link, uint16_t local_port, const char *peer_host, uint16_t peer_port) {
+	*link = (NetLink){ .type = NET_LINK_NONE, .socket = -1 };
+
+#if NET_UDP_AVAILABLE
+	struct in_addr peer;
+	if (inet_pton(AF_INET, peer_host, &peer) != 1) {
+		LOG_WARN("Net: '%s' is not an IPv4 address", peer_host);
+		return false;
+	}
+
+	int handle = socket(AF_INET, SOCK_DGRAM, 0);
+	if (handle < 0) {
+		LOG_WARN("Net: failed to create socket (%s)", strerror(errno));
+		return false;
+	}
+
+	struct sockaddr_in local = { 0 };
+	local.sin_family = AF_INET;
+	local.sin_addr.s_addr = htonl(INADDR_ANY);
+	local.sin_port = htons(local_port);
+	if (bind(handle, (struct sockaddr *)&local, sizeof(local)) != 0 || fcntl(handle, F_SETFL, O_NONBLOCK) != 0) {
+		LOG_WARN("Net: failed to bind port %u (%s)", local_port, strerror(errno));
+		close(handle);
+		return false;
+	}
+
+	link->type = NET_LINK_UDP;
+	link->socket = handle;
+	link->peer_address = peer.s_addr;
+	link->peer_port = htons(peer_port);
+	LOG_INFO("Net: udp port %u talking to %s:%u", local_port, peer_host, peer_port);
+	return true;
+#else
+	LOG_WARN("Net: udp is not available on this platform");
+	return false;
+#endif
+}
+
+void net_link_open_simulated(NetLink *a, NetLink *b, NetWire *wire, NetConditions conditions, uint64_t seed) {
+	*wire = (NetWire){ .conditions = conditions, .rng = rng_seed(seed, 0) };
+	wire->conditions.loss_percent = min(conditions.loss_percent, 100);
+
+	*a = (NetLink){ .type = NET_LINK_SIMULATED, .socket = -1, .wire = wire, .side = 0 };
+	*b = (NetLink){ .type = NET_LINK_SIMULATED, .socket = -1, .wire = wire, .side = 1 };
+}
+
+void net_link_close(NetLink *link) {
+#if NET_UDP_AVAILABLE
+	if (link->type == NET_LINK_UDP)
+		close(link->socket);
+#endif
+	link->type = NET_LINK_NONE;
+	link->socket = -1;
+}
+
+static bool32 wire_send(NetLink *link, const void *data, uint32_t size, uint64_t now_ns) {
+	NetWire *wire = link->wire;
+	uint32_t destination = link->side ^ 1;
+
+	if ((uint32_t)rng_range(&wire->rng, 0, 99) < wire->conditions.loss_percent || wire->counts[destination] == NET_WIRE_CAPACITY) {
+		link->dropped++;
+		return true;
+	}
+
+	uint32_t delay_ms = wire->conditions.latency_ms;
+	if (wire->conditions.jitter_ms)
+		delay_ms += (uint32_t)rng_range(&wire->rng, 0, (int32_t)wire->conditions.jitter_ms);
+
+	NetPacket *packet = &wire->queues[destination][wire->counts[destination]++];
+	packet->deliver_ns = now_ns + (uint64_t)delay_ms * 1000000ull;
+	packet->size = size;
+	memcpy(packet->data, data, size);
+	return true;
+}
+
+// Earliest packet that is due, jitter may deliver them out of order like a real network
+static uint32_t wire_receive(NetLink *link, void *buffer, uint32_t capacity, uint64_t now_ns) {
+	NetWire *wire = link->wire;
+	NetPacket *queue = wire->queues[link->side];
+	uint32_t *count = &wire->counts[link->side];
+
+	uint32_t due = INVALID_INDEX;
+	for (uint32_t index = 0; index < *count; index++) {
+		if (queue[index].deliver_ns <= now_ns && (due == INVALID_INDEX || queue[index].deliver_ns < queue[due].deliver_ns))
+			due = index;
+	}
+	if (due == INVALID_INDEX)
+		return 0;
+
+	uint32_t size = min(queue[due].size, capacity);
+	memcpy(buffer, queue[due].data, size);
+	queue[due] = queue[--*count];
+	return size;
+}
+
+bool32 net_link_send(NetLink *link, const void *data, uint32_t size, uint64_t now_ns) {
+	if (size > NET_PACKET_MAX)
+		return false;
+
+	link->sent++;
+	if (link->type == NET_LINK_SIMULATED)
+		return wire_send(link, data, size, now_ns);
+
+#if NET_UDP_AVAILABLE
+	if (link->type == NET_LINK_UDP) {
+		struct sockaddr_in peer = { 0 };
+		peer.sin_family = AF_INET;
+		peer.sin_addr.s_addr = link->peer_address;
+		peer.sin_port = link->peer_port;
+		return sendto(link->socket, data, size, 0, (struct sockaddr *)&peer, sizeof(peer)) == (ssize_t)size;
+	}
+#endif
+
+	return false;
+}
+
+uint32_t net_link_receive(NetLink *link, void *buffer, uint32_t capacity, uint64_t now_ns) {
+	uint32_t size = 0;
+	if (link->type == NET_LINK_SIMULATED)
+		size = wire_receive(link, buffer, capacity, now_ns);
+
+#if NET_UDP_AVAILABLE
+	if (link->type == NET_LINK_UDP) {
+		ssize_t result = recvfrom(link->socket, buffer, capacity, 0, NULL, NULL);
+		size = result > 0 ? (uint32_t)result : 0;
+	}
+#endif
+
+	link->received += size ? 1 : 0;
+	return size;
+}
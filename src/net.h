@@ -0,0 +1,66 @@
+#pragma once
+
+#include "common.h"
+#include "core/random.h"
+
+#if defined(PLATFORM_WEB)
+	#define NET_UDP_AVAILABLE 0
+#else
+	#define NET_UDP_AVAILABLE 1
+#endif
+
+#define NET_PACKET_MAX 512
+#define NET_WIRE_CAPACITY 256
+
+// Unreliable datagram link to a single peer, either a UDP socket or one end of
+// an in-process wire that delays and drops packets on purpose. Times are in
+// nanoseconds on the caller's clock, so simulated links can run on virtual time.
+typedef enum {
+	NET_LINK_NONE,
+	NET_LINK_UDP,
+	NET_LINK_SIMULATED,
+} NetLinkType;
+
+typedef struct {
+	uint64_t deliver_ns;
+	uint32_t size;
+	uint8_t data[NET_PACKET_MAX];
+} NetPacket;
+
+typedef struct {
+	uint32_t latency_ms, jitter_ms;
+	// 0 to 100
+	uint32_t loss_percent;
+} NetConditions;
+
+// Both directions of a simulated link, packets wait in the receiving side's queue
+typedef struct {
+	NetConditions conditions;
+	Rng rng;
+
+	NetPacket queues[2][NET_WIRE_CAPACITY];
+	uint32_t counts[2];
+} NetWire;
+
+typedef struct {
+	NetLinkType type;
+
+	int socket;
+	uint32_t peer_address;
+	uint16_t peer_port;
+
+	NetWire *wire;
+	uint32_t side;
+
+	uint32_t sent, received, dropped;
+} NetLink;
+
+// `peer_host` is a dotted IPv4 address
+bool32 net_link_open_udp(NetLink *link, uint16_t local_port, const char *peer_host, uint16_t peer_port);
+// Connects `a` and `b` through `wire`, `seed` drives loss and jitter
+void net_link_open_simulated(NetLink *a, NetLink *b, NetWire *wire, NetConditions conditions, uint64_t seed);
+void net_link_close(NetLink *link);
+
+bool32 net_link_send(NetLink *link, const void *data, uint32_t size, uint64_t now_ns);
+// Returns the size of the next packet due by `now_ns`, 0 when there is none
+uint32_t net_link_receive(NetLink *link, void *buffer, uint32_t capacity, uint64_t now_ns);
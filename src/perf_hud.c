@@ -0,0 +1,72 @@
+#include "perf_hud.h"
+
+#include "core/alloc_tracker.h"
+#include "core/astring.h"
+#include "core/profiler.h"
+#include "input.h"
+
+#include <raylib.h>
+
+#define PERF_HUD_WIDTH 260.0f
+#define PERF_HUD_GRAPH_HEIGHT 60.0f
+#define PERF_HUD_LINE 14.0f
+
+void perf_hud_draw(Arena *frame, float x, float y) {
+	ProfilerStats stats = profiler_stats();
+	float frame_ms[PROFILER_HISTORY];
+	uint32_t count = profiler_history(frame_ms, countof(frame_ms));
+
+	float height = PERF_HUD_GRAPH_HEIGHT + PERF_HUD_LINE * (5 + ALLOC_TRACKER_AVAILABLE + PROFILER_TOP_ZONES) + 12.0f;
+	DrawRectangleRec((Rectangle){ x, y, PERF_HUD_WIDTH, height }, (Color){ 0, 0, 0, 170 });
+
+	// Newest frame on the right, the budget sits halfway up the graph
+	float bar_width = PERF_HUD_WIDTH / PROFILER_HISTORY;
+	float graph_bottom = y + 4.0f + PERF_HUD_GRAPH_HEIGHT;
+	float scale = PERF_HUD_GRAPH_HEIGHT / (stats.budget_ms * 2.0f);
+	for (uint32_t index = 0; index < count; index++) {
+		float bar_height = min(frame_ms[index] * scale, PERF_HUD_GRAPH_HEIGHT);
+		float bar_x = x + PERF_HUD_WIDTH - (count - index) * bar_width;
+		Color color = frame_ms[index] > stats.budget_ms ? (Color){ 230, 41, 55, 255 } : (Color){ 0, 228, 48, 255 };
+		DrawRectangleRec((Rectangle){ bar_x, graph_bottom - bar_height, bar_width, bar_height }, color);
+	}
+	float budget_y = graph_bottom - stats.budget_ms * scale;
+	DrawLineV((Vector2){ x, budget_y }, (Vector2){ x + PERF_HUD_WIDTH, budget_y }, (Color){ 253, 249, 0, 255 });
+
+	float line_y = graph_bottom + 6.0f;
+	String line = string_format(frame, "min %.2f  avg %.2f  p99 %.2f ms", stats.min_ms, stats.average_ms, stats.p99_ms);
+	DrawText(line.data, (int)x + 6, (int)line_y, 10, WHITE);
+	line_y += PERF_HUD_LINE;
+
+	line = string_format(frame, "%u/%u frames over %.1f ms", stats.over_budget, stats.frame_count, stats.budget_ms);
+	DrawText(line.data, (int)x + 6, (int)line_y, 10, stats.over_budget ? (Color){ 230, 41, 55, 255 } : WHITE);
+	line_y += PERF_HUD_LINE;
+
+	line = string_format(frame, "pacing jitter avg %.2f  p99 %.2f ms", stats.jitter_ms, stats.jitter_p99_ms);
+	DrawText(line.data, (int)x + 6, (int)line_y, 10, WHITE);
+	line_y += PERF_HUD_LINE;
+
+	InputLatencyStats latency = input_latency_stats();
+	line = string_format(frame, "input to present avg %.2f  p99 %.2f ms", latency.average_ms, latency.p99_ms);
+	DrawText(line.data, (int)x + 6, (int)line_y, 10, WHITE);
+	line_y += PERF_HUD_LINE;
+
+	if (ALLOC_TRACKER_AVAILABLE) {
+		AllocTrackerStats allocs = alloc_tracker_stats();
+		line = string_format(frame, "heap allocs %u last frame, %llu steady", allocs.last_frame, (unsigned long long)allocs.violations);
+		DrawText(line.data, (int)x + 6, (int)line_y, 10, allocs.violations ? (Color){ 230, 41, 55, 255 } : WHITE);
+		line_y += PERF_HUD_LINE;
+	}
+
+	if (stats.slowest == NULL)
+		return;
+
+	line = string_format(frame, "slowest %.2f ms (frame %llu)", stats.slowest->duration_ns / 1e6, (unsigned long long)stats.slowest->index);
+	DrawText(line.data, (int)x + 6, (int)line_y, 10, WHITE);
+	line_y += PERF_HUD_LINE;
+
+	for (uint32_t slot = 0; slot < PROFILER_TOP_ZONES && stats.slowest->top[slot].name; slot++) {
+		line = string_format(frame, "  %s %.2f ms", stats.slowest->top[slot].name, stats.slowest->top[slot].duration_ns / 1e6);
+		DrawText(line.data, (int)x + 6, (int)line_y, 10, LIGHTGRAY);
+		line_y += PERF_HUD_LINE;
+	}
+}
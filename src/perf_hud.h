@@ -0,0 +1,8 @@
+#pragma once
+
+#include "common.h"
+#include "core/arena.h"
+
+// Rolling frame time graph against the budget, min/avg/p99 over the profiler's
+// history, frames over budget and the heaviest zones of the slowest recent frame
+void perf_hud_draw(Arena *frame, float x, float y);
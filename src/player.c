@@ -1,5 +1,6 @@
 #include "player.h"
 #include "audio_manager.h"
+#include "entity_physics.h"
 #include "globals.h"
 #include "weapon.h"
 #include <raymath.h>
@@ -12,20 +13,22 @@ bool32 player_init(Player *player, Texture *texture) {
 	*player = (Player){
 		.entity = {
 		  .active = true,
-		  .position = { .x = WINDOW_WIDTH * .5f, .y = WINDOW_HEIGHT * .5f },
-		  .velocity = { 0, 0 },
-		  .size = { .x = PLAYER_SIZE, .y = PLAYER_SIZE },
-		  .rotation = 0,
-		  .area = { PLAYER_SPRITE_OFFSET_X, 0, TILE_SIZE, TILE_SIZE },
-		  .tint = WHITE,
-		  .texture = texture }
+		  .body = {
+			.position = { .x = WINDOW_WIDTH * .5f, .y = WINDOW_HEIGHT * .5f },
+			.velocity = { 0, 0 },
+			.size = { .x = PLAYER_SIZE, .y = PLAYER_SIZE },
+			.rotation = 0 },
+		  .sprite = {
+			.area = { PLAYER_SPRITE_OFFSET_X, 0, TILE_SIZE, TILE_SIZE },
+			.tint = WHITE,
+			.texture = texture } }
 	};
 
 	player->animation_frame = 0;
 	player->animation_timer = 0.0f;
 
-	player->entity.collision_active = true;
-	player->entity.collision_shape = (Rectangle){ 0, 0, .width = PLAYER_SIZE * .6f, .height = PLAYER_SIZE * .7f };
+	player->entity.body.collision_active = true;
+	player->entity.body.collision_shape = (Rectangle){ 0, 0, .width = PLAYER_SIZE * .6f, .height = PLAYER_SIZE * .7f };
 
 	player->rotation_speed = 4.5f;
 	player->acceleration = 0.4f;
@@ -39,20 +42,21 @@ bool32 player_init(Player *player, Texture *texture) {
 	return true;
 }
 
-void player_update(Player *player, BulletSystem *weapon_system, float dt) {
+void player_update(Player *player, BulletSystem *weapon_system, const InputState *input, float dt) {
+	player->late_latched = false;
 	if (!player->entity.active)
 		return;
 
 	player->info.fire_timer += dt;
 
-	if (IsKeyDown(KEY_D))
-		player->entity.rotation += player->rotation_speed;
-	if (IsKeyDown(KEY_A))
-		player->entity.rotation -= player->rotation_speed;
+	if (input_down(input, INPUT_TURN_RIGHT))
+		player->entity.body.rotation += player->rotation_speed;
+	if (input_down(input, INPUT_TURN_LEFT))
+		player->entity.body.rotation -= player->rotation_speed;
 
-	if (IsKeyDown(KEY_W)) {
-		Vector2 thrust_direction = Vector2Rotate((Vector2){ 0, -1 }, player->entity.rotation * DEG2RAD);
-		player->entity.velocity = Vector2Add(player->entity.velocity, Vector2Scale(thrust_direction, player->acceleration));
+	if (input_down(input, INPUT_THRUST)) {
+		Vector2 thrust_direction = Vector2Rotate((Vector2){ 0, -1 }, player->entity.body.rotation * DEG2RAD);
+		player->entity.body.velocity = Vector2Add(player->entity.body.velocity, Vector2Scale(thrust_direction, player->acceleration));
 
 		// Animation
 		if (player->animation_frame == 0) {
@@ -69,49 +73,43 @@ void player_update(Player *player, BulletSystem *weapon_system, float dt) {
 			player->animation_timer = 0.0f;
 		}
 
-		player->entity.area.x = PLAYER_SPRITE_OFFSET_X + (TILE_SIZE * player->animation_frame);
+		player->entity.sprite.area.x = PLAYER_SPRITE_OFFSET_X + (TILE_SIZE * player->animation_frame);
 
 		// Audio
 		audio_loop_play(LOOP_PLAYER_ROCKET);
-		audio_loop_set_pitch(LOOP_PLAYER_ROCKET, 1.0f + (Vector2Length(player->entity.velocity) * 0.05f));
+		audio_loop_set_pitch(LOOP_PLAYER_ROCKET, 1.0f + (Vector2Length(player->entity.body.velocity) * 0.05f));
 		audio_loop_set_volume(LOOP_PLAYER_ROCKET, .3f);
 
 	} else {
 		// Idle
 		player->animation_frame = 0;
-		player->entity.area.x = PLAYER_SPRITE_OFFSET_X;
+		player->entity.sprite.area.x = PLAYER_SPRITE_OFFSET_X;
 		audio_loop_stop(LOOP_PLAYER_ROCKET);
 	}
 
-	entity_update_physics(&player->entity, player->drag, dt);
-	float half_w = player->entity.size.x * .5f;
-	float half_h = player->entity.size.y * .5f;
-
-	if (player->entity.position.x < -half_w)
-		player->entity.position.x = WINDOW_WIDTH + half_w;
-	else if (player->entity.position.x > WINDOW_WIDTH + half_w)
-		player->entity.position.x = -half_w;
-
-	if (player->entity.position.y < -half_h)
-		player->entity.position.y = WINDOW_HEIGHT + half_h;
-	else if (player->entity.position.y > WINDOW_HEIGHT + half_h)
-		player->entity.position.y = -half_h;
-	entity_sync_collision(&player->entity);
+	EntityMotion motion = {
+		.velocity_scale = 1.0f,
+		.drag = player->drag,
+		.wrap = true,
+		.wrap_margin = .5f,
+		.bounds = { WINDOW_WIDTH, WINDOW_HEIGHT },
+	};
+	entity_bodies_integrate(&player->entity.body, 1, &motion);
 
 	// --- 3. FIRING ---
-	if (IsKeyPressed(KEY_SPACE) && player->info.fire_timer >= player->info.fire_rate) {
-		Vector2 aim_direction = Vector2Rotate((Vector2){ 0, -1 }, player->entity.rotation * DEG2RAD);
-		Vector2 spawn_position = Vector2Add(player->entity.position, Vector2Scale(aim_direction, player->entity.size.y * 0.5f));
+	if (input_pressed(input, INPUT_FIRE) && player->info.fire_timer >= player->info.fire_rate) {
+		Vector2 aim_direction = Vector2Rotate((Vector2){ 0, -1 }, player->entity.body.rotation * DEG2RAD);
+		Vector2 spawn_position = Vector2Add(player->entity.body.position, Vector2Scale(aim_direction, player->entity.body.size.y * 0.5f));
 
 		// Speed scaling damage logic
 		float player_max_speed = (player->acceleration * player->drag) / (1 - player->drag);
-		float t = Vector2Length(player->entity.velocity) / player_max_speed;
+		float t = Vector2Length(player->entity.body.velocity) / player_max_speed;
 		float damage_multiplier = 1.0f + t * 2.0f;
 
 		// Delegate to Weapon System
 		weapon_bullet_spawn(weapon_system,
 			spawn_position,
-			player->entity.rotation,
+			player->entity.body.rotation,
 			aim_direction,
 			player->info.speed,
 			damage_multiplier);
@@ -122,9 +120,32 @@ void player_update(Player *player, BulletSystem *weapon_system, float dt) {
 	// --- 4. INTEGRATION ---
 }
 
+static float player_turn(const InputState *input) {
+	return (float)input_down(input, INPUT_TURN_RIGHT) - (float)input_down(input, INPUT_TURN_LEFT);
+}
+
+void player_latch_input(Player *player, const InputState *tick, const InputState *late) {
+	player->late_latched = true;
+	player->late_rotation = (player_turn(late) - player_turn(tick)) * player->rotation_speed;
+	player->late_thrust = input_down(late, INPUT_THRUST);
+}
+
 void player_draw(Player *player) {
-	if (player->entity.active)
+	if (!player->entity.active)
+		return;
+	if (!player->late_latched) {
 		entity_draw(&player->entity);
+		return;
+	}
+
+	// Drawn from a copy, the latched pose must not leak into the next tick
+	Entity shown = player->entity;
+	shown.body.rotation += player->late_rotation;
+	if (player->late_thrust && player->animation_frame == 0)
+		shown.sprite.area.x = PLAYER_SPRITE_OFFSET_X + TILE_SIZE * 2;
+	else if (!player->late_thrust)
+		shown.sprite.area.x = PLAYER_SPRITE_OFFSET_X;
+	entity_draw(&shown);
 }
 
 void player_kill(Player *player) {
@@ -2,6 +2,7 @@
 
 #include "fsm.h"
 #include "entity.h"
+#include "input.h"
 #include "weapon.h"
 
 typedef struct {
@@ -25,11 +26,18 @@ typedef struct {
 	uint32_t animation_frame;
 	float animation_timer;
 
+	// Render only, how the input latched right before draw differs from the tick's.
+	// Never read by the simulation so replays, hashes and rollback stay deterministic
+	bool32 late_latched, late_thrust;
+	float late_rotation;
+
 	FSM state_machine;
 } Player;
 
 bool32 player_init(Player *player, Texture *texture);
-void player_update(Player *player, BulletSystem *bullets, float dt);
+void player_update(Player *player, BulletSystem *bullets, const InputState *input, float dt);
 void player_draw(Player *player);
+// Lets the next draw show turning and thrust the tick has not simulated yet, cleared by the next update
+void player_latch_input(Player *player, const InputState *tick, const InputState *late);
 
 void player_kill(Player *player);
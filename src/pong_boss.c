@@ -4,6 +4,7 @@
 #include "common.h"
 #include "core/logger.h"
 #include "entity.h"
+#include "entity_physics.h"
 #include "fsm.h"
 #include "globals.h"
 #include <math.h>
@@ -48,26 +49,30 @@ static const char *stringify_state[PADDLE_STATE_COUNT] = {
 	[PADDLE_STATE_DEATH] = "STATE_DEATH",
 };
 
-bool32 boss_encounter_paddle_initialize(PaddleEncounter *encounter, Texture *texture) {
+bool32 boss_encounter_paddle_initialize(PaddleEncounter *encounter, Texture *texture, Rng rng) {
 	*encounter = (PaddleEncounter){ 0 };
 	encounter->paddle_texture = texture;
+	encounter->rng = rng;
 	encounter->max_health = 200.f;
 	encounter->health = encounter->max_health;
 
+	entity_store_init(&encounter->projectiles.store, encounter->projectiles.slots, encounter->projectiles.handles, BRICK_MAX_PROJECTILES);
+	entity_store_add_column(&encounter->projectiles.store, encounter->projectiles.bodies, sizeof(*encounter->projectiles.bodies));
+
 	for (uint32_t paddle_index = 0; paddle_index < 2; ++paddle_index) {
 		Paddle *paddle = &encounter->paddles[paddle_index];
 
 		paddle->entity.active = true;
-		paddle->entity.size = (Vector2){ TILE_SIZE * 2, TILE_SIZE * 8 };
+		paddle->entity.body.size = (Vector2){ TILE_SIZE * 2, TILE_SIZE * 8 };
 
-		paddle->entity.velocity = (Vector2){ 0, 0 };
-		paddle->entity.tint = WHITE;
+		paddle->entity.body.velocity = (Vector2){ 0, 0 };
+		paddle->entity.sprite.tint = WHITE;
 
-		paddle->entity.area = (Rectangle){ (TILE_SIZE * 3) * paddle_index, 0, TILE_SIZE, TILE_SIZE * 4 };
-		paddle->entity.texture = texture;
+		paddle->entity.sprite.area = (Rectangle){ (TILE_SIZE * 3) * paddle_index, 0, TILE_SIZE, TILE_SIZE * 4 };
+		paddle->entity.sprite.texture = texture;
 
-		paddle->entity.collision_active = true;
-		paddle->entity.collision_shape = (Rectangle){ 0, 0, paddle->entity.size.x, paddle->entity.size.y };
+		paddle->entity.body.collision_active = true;
+		paddle->entity.body.collision_shape = (Rectangle){ 0, 0, paddle->entity.body.size.x, paddle->entity.body.size.y };
 
 		// paddle->max_health = max_health * .5f;
 		// paddle->health = paddle->max_health;
@@ -123,17 +128,17 @@ void boss_encounter_paddle_update(PaddleEncounter *encounter, Vector2 player_pos
 		Paddle *paddle = &encounter->paddles[paddle_index];
 
 		paddle->animation_timer += dt;
-		uint32_t total_frames = paddle->entity.area.y == 0 ? 3 : 5;
+		uint32_t total_frames = paddle->entity.sprite.area.y == 0 ? 3 : 5;
 		if (paddle->animation_timer >= ANIMATION_SPEED) {
 			paddle->animation_frame = (paddle->animation_frame + 1) % total_frames;
 			paddle->animation_timer = 0.0f;
 		}
 
 		uint32_t offset = 0;
-		if (paddle->entity.area.y == 0)
+		if (paddle->entity.sprite.area.y == 0)
 			offset = paddle_index ? TILE_SIZE * 3 : 0;
 
-		paddle->entity.area.x = offset + (paddle->animation_frame * TILE_SIZE);
+		paddle->entity.sprite.area.x = offset + (paddle->animation_frame * TILE_SIZE);
 
 		entity_sync_collision(&paddle->entity);
 	}
@@ -148,8 +153,8 @@ void boss_encounter_paddle_draw(PaddleEncounter *encounter, bool32 show_debug) {
 		entity_draw(brick);
 
 		if (show_debug) {
-			if (brick->collision_active)
-				DrawRectangleLinesEx(brick->collision_shape, 1.0f, GREEN);
+			if (brick->body.collision_active)
+				DrawRectangleLinesEx(brick->body.collision_shape, 1.0f, GREEN);
 		}
 	}
 
@@ -161,32 +166,30 @@ void boss_encounter_paddle_draw(PaddleEncounter *encounter, bool32 show_debug) {
 		entity_draw(&paddle->entity);
 		if (show_debug) {
 			DrawLineV(encounter->balls[0].position, encounter->player_position, YELLOW);
-			DrawCircle(paddle->entity.position.x, paddle->target_y, 5, GREEN);
+			DrawCircle(paddle->entity.body.position.x, paddle->target_y, 5, GREEN);
 
-			DrawCircleV(paddle->entity.position, 3.f, GREEN);
-			DrawRectangleLinesEx(paddle->entity.collision_shape, 1.f, RED);
+			DrawCircleV(paddle->entity.body.position, 3.f, GREEN);
+			DrawRectangleLinesEx(paddle->entity.body.collision_shape, 1.f, RED);
 
 			StateID current_state = fsm_state_get(&encounter->state_machine);
 
 			const char *state = stringify_state[current_state];
 			Vector2 position = {
-				.x = paddle->entity.position.x - (MeasureText(state, 32) * .5f),
-				.y = paddle->entity.position.y - (paddle->entity.size.y * .5f) - 50.f,
+				.x = paddle->entity.body.position.x - (MeasureText(state, 32) * .5f),
+				.y = paddle->entity.body.position.y - (paddle->entity.body.size.y * .5f) - 50.f,
 			};
 			DrawText(stringify_state[current_state], position.x, position.y, 32, WHITE);
 		}
 	}
 
-	for (uint32_t projectile_index = 0; projectile_index < BRICK_MAX_PROJECTILES; ++projectile_index) {
-		Entity *projectile = &encounter->projectiles[projectile_index];
+	for (uint32_t projectile_index = 0; projectile_index < encounter->projectiles.store.count; ++projectile_index) {
+		EntityBody *projectile = &encounter->projectiles.bodies[projectile_index];
 
-		if (projectile->active) {
-			DrawCircleV(projectile->position, 6.0f, ORANGE);
-			DrawCircleV(projectile->position, 3.0f, YELLOW);
+		DrawCircleV(projectile->position, 6.0f, ORANGE);
+		DrawCircleV(projectile->position, 3.0f, YELLOW);
 
-			if (show_debug && projectile->collision_active)
-				DrawRectangleLinesEx(projectile->collision_shape, 1.0f, GREEN);
-		}
+		if (show_debug && projectile->collision_active)
+			DrawRectangleLinesEx(projectile->collision_shape, 1.0f, GREEN);
 	}
 
 	ScenarioConfig *scenario = &encounter->active_scenario;
@@ -250,8 +253,8 @@ void boss_paddle_apply_damage(PaddleEncounter *encounter, uint32_t paddle_index,
 	if (encounter->health <= 0.0f) {
 		fsm_state_set(&encounter->state_machine, PADDLE_STATE_DEATH);
 	} else {
-		if (encounter->health <= encounter->max_health * .5f && boss->entity.area.y == 0) {
-			boss->entity.area.y += TILE_SIZE * 4;
+		if (encounter->health <= encounter->max_health * .5f && boss->entity.sprite.area.y == 0) {
+			boss->entity.sprite.area.y += TILE_SIZE * 4;
 		}
 
 		audio_sfx_play(SFX_PADDLE_HURT, 1.0f, true);
@@ -278,42 +281,42 @@ bool32 boss_encounter_paddle_check_collision(PaddleEncounter *encounter, Entity
 
 		if (paddle->entity.active) {
 			entity_sync_collision(&paddle->entity);
-			if (CheckCollisionRecs(player->collision_shape, paddle->entity.collision_shape))
+			if (CheckCollisionRecs(player->body.collision_shape, paddle->entity.body.collision_shape))
 				return true;
 		}
 	}
 
 	for (uint32_t brick_index = 0; brick_index < MAX_BRICKS; ++brick_index) {
 		Entity *brick = &encounter->bricks[brick_index];
-		if (brick->active == false || brick->collision_active == false)
+		if (brick->active == false || brick->body.collision_active == false)
 			continue;
 
 		entity_sync_collision(player);
-		if (CheckCollisionRecs(player->collision_shape, brick->collision_shape)) {
-			float dx = player->position.x - brick->position.x;
-			float dy = player->position.y - brick->position.y;
+		if (CheckCollisionRecs(player->body.collision_shape, brick->body.collision_shape)) {
+			float dx = player->body.position.x - brick->body.position.x;
+			float dy = player->body.position.y - brick->body.position.y;
 
-			float width_sum = (player->collision_shape.width * .5f) + (brick->collision_shape.width * .5f);
-			float height_sum = (player->collision_shape.height * .5f) + (brick->collision_shape.height * .5f);
+			float width_sum = (player->body.collision_shape.width * .5f) + (brick->body.collision_shape.width * .5f);
+			float height_sum = (player->body.collision_shape.height * .5f) + (brick->body.collision_shape.height * .5f);
 
 			float overlap_x = width_sum - fabsf(dx);
 			float overlap_y = height_sum - fabsf(dy);
 
 			if (overlap_x < overlap_y) {
 				float sign_x = (dx > 0) ? 1.0f : -1.0f;
-				player->position.x += (overlap_x)*sign_x;
+				player->body.position.x += (overlap_x)*sign_x;
 
-				if ((sign_x > 0 && player->velocity.x < 0) || (sign_x < 0 && player->velocity.x > 0))
-					player->velocity.x = 0.0f;
+				if ((sign_x > 0 && player->body.velocity.x < 0) || (sign_x < 0 && player->body.velocity.x > 0))
+					player->body.velocity.x = 0.0f;
 			} else {
 				float sign_y = (dy > 0) ? 1.0f : -1.0f;
-				player->position.y += (overlap_y)*sign_y;
+				player->body.position.y += (overlap_y)*sign_y;
 
-				if ((sign_y > 0 && player->velocity.y < 0) || (sign_y < 0 && player->velocity.y > 0))
-					player->velocity.y = 0.0f;
+				if ((sign_y > 0 && player->body.velocity.y < 0) || (sign_y < 0 && player->body.velocity.y > 0))
+					player->body.velocity.y = 0.0f;
 			}
 
-			LOG_INFO("Player should be updated?");
+			LOG_CAT_LIMIT(LOG_CATEGORY_BOSS, LOG_LEVEL_DEBUG, 2, "Player should be updated?");
 			entity_sync_collision(player);
 		}
 	}
@@ -322,16 +325,14 @@ bool32 boss_encounter_paddle_check_collision(PaddleEncounter *encounter, Entity
 		Ball *ball = &encounter->balls[ball_index];
 
 		if (ball->active)
-			if (CheckCollisionCircleRec(ball->position, ball->radius, player->collision_shape))
+			if (CheckCollisionCircleRec(ball->position, ball->radius, player->body.collision_shape))
 				return true;
 	}
 
-	for (int projectile_index = 0; projectile_index < BRICK_MAX_PROJECTILES; projectile_index++) {
-		Entity *projectile = &encounter->projectiles[projectile_index];
-		if (projectile->active) {
-			if (CheckCollisionRecs(player->collision_shape, projectile->collision_shape)) {
-				return true;
-			}
+	for (uint32_t projectile_index = 0; projectile_index < encounter->projectiles.store.count; projectile_index++) {
+		EntityBody *projectile = &encounter->projectiles.bodies[projectile_index];
+		if (CheckCollisionRecs(player->body.collision_shape, projectile->collision_shape)) {
+			return true;
 		}
 	}
 	return false;
@@ -340,11 +341,11 @@ bool32 boss_encounter_paddle_check_collision(PaddleEncounter *encounter, Entity
 void paddle_pong_entry_enter(void *context) {
 	PaddleEncounter *encounter = (PaddleEncounter *)context;
 
-	encounter->paddles[0].entity.position = (Vector2){ -200, GetScreenHeight() / 2.f };
-	encounter->paddles[0].entity.collision_active = false;
+	encounter->paddles[0].entity.body.position = (Vector2){ -200, WINDOW_HEIGHT / 2.f };
+	encounter->paddles[0].entity.body.collision_active = false;
 
-	encounter->paddles[1].entity.position = (Vector2){ GetScreenWidth() + 200, GetScreenHeight() / 2.f };
-	encounter->paddles[1].entity.collision_active = false;
+	encounter->paddles[1].entity.body.position = (Vector2){ WINDOW_WIDTH + 200, WINDOW_HEIGHT / 2.f };
+	encounter->paddles[1].entity.body.collision_active = false;
 
 	float w_size = TILE_SIZE * 2;
 	encounter->active_scenario = (ScenarioConfig){
@@ -352,8 +353,8 @@ void paddle_pong_entry_enter(void *context) {
 		.timer = 0.0f,
 		.duration = 2.5f,
 		.warnings = {
-		  [0] = { 0, 0, w_size, GetScreenHeight() },
-		  [1] = { GetScreenWidth() - w_size, 0, w_size, GetScreenHeight() } },
+		  [0] = { 0, 0, w_size, WINDOW_HEIGHT },
+		  [1] = { WINDOW_WIDTH - w_size, 0, w_size, WINDOW_HEIGHT } },
 	};
 
 	audio_sfx_play(SFX_BOSS_WARNING, 0.8f, false);
@@ -361,11 +362,11 @@ void paddle_pong_entry_enter(void *context) {
 	for (uint32_t ball_index = 0; ball_index < countof(encounter->balls); ++ball_index) {
 		Ball *ball = &encounter->balls[ball_index];
 		encounter->balls[0].active = false;
-		encounter->balls[0].position = (Vector2){ GetScreenWidth() * 0.5f, GetScreenHeight() * 0.5f };
+		encounter->balls[0].position = (Vector2){ WINDOW_WIDTH * 0.5f, WINDOW_HEIGHT * 0.5f };
 		encounter->balls[0].radius = 35.f;
 	}
 
-	LOG_INFO("Entering state intro");
+	LOG_CAT(LOG_CATEGORY_BOSS, LOG_LEVEL_INFO, "Entering state intro");
 }
 
 StateID paddle_pong_entry_update(void *context, float dt) {
@@ -383,8 +384,8 @@ StateID paddle_pong_entry_update(void *context, float dt) {
 		t = t > 1.0f ? 1.0f : t;
 		float ease = 1.0f - powf(1.0f - t, 3.0f);
 
-		encounter->paddles[0].entity.position.x = -200 + (300 * ease);
-		encounter->paddles[1].entity.position.x = (GetScreenWidth() + 200) - (300 * ease);
+		encounter->paddles[0].entity.body.position.x = -200 + (300 * ease);
+		encounter->paddles[1].entity.body.position.x = (WINDOW_WIDTH + 200) - (300 * ease);
 	}
 
 	if (encounter->active_scenario.timer >= 2.f) {
@@ -401,8 +402,8 @@ StateID paddle_pong_entry_update(void *context, float dt) {
 void paddle_pong_entry_exit(void *context) {
 	PaddleEncounter *encounter = (PaddleEncounter *)context;
 
-	encounter->paddles[0].entity.collision_active = true;
-	encounter->paddles[1].entity.collision_active = true;
+	encounter->paddles[0].entity.body.collision_active = true;
+	encounter->paddles[1].entity.body.collision_active = true;
 
 	encounter->active_scenario = (ScenarioConfig){ 0 };
 }
@@ -426,14 +427,14 @@ StateID paddle_pong_update(void *context, float dt) {
 		if (encounter->balls[0].position.y - encounter->balls[0].radius < 0) {
 			encounter->balls[0].position.y = encounter->balls[0].radius;
 			encounter->balls[0].velocity.y *= -1;
-		} else if (encounter->balls[0].position.y + encounter->balls[0].radius > GetScreenHeight()) {
-			encounter->balls[0].position.y = GetScreenHeight() - encounter->balls[0].radius;
+		} else if (encounter->balls[0].position.y + encounter->balls[0].radius > WINDOW_HEIGHT) {
+			encounter->balls[0].position.y = WINDOW_HEIGHT - encounter->balls[0].radius;
 			encounter->balls[0].velocity.y *= -1;
 		}
 
-		if (encounter->balls[0].position.x < -100 || encounter->balls[0].position.x > GetScreenWidth() + 100) {
-			encounter->balls[0].position = (Vector2){ GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f };
-			float dir = (GetRandomValue(0, 1) == 0) ? -1.0f : 1.0f;
+		if (encounter->balls[0].position.x < -100 || encounter->balls[0].position.x > WINDOW_WIDTH + 100) {
+			encounter->balls[0].position = (Vector2){ WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f };
+			float dir = (rng_range(&encounter->rng, 0, 1) == 0) ? -1.0f : 1.0f;
 			encounter->balls[0].velocity = (Vector2){ BALL_SPEED_INITIAL * dir, 0 };
 		}
 	}
@@ -445,7 +446,7 @@ StateID paddle_pong_update(void *context, float dt) {
 			return PADDLE_STATE_BREAKOUT_ENTRY;
 
 		float direction_x = (paddle_index == 0) ? 1.0f : -1.0f;
-		float half_h = paddle->entity.size.y * 0.5f;
+		float half_h = paddle->entity.body.size.y * 0.5f;
 
 		Vector2 desired_bounce_direction = Vector2Normalize(Vector2Subtract(encounter->player_position, encounter->balls[0].position));
 		bool32 player_on_correct_side =
@@ -464,7 +465,7 @@ StateID paddle_pong_update(void *context, float dt) {
 			target_paddle_y = encounter->balls[0].position.y;
 
 		paddle->target_y = target_paddle_y;
-		float dist = target_paddle_y - paddle->entity.position.y;
+		float dist = target_paddle_y - paddle->entity.body.position.y;
 		float move = 0.0f;
 
 		if (fabsf(dist) > 10.0f) {
@@ -475,23 +476,23 @@ StateID paddle_pong_update(void *context, float dt) {
 				move = dist;
 		}
 
-		paddle->entity.position.y += move;
+		paddle->entity.body.position.y += move;
 
-		if (paddle->entity.position.y < half_h)
-			paddle->entity.position.y = half_h;
-		if (paddle->entity.position.y > GetScreenHeight() - half_h)
-			paddle->entity.position.y = GetScreenHeight() - half_h;
+		if (paddle->entity.body.position.y < half_h)
+			paddle->entity.body.position.y = half_h;
+		if (paddle->entity.body.position.y > WINDOW_HEIGHT - half_h)
+			paddle->entity.body.position.y = WINDOW_HEIGHT - half_h;
 
 		entity_sync_collision(&paddle->entity);
 
-		if (CheckCollisionCircleRec(encounter->balls[0].position, encounter->balls[0].radius, paddle->entity.collision_shape)) {
+		if (CheckCollisionCircleRec(encounter->balls[0].position, encounter->balls[0].radius, paddle->entity.body.collision_shape)) {
 			bool moving_towards = (paddle_index == 0 && encounter->balls[0].velocity.x < 0) || (paddle_index == 1 && encounter->balls[0].velocity.x > 0);
 			// audio_sfx_play(SFX_PADDLE_HIT, 1.0f, true);
 
 			if (moving_towards) {
-				float offset_y = (encounter->balls[0].position.y - paddle->entity.position.y) / half_h;
+				float offset_y = (encounter->balls[0].position.y - paddle->entity.body.position.y) / half_h;
 				const char *side[2] = { "left", "right" };
-				LOG_INFO("Paddle_%s.hit_offset_y = %.2f", side[paddle_index], offset_y);
+				LOG_CAT_LIMIT(LOG_CATEGORY_BOSS, LOG_LEVEL_INFO, 4, "Paddle_%s.hit_offset_y = %.2f", side[paddle_index], offset_y);
 				offset_y = clamp(offset_y, -1.0f, 1.0f);
 
 				float current_speed = Vector2Length(encounter->balls[0].velocity);
@@ -517,18 +518,17 @@ void paddle_pong_exit(void *context) {}
 void paddle_breakout_entry_enter(void *context) {
 	PaddleEncounter *encounter = (PaddleEncounter *)context;
 
-	audio_music_stop(MUSIC_BOSS_PONG);
 	encounter->survivor = encounter->paddles[0].entity.active ? &encounter->paddles[0] : &encounter->paddles[1];
-	encounter->survivor->entity.collision_active = false;
+	encounter->survivor->entity.body.collision_active = false;
 	encounter->active_scenario = (ScenarioConfig){
 		.type = SCENARIO_FLAG_WARNING,
-		.base_position = encounter->survivor->entity.position,
+		.base_position = encounter->survivor->entity.body.position,
 		.timer = 0.0f,
 		.duration = SPLIT_DURATION_SHAKE + SPLIT_DURATION_ROTATE + SPLIT_DURATION_EXIT + SPLIT_DURATION_WARN + SPLIT_DURATION_ENTRY
 	};
 
 	encounter->balls[0].active = false;
-	encounter->balls[0].position = (Vector2){ GetScreenWidth() * 0.5f, GetScreenHeight() * 0.5f };
+	encounter->balls[0].position = (Vector2){ WINDOW_WIDTH * 0.5f, WINDOW_HEIGHT * 0.5f };
 }
 
 StateID paddle_breakout_entry_update(void *context, float dt) {
@@ -543,9 +543,9 @@ StateID paddle_breakout_entry_update(void *context, float dt) {
 
 			encounter->active_scenario.warnings[0] = (Rectangle){ 0 };
 
-			brick->collision_active = true;
-			brick->collision_shape.width = BRICK_WIDTH;
-			brick->collision_shape.height = BRICK_HEIGHT;
+			brick->body.collision_active = true;
+			brick->body.collision_shape.width = BRICK_WIDTH;
+			brick->body.collision_shape.height = BRICK_HEIGHT;
 			entity_sync_collision(brick);
 		}
 
@@ -564,12 +564,12 @@ StateID paddle_breakout_entry_update(void *context, float dt) {
 		float shake_x = (sinf(timer * 40.0f) * intensity);
 		float shake_y = (cosf(timer * 35.0f) * intensity);
 
-		encounter->survivor->entity.position = (Vector2){
+		encounter->survivor->entity.body.position = (Vector2){
 			original_position.x + shake_x,
 			original_position.y + shake_y
 		};
 
-		encounter->survivor->entity.tint = ColorLerp(WHITE, RED, shake_t);
+		encounter->survivor->entity.sprite.tint = ColorLerp(WHITE, RED, shake_t);
 
 		// TODO: Play sound
 	}
@@ -579,24 +579,24 @@ StateID paddle_breakout_entry_update(void *context, float dt) {
 		float ease = 1.0f - powf(1.0f - rotate_t, 3.0f); // Ease out
 
 		// Reset to original position
-		encounter->survivor->entity.position = original_position;
-		encounter->survivor->entity.rotation = ease * 90.0f;
+		encounter->survivor->entity.body.position = original_position;
+		encounter->survivor->entity.body.rotation = ease * 90.0f;
 
-		encounter->survivor->entity.tint = RED;
+		encounter->survivor->entity.sprite.tint = RED;
 	}
 
 	else if (timer < SPLIT_DURATION_SHAKE + SPLIT_DURATION_ROTATE + SPLIT_DURATION_EXIT) {
 		float exit_t = (timer - SPLIT_DURATION_SHAKE - SPLIT_DURATION_ROTATE) / SPLIT_DURATION_EXIT;
 		float ease = powf(exit_t, 2.0f);
 
-		float exit_distance = GetScreenHeight() + encounter->survivor->entity.size.y;
-		encounter->survivor->entity.position = (Vector2){
+		float exit_distance = WINDOW_HEIGHT + encounter->survivor->entity.body.size.y;
+		encounter->survivor->entity.body.position = (Vector2){
 			original_position.x,
 			original_position.y - (exit_distance * ease)
 		};
 
-		encounter->survivor->entity.rotation = 90.0f;
-		encounter->survivor->entity.tint = RED;
+		encounter->survivor->entity.body.rotation = 90.0f;
+		encounter->survivor->entity.sprite.tint = RED;
 
 	}
 
@@ -605,14 +605,14 @@ StateID paddle_breakout_entry_update(void *context, float dt) {
 		float warn_t = (timer - SPLIT_DURATION_SHAKE - SPLIT_DURATION_ROTATE - SPLIT_DURATION_EXIT) / SPLIT_DURATION_WARN;
 
 		if (warn_t >= .5f)
-			audio_music_play(MUSIC_BOSS_BREAKOUT);
+			audio_music_crossfade(MUSIC_BOSS_BREAKOUT, .5f, MUSIC_SYNC_BAR);
 
 		float ball_radius = 30.f;
 		float ball_spacing = 100.f;
 
 		float total_width = (2 * ball_radius) + ((2 - 1) * ball_spacing);
 
-		float screen_center = GetScreenWidth() / 2.0f;
+		float screen_center = WINDOW_WIDTH / 2.0f;
 		float row_start_x = screen_center - (total_width / 2.0f);
 		for (uint32_t ball_index = 0; ball_index < countof(encounter->balls); ++ball_index) {
 			Ball *ball = &encounter->balls[ball_index];
@@ -620,12 +620,12 @@ StateID paddle_breakout_entry_update(void *context, float dt) {
 
 			float target_x = row_start_x + (ball_index * (ball_radius + ball_spacing)) + (ball_radius / 2.0f);
 			ball->position.x = target_x;
-			ball->position.y = GetScreenHeight() / 2.f;
+			ball->position.y = WINDOW_HEIGHT / 2.f;
 		}
 
 		encounter->active_scenario.type |= SCENARIO_FLAG_BALL_ENTER;
 		float size_h = TILE_SIZE * 2.f;
-		encounter->active_scenario.warnings[0] = (Rectangle){ 0, 0, GetScreenWidth(), size_h };
+		encounter->active_scenario.warnings[0] = (Rectangle){ 0, 0, WINDOW_WIDTH, size_h };
 	}
 
 	else if (timer < encounter->active_scenario.duration) {
@@ -635,16 +635,16 @@ StateID paddle_breakout_entry_update(void *context, float dt) {
 		}
 		float ease = 1.0f - powf(1.0f - entry_t, 3.0f);
 
-		float boss_start_y = -encounter->survivor->entity.size.y * 2.f;
+		float boss_start_y = -encounter->survivor->entity.body.size.y * 2.f;
 		float boss_target_y = TILE_SIZE * 3.0f;
 
-		encounter->survivor->entity.position.x = GetScreenWidth() * .5f;
-		encounter->survivor->entity.position.y = boss_start_y + (boss_target_y - boss_start_y) * ease;
+		encounter->survivor->entity.body.position.x = WINDOW_WIDTH * .5f;
+		encounter->survivor->entity.body.position.y = boss_start_y + (boss_target_y - boss_start_y) * ease;
 
 		float gap_size = 125.f;
 
-		float screen_center_y = GetScreenHeight() * .5f;
-		float screen_center_x = GetScreenWidth() * .5f;
+		float screen_center_y = WINDOW_HEIGHT * .5f;
+		float screen_center_x = WINDOW_WIDTH * .5f;
 
 		float start_y_offset = 40.f;
 
@@ -667,26 +667,26 @@ StateID paddle_breakout_entry_update(void *context, float dt) {
 			float target_x = row_start_x + (col * (BRICK_WIDTH + spacing_x)) + (BRICK_WIDTH / 2.f);
 			float target_y = screen_center_y + start_y_offset + ((row ? 0 : 1) * (BRICK_HEIGHT + gap_size));
 
-			float start_x = (target_x < screen_center_x) ? -BRICK_WIDTH * 2.f : GetScreenWidth() + (BRICK_WIDTH * 2.f);
+			float start_x = (target_x < screen_center_x) ? -BRICK_WIDTH * 2.f : WINDOW_WIDTH + (BRICK_WIDTH * 2.f);
 
 			if (brick->active == false) {
 				*brick = (Entity){ 0 };
 				brick->active = true;
 
-				brick->position = (Vector2){ start_x, target_y };
+				brick->body.position = (Vector2){ start_x, target_y };
 
-				brick->size = (Vector2){ BRICK_WIDTH, BRICK_HEIGHT };
-				brick->rotation = 0;
+				brick->body.size = (Vector2){ BRICK_WIDTH, BRICK_HEIGHT };
+				brick->body.rotation = 0;
 
-				brick->tint = WHITE;
-				// brick->area = (Rectangle){ .x = 0, .y = TILE_SIZE * 4, .width = TILE_SIZE, .height = TILE_SIZE * 4 };
-				// brick->texture = encounter->paddle_texture;
+				brick->sprite.tint = WHITE;
+				// brick->sprite.area = (Rectangle){ .x = 0, .y = TILE_SIZE * 4, .width = TILE_SIZE, .height = TILE_SIZE * 4 };
+				// brick->sprite.texture = encounter->paddle_texture;
 
-				brick->collision_active = true;
-				brick->collision_shape = (Rectangle){ 0, 0, brick->size.x, brick->size.y };
+				brick->body.collision_active = true;
+				brick->body.collision_shape = (Rectangle){ 0, 0, brick->body.size.x, brick->body.size.y };
 			}
 
-			brick->position.x = start_x + (target_x - start_x) * ease;
+			brick->body.position.x = start_x + (target_x - start_x) * ease;
 			entity_sync_collision(brick);
 		}
 	}
@@ -704,7 +704,7 @@ void paddle_breakout_enter(void *context) {
 
 	float total_width = (2 * ball_radius) + ((2 - 1) * ball_spacing);
 
-	float screen_center = GetScreenWidth() / 2.0f;
+	float screen_center = WINDOW_WIDTH / 2.0f;
 	float row_start_x = screen_center - (total_width / 2.0f);
 
 	for (uint32_t ball_index = 0; ball_index < countof(encounter->balls); ++ball_index) {
@@ -712,7 +712,7 @@ void paddle_breakout_enter(void *context) {
 
 		float target_x = row_start_x + (ball_index * (ball_radius + ball_spacing)) + (ball_radius / 2.0f);
 		ball->position.x = target_x;
-		ball->position.y = GetScreenHeight() / 2.f;
+		ball->position.y = WINDOW_HEIGHT / 2.f;
 
 		float x_sign = ball_index - .5f;
 		float y_sign = -.5f;
@@ -722,9 +722,9 @@ void paddle_breakout_enter(void *context) {
 		ball->active = true;
 	}
 
-	float width = encounter->survivor->entity.collision_shape.height;
-	float height = encounter->survivor->entity.collision_shape.width;
-	encounter->survivor->entity.collision_shape = (Rectangle){ 0, 0, width, height };
+	float width = encounter->survivor->entity.body.collision_shape.height;
+	float height = encounter->survivor->entity.body.collision_shape.width;
+	encounter->survivor->entity.body.collision_shape = (Rectangle){ 0, 0, width, height };
 	entity_sync_collision(&encounter->survivor->entity);
 }
 
@@ -741,16 +741,16 @@ StateID paddle_breakout_update(void *context, float dt) {
 			if (ball->position.x - ball->radius < 0) {
 				ball->position.x = ball->radius;
 				ball->velocity.x *= -1;
-			} else if (ball->position.x + ball->radius > GetScreenWidth()) {
-				ball->position.x = GetScreenWidth() - ball->radius;
+			} else if (ball->position.x + ball->radius > WINDOW_WIDTH) {
+				ball->position.x = WINDOW_WIDTH - ball->radius;
 				ball->velocity.x *= -1;
 			}
 
 			if (ball->position.y - ball->radius < 0) {
 				ball->position.y = ball->radius;
 				ball->velocity.y *= -1;
-			} else if (ball->position.y + ball->radius > GetScreenHeight()) {
-				ball->position.y = GetScreenHeight() - ball->radius;
+			} else if (ball->position.y + ball->radius > WINDOW_HEIGHT) {
+				ball->position.y = WINDOW_HEIGHT - ball->radius;
 				ball->velocity.y *= -1;
 			}
 
@@ -761,23 +761,23 @@ StateID paddle_breakout_update(void *context, float dt) {
 				if (!brick->active)
 					continue;
 
-				if (CheckCollisionCircleRec(ball->position, ball->radius, brick->collision_shape)) {
-					float dx = ball->position.x - brick->position.x;
-					float dy = ball->position.y - brick->position.y;
+				if (CheckCollisionCircleRec(ball->position, ball->radius, brick->body.collision_shape)) {
+					float dx = ball->position.x - brick->body.position.x;
+					float dy = ball->position.y - brick->body.position.y;
 
 					float abs_dx = fabsf(dx);
 					float abs_dy = fabsf(dy);
 
-					float half_w = brick->collision_shape.width * 0.5f;
-					float half_h = brick->collision_shape.height * 0.5f;
+					float half_w = brick->body.collision_shape.width * 0.5f;
+					float half_h = brick->body.collision_shape.height * 0.5f;
 
 					if (abs_dx > abs_dy) {
 						ball->velocity.x *= -1;
-						ball->position.x = brick->position.x +
+						ball->position.x = brick->body.position.x +
 							(dx > 0 ? half_w + ball->radius : -half_w - ball->radius);
 					} else {
 						ball->velocity.y *= -1;
-						ball->position.y = brick->position.y +
+						ball->position.y = brick->body.position.y +
 							(dy > 0 ? half_h + ball->radius : -half_h - ball->radius);
 					}
 				}
@@ -788,7 +788,7 @@ StateID paddle_breakout_update(void *context, float dt) {
 	Paddle *survivor = encounter->survivor;
 
 	if (survivor->entity.active) {
-		float half_w = survivor->entity.size.x * 0.5f;
+		float half_w = survivor->entity.body.size.x * 0.5f;
 
 		Ball *target = &encounter->balls[0];
 		for (uint32_t index = 1; index < countof(encounter->balls); ++index) {
@@ -804,7 +804,7 @@ StateID paddle_breakout_update(void *context, float dt) {
 		needed_offset_x = Clamp(needed_offset_x, -1.0f, 1.0f);
 		float target_paddle_x = target->position.x - (needed_offset_x * half_w);
 
-		float dist = target_paddle_x - survivor->entity.position.x;
+		float dist = target_paddle_x - survivor->entity.body.position.x;
 		float move = 0.0f;
 
 		if (fabsf(dist) > 5.0f) {
@@ -815,19 +815,19 @@ StateID paddle_breakout_update(void *context, float dt) {
 				move = dist;
 		}
 
-		survivor->entity.position.x += move;
+		survivor->entity.body.position.x += move;
 
-		if (survivor->entity.position.x < half_w)
-			survivor->entity.position.x = half_w;
-		if (survivor->entity.position.x > GetScreenWidth() - half_w)
-			survivor->entity.position.x = GetScreenWidth() - half_w;
+		if (survivor->entity.body.position.x < half_w)
+			survivor->entity.body.position.x = half_w;
+		if (survivor->entity.body.position.x > WINDOW_WIDTH - half_w)
+			survivor->entity.body.position.x = WINDOW_WIDTH - half_w;
 
 		entity_sync_collision(&survivor->entity);
 
-		if (CheckCollisionCircleRec(target->position, target->radius, survivor->entity.collision_shape)) {
-			float offset_x = (target->position.x - survivor->entity.position.x) / half_w;
+		if (CheckCollisionCircleRec(target->position, target->radius, survivor->entity.body.collision_shape)) {
+			float offset_x = (target->position.x - survivor->entity.body.position.x) / half_w;
 
-			LOG_INFO("Survivor.hit_offset_x = %.2f", offset_x);
+			LOG_CAT_LIMIT(LOG_CATEGORY_BOSS, LOG_LEVEL_INFO, 4, "Survivor.hit_offset_x = %.2f", offset_x);
 			offset_x = clamp(offset_x, -1.0f, 1.0f);
 
 			float current_speed = Vector2Length(target->velocity);
@@ -842,19 +842,19 @@ StateID paddle_breakout_update(void *context, float dt) {
 			target->velocity = Vector2Scale(Vector2Normalize(target->velocity), current_speed);
 
 			// audio_sfx_play(SFX_PADDLE_HURT, 1.0f, true); // Or hit sound
-			// target->position.y = survivor->entity.position.y + survivor->entity.size.y * 0.5f + target->radius + 1.0f;
+			// target->position.y = survivor->entity.body.position.y + survivor->entity.body.size.y * 0.5f + target->radius + 1.0f;
 		}
 	}
 
-	for (uint32_t projectile_index = 0; projectile_index < BRICK_MAX_PROJECTILES; ++projectile_index) {
-		Entity *projectile = &encounter->projectiles[projectile_index];
+	static const EntityMotion projectile_motion = { .velocity_scale = 1.0f, .drag = 1.0f };
+	entity_bodies_integrate(encounter->projectiles.bodies, encounter->projectiles.store.count, &projectile_motion);
 
-		entity_update_physics(projectile, 1.0f, dt);
-		entity_sync_collision(projectile);
+	for (uint32_t projectile_index = encounter->projectiles.store.count; projectile_index-- > 0;) {
+		EntityBody *projectile = &encounter->projectiles.bodies[projectile_index];
 
-		if ((projectile->position.x < -50 || projectile->position.x > GetScreenWidth() + 50) ||
-			projectile->position.y < -50 || projectile->position.y > GetScreenHeight() + 50)
-			projectile->active = false;
+		if ((projectile->position.x < -50 || projectile->position.x > WINDOW_WIDTH + 50) ||
+			projectile->position.y < -50 || projectile->position.y > WINDOW_HEIGHT + 50)
+			entity_store_destroy_at(&encounter->projectiles.store, projectile_index);
 	}
 
 	return STATE_CHANGE_NONE;
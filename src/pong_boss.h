@@ -2,8 +2,10 @@
 
 #include "common.h"
 
-#include "fsm.h"
+#include "core/entity_store.h"
+#include "core/random.h"
 #include "entity.h"
+#include "fsm.h"
 #include "globals.h"
 #include <raylib.h>
 
@@ -54,18 +56,22 @@ typedef struct {
 	Paddle *survivor;
 
 	Entity bricks[MAX_BRICKS];
-	Entity projectiles[BRICK_MAX_PROJECTILES];
+	struct {
+		ENTITY_STORE_STORAGE(BRICK_MAX_PROJECTILES);
+		EntityBody bodies[BRICK_MAX_PROJECTILES];
+	} projectiles;
 
 	FSM state_machine;
 	ScenarioConfig active_scenario;
 	Vector2 player_position;
 
 	Texture *paddle_texture;
+	Rng rng;
 
 	Ball balls[2];
 } PaddleEncounter;
 
-bool32 boss_encounter_paddle_initialize(PaddleEncounter *encounter, Texture *texture);
+bool32 boss_encounter_paddle_initialize(PaddleEncounter *encounter, Texture *texture, Rng rng);
 void boss_encounter_paddle_update(PaddleEncounter *boss, Vector2 player_position, float dt);
 void boss_encounter_paddle_draw(PaddleEncounter *encounter, bool32 show_debug);
 
@@ -0,0 +1,229 @@
+#include "replay.h"
+#include "core/logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+static void write_u16(FILE *file, uint16_t value) {
+	uint8_t bytes[2] = { (uint8_t)value, (uint8_t)(value >> 8) };
+	fwrite(bytes, sizeof(bytes), 1, file);
+}
+
+static void write_u32(FILE *file, uint32_t value) {
+	uint8_t bytes[4] = { (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24) };
+	fwrite(bytes, sizeof(bytes), 1, file);
+}
+
+static void write_varint(FILE *file, uint32_t value) {
+	while (value >= 0x80) {
+		fputc((int)((value & 0x7F) | 0x80), file);
+		value >>= 7;
+	}
+	fputc((int)value, file);
+}
+
+static uint32_t float_bits(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static bool32 tick_equal(const ReplayTick *a, const ReplayTick *b) {
+	return a->input.down == b->input.down && a->input.pressed == b->input.pressed && float_bits(a->dt) == float_bits(b->dt);
+}
+
+static void recorder_flush(ReplayRecorder *recorder) {
+	if (recorder->pending_count == 0)
+		return;
+
+	const ReplayTick *tick = &recorder->pending, *previous = &recorder->written;
+	uint8_t fields = 0;
+	if (tick->input.down != previous->input.down)
+		fields |= REPLAY_FIELD_DOWN;
+	if (tick->input.pressed != previous->input.pressed)
+		fields |= REPLAY_FIELD_PRESSED;
+	if (float_bits(tick->dt) != float_bits(previous->dt))
+		fields |= REPLAY_FIELD_DT;
+
+	fputc(fields, recorder->file);
+	if (fields & REPLAY_FIELD_DOWN)
+		write_u16(recorder->file, tick->input.down);
+	if (fields & REPLAY_FIELD_PRESSED)
+		write_u16(recorder->file, tick->input.pressed);
+	if (fields & REPLAY_FIELD_DT)
+		write_u32(recorder->file, float_bits(tick->dt));
+	write_varint(recorder->file, recorder->pending_count);
+
+	recorder->written = *tick;
+	recorder->pending_count = 0;
+}
+
+bool32 replay_recorder_open(ReplayRecorder *recorder, const char *path, uint64_t seed) {
+	*recorder = (ReplayRecorder){ 0 };
+
+	recorder->file = fopen(path, "wb");
+	if (recorder->file == NULL) {
+		LOG_WARN("Replay: failed to open '%s' for recording", path);
+		return false;
+	}
+
+	recorder->seed = seed;
+	write_u32(recorder->file, REPLAY_MAGIC);
+	write_u32(recorder->file, REPLAY_VERSION);
+	write_u32(recorder->file, (uint32_t)seed);
+	write_u32(recorder->file, (uint32_t)(seed >> 32));
+	write_u32(recorder->file, 0);
+	write_u32(recorder->file, 0);
+
+	return true;
+}
+
+void replay_recorder_push(ReplayRecorder *recorder, const ReplayTick *tick) {
+	if (recorder->file == NULL)
+		return;
+
+	if (recorder->pending_count > 0 && tick_equal(&recorder->pending, tick) == false)
+		recorder_flush(recorder);
+
+	recorder->pending = *tick;
+	recorder->pending_count++;
+	recorder->tick_count++;
+}
+
+void replay_recorder_close(ReplayRecorder *recorder) {
+	if (recorder->file == NULL)
+		return;
+
+	recorder_flush(recorder);
+	fseek(recorder->file, REPLAY_TICK_COUNT_OFFSET, SEEK_SET);
+	write_u32(recorder->file, recorder->tick_count);
+	fclose(recorder->file);
+
+	LOG_INFO("Replay: recorded %u ticks", recorder->tick_count);
+	recorder->file = NULL;
+}
+
+static uint32_t read_u32(const uint8_t *bytes) {
+	return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static bool32 read_bytes(Replay *replay, uint8_t *out, usize count) {
+	if (replay->size - replay->cursor < count)
+		return false;
+
+	memcpy(out, replay->data + replay->cursor, count);
+	replay->cursor += count;
+	return true;
+}
+
+static bool32 read_varint(Replay *replay, uint32_t *value) {
+	*value = 0;
+	for (uint32_t shift = 0; shift < 35; shift += 7) {
+		uint8_t byte;
+		if (read_bytes(replay, &byte, 1) == false)
+			return false;
+
+		*value |= (uint32_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+bool32 replay_load(Replay *replay, const char *path) {
+	*replay = (Replay){ 0 };
+
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		LOG_WARN("Replay: failed to open '%s'", path);
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	if (size < REPLAY_HEADER_SIZE) {
+		LOG_WARN("Replay: '%s' is too small to be a replay", path);
+		fclose(file);
+		return false;
+	}
+
+	replay->data = malloc((usize)size);
+	replay->size = (usize)size;
+	if (replay->data == NULL || fread(replay->data, 1, replay->size, file) != replay->size) {
+		LOG_WARN("Replay: failed to read '%s'", path);
+		fclose(file);
+		replay_unload(replay);
+		return false;
+	}
+	fclose(file);
+
+	if (read_u32(replay->data) != REPLAY_MAGIC || read_u32(replay->data + 4) != REPLAY_VERSION) {
+		LOG_WARN("Replay: '%s' has an unknown header", path);
+		replay_unload(replay);
+		return false;
+	}
+
+	replay->seed = (uint64_t)read_u32(replay->data + 8) | ((uint64_t)read_u32(replay->data + 12) << 32);
+	replay->tick_count = read_u32(replay->data + REPLAY_TICK_COUNT_OFFSET);
+	replay_rewind(replay);
+
+	LOG_INFO("Replay: loaded '%s', %u ticks, seed %llu", path, replay->tick_count, (unsigned long long)replay->seed);
+	return true;
+}
+
+void replay_unload(Replay *replay) {
+	free(replay->data);
+	*replay = (Replay){ 0 };
+}
+
+void replay_rewind(Replay *replay) {
+	replay->cursor = REPLAY_HEADER_SIZE;
+	replay->tick_index = 0;
+	replay->current = (ReplayTick){ 0 };
+	replay->run_remaining = 0;
+}
+
+static bool32 read_run(Replay *replay) {
+	uint8_t fields, bytes[4];
+	if (read_bytes(replay, &fields, 1) == false)
+		return false;
+
+	if (fields & REPLAY_FIELD_DOWN) {
+		if (read_bytes(replay, bytes, 2) == false)
+			return false;
+		replay->current.input.down = (uint16_t)(bytes[0] | (bytes[1] << 8));
+	}
+	if (fields & REPLAY_FIELD_PRESSED) {
+		if (read_bytes(replay, bytes, 2) == false)
+			return false;
+		replay->current.input.pressed = (uint16_t)(bytes[0] | (bytes[1] << 8));
+	}
+	if (fields & REPLAY_FIELD_DT) {
+		if (read_bytes(replay, bytes, 4) == false)
+			return false;
+		uint32_t bits = read_u32(bytes);
+		memcpy(&replay->current.dt, &bits, sizeof(bits));
+	}
+
+	return read_varint(replay, &replay->run_remaining) && replay->run_remaining > 0;
+}
+
+bool32 replay_next(Replay *replay, ReplayTick *tick) {
+	if (replay->tick_index >= replay->tick_count)
+		return false;
+
+	if (replay->run_remaining == 0 && read_run(replay) == false) {
+		LOG_WARN("Replay: stream is corrupt at tick %u", replay->tick_index);
+		replay->tick_index = replay->tick_count;
+		return false;
+	}
+
+	*tick = replay->current;
+	replay->run_remaining--;
+	replay->tick_index++;
+	return true;
+}
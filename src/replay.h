@@ -0,0 +1,63 @@
+#pragma once
+
+#include "common.h"
+#include "input.h"
+
+#include <stdio.h>
+
+// Replay file: a header followed by runs of identical ticks. Each run is a
+// field mask, the fields that changed since the previous run and a varint
+// repeat count, so holding a key for a second costs a few bytes.
+#define REPLAY_MAGIC 0x4C505241u // "ARPL"
+#define REPLAY_VERSION 1u
+
+typedef enum {
+	REPLAY_FIELD_DOWN = 1 << 0,
+	REPLAY_FIELD_PRESSED = 1 << 1,
+	REPLAY_FIELD_DT = 1 << 2,
+} ReplayField;
+
+// HEADER: magic u32, version u32, seed u64, tick_count u32, reserved u32
+// RUN:     fields u8, [down u16], [pressed u16], [dt f32], count varint
+// All little endian, a field missing from a run keeps its previous value.
+#define REPLAY_HEADER_SIZE 24
+#define REPLAY_TICK_COUNT_OFFSET 16
+
+// Everything world_update consumes in one tick
+typedef struct {
+	InputState input;
+	float dt;
+} ReplayTick;
+
+typedef struct {
+	FILE *file;
+	uint64_t seed;
+	uint32_t tick_count;
+
+	// Run being accumulated and the last one written, fields are diffed against it
+	ReplayTick pending, written;
+	uint32_t pending_count;
+} ReplayRecorder;
+
+bool32 replay_recorder_open(ReplayRecorder *recorder, const char *path, uint64_t seed);
+void replay_recorder_push(ReplayRecorder *recorder, const ReplayTick *tick);
+// Flushes the last run and patches the tick count into the header
+void replay_recorder_close(ReplayRecorder *recorder);
+
+typedef struct {
+	uint8_t *data;
+	usize size, cursor;
+
+	uint64_t seed;
+	uint32_t tick_count, tick_index;
+
+	ReplayTick current;
+	uint32_t run_remaining;
+} Replay;
+
+bool32 replay_load(Replay *replay, const char *path);
+void replay_unload(Replay *replay);
+
+// Returns false once every tick has been consumed or the stream is corrupt
+bool32 replay_next(Replay *replay, ReplayTick *tick);
+void replay_rewind(Replay *replay);
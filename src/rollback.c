@@ -0,0 +1,193 @@
+#include "rollback.h"
+#include "audio_manager.h"
+#include "core/clock.h"
+#include "core/logger.h"
+
+#define ROLLBACK_PACKET_MAGIC 0x4B424C52u // "RLBK"
+// magic u32, first_tick u32, ack u32, count u16, then count * (down u16, pressed u16)
+#define ROLLBACK_PACKET_HEADER 14
+
+STATIC_ASSERT(ROLLBACK_SNAPSHOTS > ROLLBACK_MAX_TICKS);
+STATIC_ASSERT(ROLLBACK_INPUT_RING >= ROLLBACK_MAX_TICKS + ROLLBACK_MAX_INPUT_DELAY + ROLLBACK_PACKET_INPUTS);
+STATIC_ASSERT(ROLLBACK_PACKET_HEADER + ROLLBACK_PACKET_INPUTS * 4 <= NET_PACKET_MAX);
+
+static void put_u16(uint8_t *bytes, uint16_t value) {
+	bytes[0] = (uint8_t)value;
+	bytes[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u32(uint8_t *bytes, uint32_t value) {
+	put_u16(bytes, (uint16_t)value);
+	put_u16(bytes + 2, (uint16_t)(value >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *bytes) {
+	return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *bytes) {
+	return get_u16(bytes) | ((uint32_t)get_u16(bytes + 2) << 16);
+}
+
+static InputState *input_at(RollbackSession *session, uint32_t player, uint32_t tick) {
+	return &session->inputs[player][tick % ROLLBACK_INPUT_RING];
+}
+
+// Keeps holding whatever the peer last held, a press is never repeated
+static InputState predict_remote(RollbackSession *session) {
+	if (session->remote_ticks == 0)
+		return (InputState){ 0 };
+
+	InputState last = *input_at(session, session->remote_player, session->remote_ticks - 1);
+	return (InputState){ .down = last.down };
+}
+
+static void simulate(RollbackSession *session, uint32_t tick) {
+	InputState inputs[WORLD_MAX_PLAYERS] = { 0 };
+	inputs[session->local_player] = *input_at(session, session->local_player, tick);
+	inputs[session->remote_player] = *input_at(session, session->remote_player, tick);
+
+	world_snapshot_save(session->world, &session->snapshots[tick % ROLLBACK_SNAPSHOTS]);
+	session->music_requested[tick % ROLLBACK_SNAPSHOTS] = audio_music_requested();
+	world_update(session->world, inputs, ROLLBACK_TICK_DT);
+}
+
+static void send_inputs(RollbackSession *session, uint64_t now_ns) {
+	uint32_t first = max(session->peer_ack, session->local_ticks > ROLLBACK_PACKET_INPUTS ? session->local_ticks - ROLLBACK_PACKET_INPUTS : 0);
+	uint32_t count = session->local_ticks - first;
+
+	uint8_t packet[ROLLBACK_PACKET_HEADER + ROLLBACK_PACKET_INPUTS * 4];
+	put_u32(packet, ROLLBACK_PACKET_MAGIC);
+	put_u32(packet + 4, first);
+	put_u32(packet + 8, session->remote_ticks);
+	put_u16(packet + 12, (uint16_t)count);
+
+	for (uint32_t index = 0; index < count; index++) {
+		InputState *input = input_at(session, session->local_player, first + index);
+		put_u16(packet + ROLLBACK_PACKET_HEADER + index * 4, input->down);
+		put_u16(packet + ROLLBACK_PACKET_HEADER + index * 4 + 2, input->pressed);
+	}
+
+	net_link_send(session->link, packet, ROLLBACK_PACKET_HEADER + count * 4, now_ns);
+}
+
+// Inputs are only accepted in order, redundancy in later packets fills any gap
+static void receive_inputs(RollbackSession *session, uint64_t now_ns) {
+	uint8_t packet[NET_PACKET_MAX];
+	uint32_t size;
+
+	while ((size = net_link_receive(session->link, packet, sizeof(packet), now_ns)) != 0) {
+		if (size < ROLLBACK_PACKET_HEADER || get_u32(packet) != ROLLBACK_PACKET_MAGIC)
+			continue;
+
+		uint32_t first = get_u32(packet + 4);
+		uint32_t ack = get_u32(packet + 8);
+		uint32_t count = get_u16(packet + 12);
+		if (count > ROLLBACK_PACKET_INPUTS || size < ROLLBACK_PACKET_HEADER + count * 4)
+			continue;
+
+		session->peer_ack = max(session->peer_ack, min(ack, session->local_ticks));
+
+		for (uint32_t index = 0; index < count; index++) {
+			uint32_t tick = first + index;
+			if (tick != session->remote_ticks)
+				continue;
+
+			InputState input = {
+				.down = get_u16(packet + ROLLBACK_PACKET_HEADER + index * 4),
+				.pressed = get_u16(packet + ROLLBACK_PACKET_HEADER + index * 4 + 2),
+			};
+
+			InputState *slot = input_at(session, session->remote_player, tick);
+			if (tick < session->tick && (slot->down != input.down || slot->pressed != input.pressed))
+				session->mispredicted_tick = min(session->mispredicted_tick, tick);
+
+			*slot = input;
+			session->remote_ticks++;
+		}
+	}
+}
+
+static void resimulate(RollbackSession *session) {
+	uint32_t from = session->mispredicted_tick;
+	session->mispredicted_tick = INVALID_INDEX;
+	if (from >= session->tick)
+		return;
+
+	uint64_t start = clock_now_ns();
+	world_snapshot_restore(session->world, &session->snapshots[from % ROLLBACK_SNAPSHOTS]);
+
+	// Effects already played when these ticks first ran. Music follows the corrected
+	// history once it is resimulated, whatever the mispredicted ticks asked for is undone
+	audio_sfx_set_muted(true);
+	audio_music_set_suppressed(true);
+	audio_music_set_requested(session->music_requested[from % ROLLBACK_SNAPSHOTS]);
+	for (uint32_t tick = from; tick < session->tick; tick++) {
+		if (tick >= session->remote_ticks)
+			*input_at(session, session->remote_player, tick) = predict_remote(session);
+		simulate(session, tick);
+	}
+	audio_music_set_suppressed(false);
+	audio_sfx_set_muted(false);
+
+	uint32_t depth = session->tick - from;
+	uint64_t elapsed = clock_now_ns() - start;
+
+	RollbackStats *stats = &session->stats;
+	stats->rollbacks++;
+	stats->resimulated_ticks += depth;
+	stats->deepest_rollback = max(stats->deepest_rollback, depth);
+	stats->resimulation_ns += elapsed;
+	stats->frame_resimulation_ns = elapsed;
+	stats->worst_frame_resimulation_ns = max(stats->worst_frame_resimulation_ns, elapsed);
+}
+
+void rollback_session_init(RollbackSession *session, GameWorld *world, NetLink *link, uint32_t local_player, uint32_t input_delay) {
+	*session = (RollbackSession){
+		.world = world,
+		.link = link,
+		.local_player = local_player,
+		.remote_player = local_player ^ 1,
+		.input_delay = min(input_delay, ROLLBACK_MAX_INPUT_DELAY),
+		.mispredicted_tick = INVALID_INDEX,
+	};
+
+	// Ticks inside the delay window have no local input yet, they are empty on both peers
+	session->local_ticks = session->input_delay;
+}
+
+void rollback_poll(RollbackSession *session, uint64_t now_ns) {
+	session->stats.frame_resimulation_ns = 0;
+	receive_inputs(session, now_ns);
+	resimulate(session);
+	send_inputs(session, now_ns);
+}
+
+bool32 rollback_advance(RollbackSession *session, InputState local, uint64_t now_ns) {
+	session->stats.frame_resimulation_ns = 0;
+	receive_inputs(session, now_ns);
+	resimulate(session);
+
+	if (session->tick >= session->remote_ticks + ROLLBACK_MAX_TICKS) {
+		session->stats.stalls++;
+		send_inputs(session, now_ns);
+		return false;
+	}
+
+	uint32_t tick = session->tick;
+	*input_at(session, session->local_player, tick + session->input_delay) = local;
+	session->local_ticks = tick + session->input_delay + 1;
+
+	if (tick >= session->remote_ticks)
+		*input_at(session, session->remote_player, tick) = predict_remote(session);
+
+	simulate(session, tick);
+	session->tick++;
+
+	send_inputs(session, now_ns);
+	return true;
+}
+
+bool32 rollback_settled(const RollbackSession *session) {
+	return session->remote_ticks >= session->tick && session->mispredicted_tick == INVALID_INDEX;
+}
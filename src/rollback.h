@@ -0,0 +1,64 @@
+#pragma once
+
+#include "common.h"
+#include "input.h"
+#include "net.h"
+#include "world.h"
+#include "world_snapshot.h"
+
+// Two-player rollback over a NetLink. Peers exchange inputs only, every tick
+// runs immediately on a predicted remote input, and a late input that differs
+// rewinds to the snapshot before it and resimulates up to the present.
+// Ticks leave the world's frame arenas alone, the caller swaps them once per frame.
+#define ROLLBACK_TICK_DT (1.0f / 60.0f)
+// Furthest the simulation may run past the last confirmed remote input before stalling
+#define ROLLBACK_MAX_TICKS 14
+#define ROLLBACK_SNAPSHOTS 16
+#define ROLLBACK_INPUT_RING 64
+// Inputs resent per packet, covers that many lost packets in a row
+#define ROLLBACK_PACKET_INPUTS 32
+#define ROLLBACK_MAX_INPUT_DELAY 4
+
+typedef struct {
+	uint32_t rollbacks, stalls;
+	uint32_t resimulated_ticks, deepest_rollback;
+
+	// Time spent resimulating, the frame figure is the latest call only
+	uint64_t resimulation_ns, frame_resimulation_ns, worst_frame_resimulation_ns;
+} RollbackStats;
+
+typedef struct {
+	GameWorld *world;
+	NetLink *link;
+	uint32_t local_player, remote_player;
+	uint32_t input_delay;
+
+	// Next tick to simulate
+	uint32_t tick;
+	// Local inputs exist for ticks below local_ticks, remote ones are confirmed below remote_ticks
+	uint32_t local_ticks, remote_ticks;
+	// How many of our ticks the peer has confirmed
+	uint32_t peer_ack;
+	// Earliest simulated tick whose remote input turned out wrong, INVALID_INDEX when none
+	uint32_t mispredicted_tick;
+
+	InputState inputs[WORLD_MAX_PLAYERS][ROLLBACK_INPUT_RING];
+	// State before each of the most recent ticks ran
+	WorldSnapshot snapshots[ROLLBACK_SNAPSHOTS];
+	// Music requested before each of those ticks, the audio singleton is not part of a snapshot
+	uint32_t music_requested[ROLLBACK_SNAPSHOTS];
+
+	RollbackStats stats;
+} RollbackSession;
+
+// The world must already hold two players, both peers need the same seed
+void rollback_session_init(RollbackSession *session, GameWorld *world, NetLink *link, uint32_t local_player, uint32_t input_delay);
+
+// Receives, rolls back if needed and simulates one tick with `local` as this peer's input.
+// Returns false when stalled waiting for the remote peer.
+bool32 rollback_advance(RollbackSession *session, InputState local, uint64_t now_ns);
+// Receives and rolls back without simulating a new tick
+void rollback_poll(RollbackSession *session, uint64_t now_ns);
+
+// Every simulated tick ran on confirmed inputs
+bool32 rollback_settled(const RollbackSession *session);
@@ -1,49 +1,55 @@
 #include "weapon.h"
 #include "audio_manager.h"
 #include "entity.h"
+#include "entity_physics.h"
 #include "globals.h"
 #include <raylib.h>
 
+static const EntityMotion bullet_motion = {
+	.velocity_scale = 1.0f,
+	.drag = 1.0f,
+	.wrap = true,
+	.wrap_margin = .5f,
+	.bounds = { WINDOW_WIDTH, WINDOW_HEIGHT },
+};
+
 bool32 weapon_system_init(BulletSystem *system, Texture *texture) {
 	*system = (BulletSystem){ 0 };
 
 	system->base_damage = 1.4f;
 	system->texture = texture;
 
-	for (int bullet_index = 0; bullet_index < MAX_BULLETS; bullet_index++)
-		system->bullets[bullet_index].entity.active = false;
+	entity_store_init(&system->store, system->slots, system->handles, MAX_BULLETS);
+	entity_store_add_column(&system->store, system->bodies, sizeof(*system->bodies));
+	entity_store_add_column(&system->store, system->sprites, sizeof(*system->sprites));
+	entity_store_add_column(&system->store, system->bullets, sizeof(*system->bullets));
 
 	return true;
 }
 
 bool32 weapon_bullet_spawn(BulletSystem *system, Vector2 spawn_position, float rotation, Vector2 direction, float speed, float damage_multiplier) {
-	Bullet *bullet = NULL;
-
-	for (int bullet_index = 0; bullet_index < MAX_BULLETS; bullet_index++) {
-		if (system->bullets[bullet_index].entity.active == false) {
-			bullet = &system->bullets[bullet_index];
-			break;
-		}
-	}
+	if (entity_store_create(&system->store) != ENTITY_HANDLE_NULL) {
+		uint32_t index = system->store.count - 1;
+		Vector2 size = { 16.f, 32.f };
 
-	if (bullet) {
-		bullet->entity = (Entity){
-			.active = true,
+		system->bodies[index] = (EntityBody){
 			.position = spawn_position,
 			.velocity = Vector2Scale(direction, speed),
 			.rotation = rotation,
+			.size = size,
+			.collision_active = true,
+			.collision_shape = { 0, 0, size.x, size.y },
+		};
+		system->sprites[index] = (EntitySprite){
 			.texture = system->texture,
 			.area = { TILE_SIZE * 5, TILE_SIZE * 4, TILE_SIZE, TILE_SIZE },
-			.size = { 16.f, 32.f },
 			.tint = ORANGE,
 		};
 
+		Bullet *bullet = &system->bullets[index];
 		bullet->damage = system->base_damage * damage_multiplier;
 		bullet->life_timer = 1.0f;
 
-		bullet->entity.collision_active = true;
-		bullet->entity.collision_shape = (Rectangle){ 0, 0, bullet->entity.size.x, bullet->entity.size.y };
-
 		audio_sfx_play(SFX_PLAYER_SHOOT, 1.0f, true);
 		return true;
 	}
@@ -52,45 +58,27 @@ bool32 weapon_bullet_spawn(BulletSystem *system, Vector2 spawn_position, float r
 }
 
 void weapon_bullets_update(BulletSystem *sys, float dt) {
-	for (int i = 0; i < MAX_BULLETS; i++) {
-		Bullet *b = &sys->bullets[i];
-		if (!b->entity.active)
-			continue;
-
-		entity_update_physics(&b->entity, 1.0f, dt);
-
-		b->life_timer -= dt;
-		if (b->life_timer <= 0.0f) {
-			b->entity.active = false;
-			continue;
-		}
+	// Backwards so expired bullets can be swap-removed in place
+	for (uint32_t i = sys->store.count; i-- > 0;) {
+		sys->bullets[i].life_timer -= dt;
+		if (sys->bullets[i].life_timer <= 0.0f)
+			entity_store_destroy_at(&sys->store, i);
+	}
 
-		float half_w = b->entity.size.x * .5f;
-		float half_h = b->entity.size.y * .5f;
+	entity_bodies_integrate(sys->bodies, sys->store.count, &bullet_motion);
+}
 
-		if (b->entity.position.x < -half_w)
-			b->entity.position.x = WINDOW_WIDTH + half_w;
-		else if (b->entity.position.x > WINDOW_WIDTH + half_w)
-			b->entity.position.x = -half_w;
+void weapon_bullets_draw(BulletSystem *weapon_system, bool show_debug) {
+	entity_bodies_draw(weapon_system->bodies, weapon_system->sprites, weapon_system->store.count);
 
-		if (b->entity.position.y < -half_h)
-			b->entity.position.y = WINDOW_HEIGHT + half_h;
-		else if (b->entity.position.y > WINDOW_HEIGHT + half_h)
-			b->entity.position.y = -half_h;
+	if (show_debug == false)
+		return;
 
-		entity_sync_collision(&b->entity);
-	}
-}
+	for (uint32_t bullet_index = 0; bullet_index < weapon_system->store.count; bullet_index++) {
+		EntityBody *body = &weapon_system->bodies[bullet_index];
 
-void weapon_bullets_draw(BulletSystem *weapon_system, bool show_debug) {
-	for (int bullet_index = 0; bullet_index < MAX_BULLETS; bullet_index++) {
-		Bullet *bullet = &weapon_system->bullets[bullet_index];
-		if (bullet->entity.active) {
-			entity_draw(&bullet->entity);
-
-			if (show_debug && bullet->entity.collision_active) {
-				DrawRectangleLinesEx(bullet->entity.collision_shape, 1.0f, GREEN);
-			}
+		if (body->collision_active) {
+			DrawRectangleLinesEx(body->collision_shape, 1.0f, GREEN);
 		}
 	}
 }
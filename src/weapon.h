@@ -1,23 +1,24 @@
 #pragma once
 
+#include "core/entity_store.h"
 #include "entity.h"
 #include "globals.h"
 
+// Gameplay state, body and sprite live in their own columns
 typedef struct {
-	Entity entity;
-
 	float speed;
 	float damage;
 	float life_timer;
 } Bullet;
 
 typedef struct {
+	ENTITY_STORE_STORAGE(MAX_BULLETS);
+	EntityBody bodies[MAX_BULLETS];
+	EntitySprite sprites[MAX_BULLETS];
 	Bullet bullets[MAX_BULLETS];
 
 	float base_damage;
 	Texture *texture;
-
-	int next_slot;
 } BulletSystem;
 
 bool32 weapon_system_init(BulletSystem *system, Texture *texture);
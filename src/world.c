@@ -4,10 +4,12 @@
 #include "common.h"
 #include "core/astring.h"
 #include "core/logger.h"
+#include "core/profiler.h"
 #include "fsm.h"
 #include "globals.h"
 #include "player.h"
 #include "weapon.h"
+#include "world_snapshot.h"
 #include <raylib.h>
 #include <raymath.h>
 
@@ -35,10 +37,14 @@ void game_state_lose_enter(void *context);
 StateID game_state_lose_update(void *context, float dt);
 void game_state_lose_exit(void *context);
 
-static void stars_init(Star *stars, int width, int height) {
+static void stars_init(Star *stars, Rng *rng, int width, int height) {
+	float depths[MAX_STARS];
+	rng_fill_float_range(rng, &stars[0].position.x, MAX_STARS, sizeof(*stars), 0, width);
+	rng_fill_float_range(rng, &stars[0].position.y, MAX_STARS, sizeof(*stars), 0, height);
+	rng_fill_float_range(rng, depths, MAX_STARS, sizeof(*depths), 0, 1.0f);
+
 	for (uint32_t star_index = 0; star_index < MAX_STARS; star_index++) {
-		stars[star_index].position = (Vector2){ GetRandomValue(0, width), GetRandomValue(0, height) };
-		float depth = (float)GetRandomValue(0, 100) / 100.0f;
+		float depth = depths[star_index];
 		stars[star_index].speed = clamp(depth, 15.0f, 50.0f);
 		stars[star_index].size = (depth > 0.8f) ? 3.0f : 1.0f;
 		unsigned char b = (unsigned char)(100 + (depth * 155));
@@ -46,18 +52,50 @@ static void stars_init(Star *stars, int width, int height) {
 	}
 }
 
-void world_init(GameWorld *world, Texture *atlas, Shader *white) {
+static void world_seed(GameWorld *world, uint64_t seed) {
+	world->seed = seed;
+	world->rng = rng_seed(seed, 0);
+	world->star_rng = rng_fork(&world->rng, RANDOM_STREAM_STARS);
+}
+
+static const Color player_tints[WORLD_MAX_PLAYERS] = { { 255, 255, 255, 255 }, { 102, 191, 255, 255 } };
+
+// Ships spread evenly across the middle of the screen
+static void world_players_spawn(GameWorld *world) {
+	for (uint32_t player_index = 0; player_index < world->player_count; player_index++) {
+		Player *player = &world->players[player_index];
+		player_init(player, world->atlas);
+		player->entity.body.position.x = WINDOW_WIDTH * (player_index + 1.0f) / (world->player_count + 1.0f);
+		player->entity.sprite.tint = player_tints[player_index];
+	}
+}
+
+// Boss paddles chase the first ship still flying
+static Vector2 world_target_position(GameWorld *world) {
+	for (uint32_t player_index = 0; player_index < world->player_count; player_index++) {
+		if (world->players[player_index].entity.active)
+			return world->players[player_index].entity.body.position;
+	}
+
+	return world->players[0].entity.body.position;
+}
+
+void world_init(GameWorld *world, Texture *atlas, Shader *white, uint64_t seed) {
 	*world = (GameWorld){ 0 };
-	world->frame = arena_create(MiB(4));
+	world_seed(world, seed);
+	world->frames = frame_arenas_create(MiB(4));
+	world->persistent = arena_create(sizeof(WorldSnapshot) + KiB(4));
+	world->reset_point = arena_push_struct(&world->persistent, WorldSnapshot);
 	world->running = true;
     world->last_phase = GAME_PHASE_ASTEROIDS;
 
 	world->atlas = atlas;
 	world->white = white;
 
-	stars_init(world->stars, WINDOW_WIDTH, WINDOW_HEIGHT);
+	stars_init(world->stars, &world->star_rng, WINDOW_WIDTH, WINDOW_HEIGHT);
 	weapon_system_init(&world->weapon_system, atlas);
-	player_init(&world->player, atlas);
+	world->player_count = 1;
+	world_players_spawn(world);
 
 	world->bar = (Rectangle){ WINDOW_WIDTH * (1 / 6.f), 20.f, (WINDOW_WIDTH * 2) / 3.f, 25.f };
 
@@ -103,35 +141,84 @@ void world_init(GameWorld *world, Texture *atlas, Shader *white) {
 
 	world->score = 0;
 	world->high_score = 0; // TODO: Load from save file
+
+	world_snapshot_save(world, world->reset_point);
+}
+
+void world_set_player_count(GameWorld *world, uint32_t count) {
+	world->player_count = clamp(count, 1, WORLD_MAX_PLAYERS);
+	world_players_spawn(world);
+	world_snapshot_save(world, world->reset_point);
+}
+
+void world_reset(GameWorld *world, uint64_t seed) {
+	world_snapshot_restore(world, world->reset_point);
+	world_seed(world, seed);
+
+	// The reset point was taken after entering the menu, repeat what that did outside the world
+	audio_music_play(MUSIC_MENU);
+}
+
+void world_destroy(GameWorld *world) {
+	frame_arenas_destroy(&world->frames);
+	arena_destroy(&world->persistent);
+	world->reset_point = NULL;
 }
 
-void world_update(GameWorld *world, float dt) {
-	if (IsKeyPressed(KEY_TAB))
+void world_update(GameWorld *world, const InputState *inputs, float dt) {
+	world->input = (InputState){ 0 };
+	for (uint32_t player_index = 0; player_index < world->player_count; player_index++) {
+		world->input.down |= inputs[player_index].down;
+		world->input.pressed |= inputs[player_index].pressed;
+	}
+
+	const InputState *input = &world->input;
+	if (input_pressed(input, INPUT_TOGGLE_UI))
 		world->show_ui = !world->show_ui;
-	if (IsKeyPressed(KEY_C))
+	if (input_pressed(input, INPUT_TOGGLE_DEBUG))
 		world->show_debug = !world->show_debug;
-	if (IsKeyPressed(KEY_N))
+	if (input_pressed(input, INPUT_TOGGLE_COLLISIONS))
 		world->disable_collisions = !world->disable_collisions;
 
+	uint32_t zone = profiler_zone_begin("stars");
 	for (int star_index = 0; star_index < MAX_STARS; star_index++) {
 		world->stars[star_index].position.y += world->stars[star_index].speed * dt;
 		if (world->stars[star_index].position.y > WINDOW_HEIGHT) {
 			world->stars[star_index].position.y = -5;
-			world->stars[star_index].position.x = GetRandomValue(0, WINDOW_WIDTH);
+			world->stars[star_index].position.x = rng_range(&world->star_rng, 0, WINDOW_WIDTH);
 		}
 	}
 
+	profiler_zone_end(zone);
+
+	// Collision passes run inside the phase callbacks and show up as its self time
 	StateID current_state = fsm_state_get(&world->state_machine);
+	zone = profiler_zone_begin("phase");
 	fsm_update(&world->state_machine, dt);
+	profiler_zone_end(zone);
+
 	if (current_state == GAME_PHASE_ASTEROIDS || current_state == GAME_PHASE_BOSS) {
-		if (world->player.entity.active) {
-			player_update(&world->player, &world->weapon_system, dt);
-			weapon_bullets_update(&world->weapon_system, dt);
+		bool32 any_alive = false;
+		zone = profiler_zone_begin("players");
+		for (uint32_t player_index = 0; player_index < world->player_count; player_index++) {
+			Player *player = &world->players[player_index];
+			if (player->entity.active) {
+				player_update(player, &world->weapon_system, &inputs[player_index], dt);
+				any_alive = true;
+			} else
+				player->respawn_timer -= dt;
+		}
+		profiler_zone_end(zone);
 
+		if (any_alive) {
+			zone = profiler_zone_begin("bullets");
+			weapon_bullets_update(&world->weapon_system, dt);
+			profiler_zone_end(zone);
 		} else {
-			world->player.respawn_timer -= dt;
-			if (world->player.respawn_timer <= 0.0f) {
-				world_init(world, world->atlas, world->white);
+			if (world->players[0].respawn_timer <= 0.0f) {
+				// The next run is seeded from this one so a recorded session restarts the same way
+				uint64_t seed = ((uint64_t)rng_next(&world->rng) << 32) | rng_next(&world->rng);
+				world_reset(world, seed);
 			}
 		}
 	}
@@ -140,6 +227,7 @@ void world_update(GameWorld *world, float dt) {
 float gui_slider(Arena *arena, String label, float value, float min, float max, float x, float y, float width);
 
 void world_draw(GameWorld *world) {
+	Arena *frame = frame_arenas_current(&world->frames);
 	DrawRectangleGradientV(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, (Color){ 5, 5, 20, 255 }, BLACK);
 	for (int i = 0; i < MAX_STARS; i++) {
 		if (world->stars[i].size > 1.5f)
@@ -148,12 +236,13 @@ void world_draw(GameWorld *world) {
 			DrawPixelV(world->stars[i].position, world->stars[i].color);
 	}
 
-	String score = string_format(&world->frame, "%3d", world->score);
+	String score = string_format(frame, "%3d", world->score);
 	DrawText(score.data, 10, 10, 64, RAYWHITE);
 
 	StateID current_state = fsm_state_get(&world->state_machine);
 	if (current_state == GAME_PHASE_ASTEROIDS || current_state == GAME_PHASE_BOSS) {
-		player_draw(&world->player);
+		for (uint32_t player_index = 0; player_index < world->player_count; player_index++)
+			player_draw(&world->players[player_index]);
 		weapon_bullets_draw(&world->weapon_system, world->show_debug);
 		asteroid_system_draw(&world->asteroid_system, world->show_debug);
 		boss_encounter_paddle_draw(&world->boss, world->show_debug);
@@ -163,14 +252,16 @@ void world_draw(GameWorld *world) {
 			DrawRectangleRec(world->boss_health_bar, RED);
 		}
 
-		if (world->show_debug && world->player.entity.collision_active) {
-			DrawRectangleLinesEx(world->player.entity.collision_shape, 1.f, GREEN);
+		for (uint32_t player_index = 0; world->show_debug && player_index < world->player_count; player_index++) {
+			if (world->players[player_index].entity.body.collision_active)
+				DrawRectangleLinesEx(world->players[player_index].entity.body.collision_shape, 1.f, GREEN);
 		}
 
 		if (world->show_ui) {
-			world->player.rotation_speed = gui_slider(&world->frame, S("Turn Speed"), world->player.rotation_speed, 1.0f, 10.0f, 20, 50, 200);
-			world->player.acceleration = gui_slider(&world->frame, S("Engine Power"), world->player.acceleration, 0.01f, 1.0f, 20, 80, 200);
-			world->player.drag = gui_slider(&world->frame, S("Friction"), world->player.drag, 0.90f, 1.0f, 20, 110, 200);
+			Player *player = &world->players[0];
+			player->rotation_speed = gui_slider(frame, S("Turn Speed"), player->rotation_speed, 1.0f, 10.0f, 20, 50, 200);
+			player->acceleration = gui_slider(frame, S("Engine Power"), player->acceleration, 0.01f, 1.0f, 20, 80, 200);
+			player->drag = gui_slider(frame, S("Friction"), player->drag, 0.90f, 1.0f, 20, 110, 200);
 		}
 	}
 
@@ -242,10 +333,10 @@ StateID game_state_menu_update(void *context, float dt) {
 			world->screen_fade = 1.0f;
 	}
 
-	if (IsKeyPressed(KEY_ESCAPE)) {
+	if (input_pressed(&world->input, INPUT_BACK)) {
 		world->running = false;
 	}
-	if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_ENTER)) {
+	if (input_pressed(&world->input, INPUT_FIRE) || input_pressed(&world->input, INPUT_CONFIRM)) {
 		world->fading_out = true;
 	}
 
@@ -269,55 +360,64 @@ void game_state_menu_exit(void *context) {
 void game_state_asteroids_enter(void *context) {
 	GameWorld *world = (GameWorld *)context;
 
-	asteroid_system_init(&world->asteroid_system, world->atlas);
+	asteroid_system_init(&world->asteroid_system, world->atlas, rng_fork(&world->rng, RANDOM_STREAM_ASTEROIDS));
 	audio_music_play(MUSIC_ASTEROID);
 }
 StateID game_state_asteroids_update(void *context, float dt) {
 	GameWorld *world = (GameWorld *)context;
 
 	AsteroidSystem *asteroid_system = &world->asteroid_system;
+	uint32_t zone = profiler_zone_begin("asteroids");
 	asteroid_system_update(&world->asteroid_system, dt);
+	profiler_zone_end(zone);
+
+	for (uint32_t player_index = 0; player_index < world->player_count; player_index++) {
+		Player *player = &world->players[player_index];
+		if (player->entity.active == false)
+			continue;
 
-	if (world->player.entity.active) {
-		for (int asteroid_index = 0; asteroid_index < MAX_ASTEROIDS; asteroid_index++) {
-			Asteroid *asteroid = &asteroid_system->asteroids[asteroid_index];
+		for (uint32_t asteroid_index = 0; asteroid_index < asteroid_system->store.count; asteroid_index++) {
+			EntityBody *asteroid = &asteroid_system->bodies[asteroid_index];
 
-			if (!asteroid->entity.active || asteroid->entity.collision_active == false || world->player.entity.collision_active == false)
+			if (asteroid->collision_active == false || player->entity.body.collision_active == false)
 				continue;
 
-			if (CheckCollisionRecs(world->player.entity.collision_shape, asteroid->entity.collision_shape)) {
-				player_kill(&world->player);
+			if (CheckCollisionRecs(player->entity.body.collision_shape, asteroid->collision_shape)) {
+				player_kill(player);
 				return GAME_PHASE_LOSE;
 			}
 		}
 	}
 
-	for (int bullet_index = 0; bullet_index < MAX_BULLETS; bullet_index++) {
-		Bullet *bullet = &world->weapon_system.bullets[bullet_index];
-		if (!bullet->entity.active)
-			continue;
+	BulletSystem *weapon_system = &world->weapon_system;
+	for (uint32_t bullet_index = weapon_system->store.count; bullet_index-- > 0;) {
+		EntityBody *bullet = &weapon_system->bodies[bullet_index];
 
-		for (int a_idx = 0; a_idx < MAX_ASTEROIDS; a_idx++) {
-			Asteroid *asteroid = &asteroid_system->asteroids[a_idx];
-			if (!asteroid->entity.active || asteroid->entity.collision_active == false || bullet->entity.collision_active == false)
+		for (uint32_t a_idx = 0; a_idx < asteroid_system->store.count; a_idx++) {
+			EntityBody *asteroid = &asteroid_system->bodies[a_idx];
+			if (asteroid->collision_active == false || bullet->collision_active == false)
 				continue;
 
-			entity_sync_collision(&bullet->entity);
-			if (CheckCollisionRecs(bullet->entity.collision_shape, asteroid->entity.collision_shape)) {
-				bullet->entity.active = false;
-				asteroid->entity.active = false;
+			entity_body_sync_collision(bullet);
+			if (CheckCollisionRecs(bullet->collision_shape, asteroid->collision_shape)) {
+				// Destroying swaps other entities into these slots, keep what the split needs
+				Vector2 position = asteroid->position;
+				AsteroidVariant variant = asteroid_system->asteroids[a_idx].variant;
+
+				entity_store_destroy_at(&weapon_system->store, bullet_index);
+				entity_store_destroy_at(&asteroid_system->store, a_idx);
 
 				// Audio
 				// audio_sfx_play(SFX_EXPLOSION);
 				world->score += 100;
 
-				if (asteroid->variant == ASTEROID_VARIANT_LARGE) {
+				if (variant == ASTEROID_VARIANT_LARGE) {
 					asteroid_system->large_count--;
-					asteroid_spawn_split(asteroid_system, asteroid->entity.position, ASTEROID_VARIANT_MEDIUM);
-					asteroid_spawn_split(asteroid_system, asteroid->entity.position, ASTEROID_VARIANT_MEDIUM);
-				} else if (asteroid->variant == ASTEROID_VARIANT_MEDIUM) {
-					asteroid_spawn_split(asteroid_system, asteroid->entity.position, ASTEROID_VARIANT_SMALL);
-					asteroid_spawn_split(asteroid_system, asteroid->entity.position, ASTEROID_VARIANT_SMALL);
+					asteroid_spawn_split(asteroid_system, position, ASTEROID_VARIANT_MEDIUM);
+					asteroid_spawn_split(asteroid_system, position, ASTEROID_VARIANT_MEDIUM);
+				} else if (variant == ASTEROID_VARIANT_MEDIUM) {
+					asteroid_spawn_split(asteroid_system, position, ASTEROID_VARIANT_SMALL);
+					asteroid_spawn_split(asteroid_system, position, ASTEROID_VARIANT_SMALL);
 				}
 
 				break;
@@ -328,15 +428,7 @@ StateID game_state_asteroids_update(void *context, float dt) {
 	if (world->score >= BOSS_SCORE_THRESHOLD_PONG) {
 		world->asteroid_system.spawn_rate = 0;
 
-		bool any_active = false;
-		for (int i = 0; i < MAX_ASTEROIDS; i++) {
-			if (world->asteroid_system.asteroids[i].entity.active) {
-				any_active = true;
-				break;
-			}
-		}
-
-		if (!any_active)
+		if (world->asteroid_system.store.count == 0)
 			return GAME_PHASE_BOSS;
 	}
 
@@ -347,48 +439,52 @@ void game_state_asteroids_exit(void *context) {
 	GameWorld *world = (GameWorld *)context;
 
 	world->asteroid_system = (AsteroidSystem){ 0 };
-	audio_music_stop(MUSIC_ASTEROID);
+	audio_music_fade_out(MUSIC_ASTEROID, 1.0f);
 }
 
 void game_state_pong_enter(void *context) {
 	GameWorld *world = (GameWorld *)context;
 	world->last_phase = GAME_PHASE_BOSS;
 
-	boss_encounter_paddle_initialize(&world->boss, world->atlas);
+	boss_encounter_paddle_initialize(&world->boss, world->atlas, rng_fork(&world->rng, RANDOM_STREAM_BOSS));
 }
 
 StateID game_state_pong_update(void *context, float dt) {
 	GameWorld *world = (GameWorld *)context;
 
-	if (boss_encounter_paddle_check_collision(&world->boss, &world->player.entity)) {
-		audio_music_stop_all();
-		player_kill(&world->player);
-		return GAME_PHASE_LOSE;
+	for (uint32_t player_index = 0; player_index < world->player_count; player_index++) {
+		Player *player = &world->players[player_index];
+		if (boss_encounter_paddle_check_collision(&world->boss, &player->entity)) {
+			audio_music_stop_all();
+			player_kill(player);
+			return GAME_PHASE_LOSE;
+		}
 	}
 
-	for (uint32_t bullet_index = 0; bullet_index < MAX_BULLETS; bullet_index++) {
-		Bullet *bullet = &world->weapon_system.bullets[bullet_index];
-		if (!bullet->entity.active)
-			continue;
+	BulletSystem *weapon_system = &world->weapon_system;
+	for (uint32_t bullet_index = weapon_system->store.count; bullet_index-- > 0;) {
+		EntityBody *bullet = &weapon_system->bodies[bullet_index];
 
 		for (uint32_t paddle_index = 0; paddle_index < countof(world->boss.paddles); paddle_index++) {
 			Paddle *paddle = &world->boss.paddles[paddle_index];
-			if (paddle->entity.active == false || paddle->entity.collision_active == false || world->player.entity.collision_active == false)
+			if (paddle->entity.active == false || paddle->entity.body.collision_active == false)
 				continue;
 
-			entity_sync_collision(&bullet->entity);
+			entity_body_sync_collision(bullet);
 			entity_sync_collision(&paddle->entity);
-			if (CheckCollisionRecs(bullet->entity.collision_shape, paddle->entity.collision_shape) == false)
+			if (CheckCollisionRecs(bullet->collision_shape, paddle->entity.body.collision_shape) == false)
 				continue;
 
-			boss_paddle_apply_damage(&world->boss, paddle_index, bullet->damage);
+			boss_paddle_apply_damage(&world->boss, paddle_index, weapon_system->bullets[bullet_index].damage);
 			world->score += 50;
-			bullet->entity.active = false;
+			entity_store_destroy_at(&weapon_system->store, bullet_index);
 			break;
 		}
 	}
 
-	boss_encounter_paddle_update(&world->boss, world->player.entity.position, dt);
+	uint32_t zone = profiler_zone_begin("boss");
+	boss_encounter_paddle_update(&world->boss, world_target_position(world), dt);
+	profiler_zone_end(zone);
 	world->boss_health_bar = (Rectangle){
 		world->bar.x, world->bar.y,
 		world->bar.width * boss_encounter_paddle_health_ratio(&world->boss),
@@ -446,7 +542,7 @@ StateID game_state_win_update(void *context, float dt) {
 	}
 
 	// Return to menu
-	if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_ENTER)) {
+	if (input_pressed(&world->input, INPUT_FIRE) || input_pressed(&world->input, INPUT_CONFIRM)) {
 		world->fading_out = true;
 	}
 
@@ -471,6 +567,7 @@ void game_state_lose_enter(void *context) {
 	GameWorld *world = (GameWorld *)context;
 	world->screen_fade = 0.0f;
 	world->fading_out = false;
+	world->lose_choice = INPUT_BUTTON_COUNT;
 
 	audio_music_stop(MUSIC_BOSS_PONG);
 	audio_loop_stop(LOOP_PLAYER_ROCKET);
@@ -487,29 +584,24 @@ StateID game_state_lose_update(void *context, float dt) {
 	}
 
 	// Retry or menu
-	static uint32_t key_pressed = 0;
-	if (IsKeyPressed(KEY_SPACE) && key_pressed == 0) {
+	if (input_pressed(&world->input, INPUT_FIRE) && world->lose_choice == INPUT_BUTTON_COUNT) {
 		world->fading_out = true;
 		world->screen_fade = 1.0f;
-		key_pressed = KEY_SPACE;
+		world->lose_choice = INPUT_FIRE;
 	}
 
-	if (IsKeyPressed(KEY_ESCAPE) && key_pressed == 0) {
+	if (input_pressed(&world->input, INPUT_BACK) && world->lose_choice == INPUT_BUTTON_COUNT) {
 		world->fading_out = true;
 		world->screen_fade = 2.0f;
-		key_pressed = KEY_ESCAPE;
+		world->lose_choice = INPUT_BACK;
 	}
 
 	if (world->fading_out) {
 		world->screen_fade -= dt;
 		if (world->screen_fade <= 0.0f) {
-			if (key_pressed == KEY_SPACE) {
-				key_pressed = 0;
-				return world->last_phase;
-			} else {
-				key_pressed = 0;
-				return GAME_PHASE_MENU;
-			}
+			InputButton choice = world->lose_choice;
+			world->lose_choice = INPUT_BUTTON_COUNT;
+			return choice == INPUT_FIRE ? world->last_phase : GAME_PHASE_MENU;
 		}
 	}
 
@@ -519,8 +611,8 @@ StateID game_state_lose_update(void *context, float dt) {
 void game_state_lose_exit(void *context) {
 	GameWorld *world = (GameWorld *)context;
 
-	// Reset player for retry
-	player_init(&world->player, world->atlas);
+	// Reset players for retry
+	world_players_spawn(world);
 	world->score = 0;
 }
 
@@ -3,12 +3,15 @@
 #include "asteroid.h"
 #include "common.h"
 #include "core/arena.h"
+#include "core/random.h"
+#include "input.h"
 #include "player.h"
 #include "pong_boss.h"
 #include "weapon.h"
 #include <raylib.h>
 
 #define MAX_STARS 200
+#define WORLD_MAX_PLAYERS 2
 
 typedef struct {
 	Vector2 position;
@@ -17,6 +20,13 @@ typedef struct {
 	Color color;
 } Star;
 
+// Stream ids passed to rng_fork, one per system that draws random numbers
+typedef enum {
+	RANDOM_STREAM_STARS = 1,
+	RANDOM_STREAM_ASTEROIDS,
+	RANDOM_STREAM_BOSS,
+} RandomStream;
+
 typedef enum {
 	GAME_PHASE_MENU,
 	GAME_PHASE_ASTEROIDS,
@@ -27,9 +37,15 @@ typedef enum {
 } GamePhase;
 
 typedef struct {
-	Arena frame;
+	// Per-frame memory, swapped once a frame is done so the last one stays readable
+	FrameArenas frames;
+	// Holds the reset point, lives as long as the world
+	Arena persistent;
+	struct world_snapshot *reset_point;
 
-	Player player;
+	// Co-op ships share the bullets, score and phase, any of them dying loses the run
+	Player players[WORLD_MAX_PLAYERS];
+	uint32_t player_count;
 	PaddleEncounter boss;
 	BulletSystem weapon_system;
 	AsteroidSystem asteroid_system;
@@ -39,6 +55,16 @@ typedef struct {
 	Texture *atlas;
 	Shader *white;
 
+	// Every gameplay stream is forked from `rng`, so one seed reproduces a run
+	uint64_t seed;
+	Rng rng;
+	Rng star_rng;
+
+	// Every player's input for the tick merged together, read by the state callbacks
+	InputState input;
+	// Button that dismissed the lose screen while it fades out
+	InputButton lose_choice;
+
 	uint32_t score;
 	StateID last_phase;
 	uint32_t high_score;
@@ -58,6 +84,12 @@ typedef struct {
 	bool32 show_debug, show_ui;
 } GameWorld;
 
-void world_init(GameWorld *world, Texture *atlas, Shader *white);
-void world_update(GameWorld *world, float dt);
+void world_init(GameWorld *world, Texture *atlas, Shader *white, uint64_t seed);
+// Back to the state world_init left it in, reseeded. Restores a snapshot, nothing is allocated
+void world_reset(GameWorld *world, uint64_t seed);
+void world_destroy(GameWorld *world);
+// Sets how many ships spawn and retakes the reset point, call before the first update
+void world_set_player_count(GameWorld *world, uint32_t count);
+// `inputs` holds one entry per player
+void world_update(GameWorld *world, const InputState *inputs, float dt);
 void world_draw(GameWorld *world);
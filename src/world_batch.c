@@ -0,0 +1,214 @@
+#include "world_batch.h"
+
+#include "autopilot.h"
+#include "core/atomic.h"
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/random.h"
+#include "core/thread.h"
+#include "entity_physics.h"
+#include "world.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Apart from the world's own streams so the script never shifts what the world draws
+#define WORLD_BATCH_SCRIPT_STREAM 0x5C
+
+static const char *result_names[WORLD_RESULT_COUNT] = {
+	[WORLD_RESULT_TIMEOUT] = "timeout",
+	[WORLD_RESULT_WIN] = "win",
+	[WORLD_RESULT_LOSE] = "lose",
+	[WORLD_RESULT_QUIT] = "quit",
+};
+
+// Holds a random mix of flight buttons for a random number of ticks
+typedef struct {
+	Rng rng;
+	uint16_t held, previous;
+	uint32_t remaining;
+} InputScript;
+
+static InputState script_next(InputScript *script, const GameWorld *world) {
+	uint16_t flight = (1u << INPUT_THRUST) | (1u << INPUT_TURN_LEFT) | (1u << INPUT_TURN_RIGHT) | (1u << INPUT_FIRE);
+
+	if (script->remaining == 0) {
+		script->held = (uint16_t)(rng_next(&script->rng) & flight);
+		script->remaining = (uint32_t)rng_range(&script->rng, 6, 30);
+	}
+	script->remaining--;
+
+	uint16_t down = script->held;
+	// Fire only triggers on a press, tap it rather than hold it
+	if (script->remaining & 1)
+		down &= (uint16_t)~(1u << INPUT_FIRE);
+	// Menus move on with confirm or fire, keep tapping until the run starts
+	if (world->state_machine.current == GAME_PHASE_MENU && (script->remaining & 1) == 0)
+		down |= 1u << INPUT_CONFIRM;
+
+	InputState input = { .down = down, .pressed = (uint16_t)(down & ~script->previous) };
+	script->previous = down;
+	return input;
+}
+
+static void world_batch_play(const WorldBatchConfig *config, GameWorld *world, WorldOutcome *outcome) {
+	Replay replay = { 0 };
+	if (config->replay) {
+		// Shares the loaded bytes, only the read cursor is per world
+		replay = *config->replay;
+		replay_rewind(&replay);
+	}
+	InputScript script = { .rng = rng_seed(outcome->seed, WORLD_BATCH_SCRIPT_STREAM) };
+	Autopilot pilot;
+	autopilot_init(&pilot, config->aggression);
+
+	outcome->result = WORLD_RESULT_TIMEOUT;
+	outcome->boss_time = -1.0f;
+
+	while (outcome->ticks < config->max_ticks) {
+		ReplayTick tick = { .dt = WORLD_BATCH_TICK_DT };
+		if (config->replay) {
+			if (replay_next(&replay, &tick) == false)
+				break;
+		} else if (config->autopilot)
+			tick.input = autopilot_next(&pilot, world, 0);
+		else
+			tick.input = script_next(&script, world);
+
+		world_update(world, &tick.input, tick.dt);
+		frame_arenas_swap(&world->frames);
+
+		outcome->ticks++;
+		outcome->play_time += tick.dt;
+
+		StateID phase = world->state_machine.current;
+		if (phase == GAME_PHASE_BOSS && outcome->boss_time < 0.0f)
+			outcome->boss_time = outcome->play_time;
+
+		if (phase == GAME_PHASE_WIN || phase == GAME_PHASE_LOSE || world->running == false) {
+			outcome->result = phase == GAME_PHASE_WIN ? WORLD_RESULT_WIN : phase == GAME_PHASE_LOSE ? WORLD_RESULT_LOSE : WORLD_RESULT_QUIT;
+			break;
+		}
+	}
+
+	outcome->score = world->score;
+}
+
+// Claims worlds until none are left. Each thread builds one world and resets it
+// between runs, a reset restores the snapshot world_init took and allocates nothing.
+static void world_batch_work(WorldBatch *batch) {
+	GameWorld world;
+	bool32 world_ready = false;
+
+	for (;;) {
+		uint32_t index = atomic_add(&batch->next_world, 1);
+		if (index >= batch->config.world_count)
+			break;
+
+		WorldOutcome *outcome = &batch->outcomes[index];
+		*outcome = (WorldOutcome){ .seed = batch->config.seed + index };
+
+		if (world_ready)
+			world_reset(&world, outcome->seed);
+		else
+			world_init(&world, NULL, NULL, outcome->seed);
+		world_ready = true;
+
+		world_batch_play(&batch->config, &world, outcome);
+		atomic_add(&batch->total_ticks, (uint64_t)outcome->ticks);
+	}
+
+	if (world_ready)
+		world_destroy(&world);
+}
+
+static void world_batch_thread_main(void *user) {
+	world_batch_work(user);
+	arena_scratch_shutdown();
+}
+
+bool32 world_batch_run(WorldBatch *batch, const WorldBatchConfig *config) {
+	*batch = (WorldBatch){ .config = *config };
+	if (config->world_count == 0)
+		return false;
+
+	batch->outcomes = calloc(config->world_count, sizeof(*batch->outcomes));
+	if (batch->outcomes == NULL) {
+		LOG_ERROR("Batch: could not allocate %u outcomes", config->world_count);
+		return false;
+	}
+
+	uint32_t thread_count = config->thread_count ? config->thread_count : thread_hardware_concurrency();
+	thread_count = clamp(thread_count, 1u, config->world_count);
+	batch->config.thread_count = thread_count;
+
+	// Physics picks its backend lazily, settle it before several threads race to pick it
+	entity_physics_backend();
+
+	Thread **threads = calloc(thread_count, sizeof(*threads));
+	if (threads == NULL) {
+		free(batch->outcomes);
+		batch->outcomes = NULL;
+		return false;
+	}
+
+	uint64_t start = clock_now_ns();
+	// The calling thread works too, and picks up everything if threads are unavailable
+	for (uint32_t thread_index = 1; thread_index < thread_count; thread_index++)
+		threads[thread_index] = thread_create(world_batch_thread_main, batch);
+	world_batch_work(batch);
+	for (uint32_t thread_index = 1; thread_index < thread_count; thread_index++)
+		thread_join(threads[thread_index]);
+	batch->elapsed_ns = clock_now_ns() - start;
+
+	free(threads);
+	return true;
+}
+
+void world_batch_report(const WorldBatch *batch) {
+	uint32_t result_counts[WORLD_RESULT_COUNT] = { 0 };
+	uint64_t score_total = 0;
+	uint32_t boss_count = 0;
+	double boss_time_total = 0;
+
+	// Results go to stdout at any log level, optimized builds are the ones throughput runs use.
+	// Flushed first so they land after whatever the worlds logged
+	logger_flush();
+	for (uint32_t index = 0; index < batch->config.world_count; index++) {
+		const WorldOutcome *outcome = &batch->outcomes[index];
+		if (outcome->boss_time >= 0.0f) {
+			printf("Batch: world %u seed %llu %s, score %u, boss at %.2f s, %u ticks\n", index, (unsigned long long)outcome->seed,
+				world_result_name(outcome->result), outcome->score, outcome->boss_time, outcome->ticks);
+		} else {
+			printf("Batch: world %u seed %llu %s, score %u, no boss, %u ticks\n", index, (unsigned long long)outcome->seed,
+				world_result_name(outcome->result), outcome->score, outcome->ticks);
+		}
+
+		result_counts[outcome->result]++;
+		score_total += outcome->score;
+		if (outcome->boss_time >= 0.0f) {
+			boss_count++;
+			boss_time_total += outcome->boss_time;
+		}
+	}
+
+	uint32_t count = batch->config.world_count;
+	double seconds = batch->elapsed_ns / 1e9;
+	printf("Batch: %u worlds on %u threads, %u won, %u lost, %u quit, %u timed out\n", count, batch->config.thread_count,
+		result_counts[WORLD_RESULT_WIN], result_counts[WORLD_RESULT_LOSE], result_counts[WORLD_RESULT_QUIT],
+		result_counts[WORLD_RESULT_TIMEOUT]);
+	printf("Batch: mean score %.1f, %u reached the boss after %.2f s on average\n", count ? (double)score_total / count : 0.0,
+		boss_count, boss_count ? boss_time_total / boss_count : 0.0);
+	printf("Batch: %llu ticks in %.3f s, %.0f ticks/s\n", (unsigned long long)batch->total_ticks, seconds,
+		seconds > 0 ? batch->total_ticks / seconds : 0.0);
+	fflush(stdout);
+}
+
+void world_batch_destroy(WorldBatch *batch) {
+	free(batch->outcomes);
+	*batch = (WorldBatch){ 0 };
+}
+
+const char *world_result_name(WorldResult result) {
+	return result < WORLD_RESULT_COUNT ? result_names[result] : "unknown";
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "common.h"
+#include "replay.h"
+
+// Fixed step for scripted worlds, replayed worlds use the recorded dt
+#define WORLD_BATCH_TICK_DT (1.0f / 60.0f)
+
+typedef enum {
+	// Ran out of ticks or replay before the run ended
+	WORLD_RESULT_TIMEOUT,
+	WORLD_RESULT_WIN,
+	WORLD_RESULT_LOSE,
+	// Backed out of the menu
+	WORLD_RESULT_QUIT,
+
+	WORLD_RESULT_COUNT
+} WorldResult;
+
+typedef struct {
+	uint64_t seed;
+	WorldResult result;
+	uint32_t score;
+	uint32_t ticks;
+
+	// Simulated seconds, boss_time is negative when the boss was never reached
+	float play_time;
+	float boss_time;
+} WorldOutcome;
+
+typedef struct {
+	uint32_t world_count;
+	// 0 uses every hardware thread
+	uint32_t thread_count;
+	uint32_t max_ticks;
+
+	// World i is seeded with seed + i
+	uint64_t seed;
+	// Every world plays this replay from the start when set, otherwise the autopilot or a seeded random script
+	const Replay *replay;
+	bool32 autopilot;
+	float aggression;
+} WorldBatchConfig;
+
+// Outcomes only depend on the config, never on how worlds were spread over threads
+typedef struct {
+	WorldBatchConfig config;
+	WorldOutcome *outcomes;
+
+	uint32_t next_world;
+	uint64_t total_ticks;
+	uint64_t elapsed_ns;
+} WorldBatch;
+
+bool32 world_batch_run(WorldBatch *batch, const WorldBatchConfig *config);
+// Prints every outcome followed by the totals and throughput to stdout, whatever the log level
+void world_batch_report(const WorldBatch *batch);
+void world_batch_destroy(WorldBatch *batch);
+
+const char *world_result_name(WorldResult result);
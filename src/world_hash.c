@@ -0,0 +1,252 @@
+#include "world_hash.h"
+#include "core/logger.h"
+
+#include <string.h>
+
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ull
+
+#define hash_field(h, field) hash_bytes((h), &(field), sizeof(field))
+
+static const char *part_names[WORLD_HASH_PART_COUNT] = {
+	[WORLD_HASH_PLAYER] = "player",
+	[WORLD_HASH_BULLETS] = "bullets",
+	[WORLD_HASH_ASTEROIDS] = "asteroids",
+	[WORLD_HASH_BOSS] = "boss",
+	[WORLD_HASH_PROGRESS] = "progress",
+};
+
+// murmur3 finalizer
+static inline uint64_t hash_mix(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDull;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+// Eight bytes per step, the structs hashed here have no padding so raw bytes are stable
+static uint64_t hash_bytes(uint64_t h, const void *data, usize size) {
+	const uint8_t *bytes = data;
+	while (size >= 8) {
+		uint64_t word;
+		memcpy(&word, bytes, sizeof(word));
+		h = (h ^ word) * HASH_MULTIPLIER;
+		h ^= h >> 29;
+		bytes += 8;
+		size -= 8;
+	}
+
+	if (size) {
+		uint64_t word = 0;
+		memcpy(&word, bytes, size);
+		h = (h ^ word ^ ((uint64_t)size << 56)) * HASH_MULTIPLIER;
+		h ^= h >> 29;
+	}
+
+	return h;
+}
+
+static uint64_t hash_entity(uint64_t h, const Entity *entity) {
+	h = hash_field(h, entity->active);
+	return hash_field(h, entity->body);
+}
+
+static uint64_t hash_player(uint64_t h, const Player *player) {
+	h = hash_entity(h, &player->entity);
+	h = hash_field(h, player->respawn_timer);
+	h = hash_field(h, player->rotation_speed);
+	h = hash_field(h, player->acceleration);
+	h = hash_field(h, player->drag);
+	h = hash_field(h, player->info);
+	return h;
+}
+
+static uint64_t hash_players(const GameWorld *world) {
+	uint64_t h = WORLD_HASH_PLAYER ^ world->player_count;
+	for (uint32_t player_index = 0; player_index < world->player_count; player_index++)
+		h = hash_player(h, &world->players[player_index]);
+	return hash_mix(h);
+}
+
+static uint64_t hash_bullets(const BulletSystem *system) {
+	uint64_t sum = 0;
+	for (uint32_t index = 0; index < system->store.count; index++) {
+		uint64_t h = hash_field(WORLD_HASH_BULLETS, system->bodies[index]);
+		sum += hash_mix(hash_field(h, system->bullets[index]));
+	}
+
+	return hash_mix(sum ^ system->store.count);
+}
+
+static uint64_t hash_asteroids(const AsteroidSystem *system) {
+	uint64_t sum = 0;
+	for (uint32_t index = 0; index < system->store.count; index++) {
+		uint64_t h = hash_field(WORLD_HASH_ASTEROIDS, system->bodies[index]);
+		sum += hash_mix(hash_field(h, system->asteroids[index]));
+	}
+
+	uint64_t h = sum ^ system->store.count;
+	h = hash_field(h, system->large_count);
+	h = hash_field(h, system->spawn_timer);
+	h = hash_field(h, system->spawn_rate);
+	h = hash_field(h, system->rng);
+	return hash_mix(h);
+}
+
+static uint64_t hash_boss(const PaddleEncounter *encounter) {
+	uint64_t sum = 0;
+	for (uint32_t index = 0; index < encounter->projectiles.store.count; index++)
+		sum += hash_mix(hash_field(WORLD_HASH_BOSS, encounter->projectiles.bodies[index]));
+
+	StateID state = encounter->state_machine.current;
+	uint32_t survivor = encounter->survivor ? (uint32_t)(encounter->survivor - encounter->paddles) : INVALID_INDEX;
+
+	uint64_t h = sum ^ encounter->projectiles.store.count;
+	h = hash_field(h, state);
+	h = hash_field(h, survivor);
+	h = hash_field(h, encounter->health);
+	h = hash_field(h, encounter->max_health);
+
+	for (uint32_t index = 0; index < countof(encounter->paddles); index++) {
+		const Paddle *paddle = &encounter->paddles[index];
+		h = hash_entity(h, &paddle->entity);
+		h = hash_field(h, paddle->flash_timer);
+		h = hash_field(h, paddle->target_y);
+	}
+	for (uint32_t index = 0; index < countof(encounter->bricks); index++)
+		h = hash_entity(h, &encounter->bricks[index]);
+
+	h = hash_field(h, encounter->active_scenario.type);
+	h = hash_field(h, encounter->active_scenario.base_position);
+	h = hash_field(h, encounter->active_scenario.timer);
+	h = hash_field(h, encounter->active_scenario.duration);
+	h = hash_field(h, encounter->balls);
+	h = hash_field(h, encounter->rng);
+	return hash_mix(h);
+}
+
+static uint64_t hash_progress(const GameWorld *world) {
+	StateID state = world->state_machine.current;
+
+	uint64_t h = WORLD_HASH_PROGRESS;
+	h = hash_field(h, state);
+	h = hash_field(h, world->score);
+	h = hash_field(h, world->last_phase);
+	h = hash_field(h, world->seed);
+	h = hash_field(h, world->rng);
+	h = hash_field(h, world->star_rng);
+	h = hash_field(h, world->screen_fade);
+	h = hash_field(h, world->fading_out);
+	h = hash_field(h, world->lose_choice);
+	return hash_mix(h);
+}
+
+void world_hash_compute(const GameWorld *world, WorldHash *hash) {
+	hash->parts[WORLD_HASH_PLAYER] = hash_players(world);
+	hash->parts[WORLD_HASH_BULLETS] = hash_bullets(&world->weapon_system);
+	hash->parts[WORLD_HASH_ASTEROIDS] = hash_asteroids(&world->asteroid_system);
+	hash->parts[WORLD_HASH_BOSS] = hash_boss(&world->boss);
+	hash->parts[WORLD_HASH_PROGRESS] = hash_progress(world);
+}
+
+uint64_t world_hash_combined(const WorldHash *hash) {
+	return hash_mix(hash_bytes(0, hash->parts, sizeof(hash->parts)));
+}
+
+const char *world_hash_part_name(WorldHashPart part) {
+	return part < WORLD_HASH_PART_COUNT ? part_names[part] : "unknown";
+}
+
+bool32 world_hash_stream_create(WorldHashStream *stream, const char *path) {
+	*stream = (WorldHashStream){ .writing = true };
+
+	stream->file = fopen(path, "wb");
+	if (stream->file == NULL) {
+		LOG_WARN("WorldHash: failed to create '%s'", path);
+		return false;
+	}
+
+	uint32_t header[3] = { WORLD_HASH_MAGIC, WORLD_HASH_VERSION, WORLD_HASH_PART_COUNT };
+	fwrite(header, sizeof(header), 1, stream->file);
+	return true;
+}
+
+bool32 world_hash_stream_open(WorldHashStream *stream, const char *path) {
+	*stream = (WorldHashStream){ .writing = false };
+
+	stream->file = fopen(path, "rb");
+	if (stream->file == NULL) {
+		LOG_WARN("WorldHash: failed to open '%s'", path);
+		return false;
+	}
+
+	uint32_t header[3] = { 0 };
+	if (fread(header, sizeof(header), 1, stream->file) != 1 || header[0] != WORLD_HASH_MAGIC ||
+		header[1] != WORLD_HASH_VERSION || header[2] != WORLD_HASH_PART_COUNT) {
+		LOG_WARN("WorldHash: '%s' is not a compatible hash stream", path);
+		fclose(stream->file);
+		stream->file = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+void world_hash_stream_close(WorldHashStream *stream) {
+	if (stream->file == NULL)
+		return;
+
+	if (stream->writing) {
+		LOG_INFO("WorldHash: wrote %u ticks", stream->tick);
+	} else {
+		// The verdict is what a check runs for, printed whatever the log level and after what was logged
+		logger_flush();
+		if (stream->diverged)
+			printf("WorldHash: diverged from the reference at tick %u\n", stream->divergent_tick);
+		else
+			printf("WorldHash: %u ticks match the reference\n", stream->tick);
+		fflush(stdout);
+	}
+
+	fclose(stream->file);
+	stream->file = NULL;
+}
+
+bool32 world_hash_stream_tick(WorldHashStream *stream, const WorldHash *hash) {
+	if (stream->file == NULL || stream->diverged)
+		return stream->diverged == false;
+
+	uint32_t tick = stream->tick++;
+	if (stream->writing) {
+		fwrite(hash->parts, sizeof(hash->parts), 1, stream->file);
+		return true;
+	}
+
+	WorldHash reference;
+	if (fread(reference.parts, sizeof(reference.parts), 1, stream->file) != 1) {
+		stream->diverged = true;
+		stream->divergent_tick = tick;
+		stream->divergent_parts = 0;
+		LOG_ERROR("WorldHash: reference ends before tick %u", tick);
+		return false;
+	}
+
+	for (uint32_t part = 0; part < WORLD_HASH_PART_COUNT; part++) {
+		if (reference.parts[part] != hash->parts[part])
+			stream->divergent_parts |= 1u << part;
+	}
+
+	if (stream->divergent_parts == 0)
+		return true;
+
+	stream->diverged = true;
+	stream->divergent_tick = tick;
+	for (uint32_t part = 0; part < WORLD_HASH_PART_COUNT; part++) {
+		if (stream->divergent_parts & (1u << part))
+			LOG_ERROR("WorldHash: tick %u diverged in %s (%016llx, expected %016llx)", tick, world_hash_part_name(part),
+				(unsigned long long)hash->parts[part], (unsigned long long)reference.parts[part]);
+	}
+
+	return false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "common.h"
+#include "world.h"
+
+#include <stdio.h>
+
+// Checksums of the gameplay state, one per subsystem so a divergence can be
+// pinned down. Pooled entities are hashed individually and summed, so the
+// order a swap-remove leaves them in does not matter.
+typedef enum {
+	WORLD_HASH_PLAYER,
+	WORLD_HASH_BULLETS,
+	WORLD_HASH_ASTEROIDS,
+	WORLD_HASH_BOSS,
+	WORLD_HASH_PROGRESS,
+
+	WORLD_HASH_PART_COUNT
+} WorldHashPart;
+
+typedef struct {
+	uint64_t parts[WORLD_HASH_PART_COUNT];
+} WorldHash;
+
+void world_hash_compute(const GameWorld *world, WorldHash *hash);
+uint64_t world_hash_combined(const WorldHash *hash);
+const char *world_hash_part_name(WorldHashPart part);
+
+// Hash stream file in native byte order: magic u32, version u32, part_count u32, then one WorldHash per tick
+#define WORLD_HASH_MAGIC 0x48534841u // "AHSH"
+#define WORLD_HASH_VERSION 1u
+
+typedef struct {
+	FILE *file;
+	bool32 writing;
+	uint32_t tick;
+
+	// Set when checking, the first tick that did not match and which parts differed
+	bool32 diverged;
+	uint32_t divergent_tick;
+	uint32_t divergent_parts;
+} WorldHashStream;
+
+bool32 world_hash_stream_create(WorldHashStream *stream, const char *path);
+bool32 world_hash_stream_open(WorldHashStream *stream, const char *path);
+void world_hash_stream_close(WorldHashStream *stream);
+
+// Writes or compares the next tick. Returns false from the first divergence on,
+// including a reference that ran out of ticks.
+bool32 world_hash_stream_tick(WorldHashStream *stream, const WorldHash *hash);
@@ -0,0 +1,84 @@
+#include "world_snapshot.h"
+
+#include <string.h>
+
+static void sprites_bind(EntitySprite *sprites, uint32_t count, Texture *texture) {
+	for (uint32_t index = 0; index < count; index++)
+		sprites[index].texture = texture;
+}
+
+// Points every texture the world draws with at `atlas`, bricks are drawn untextured
+static void world_bind_textures(GameWorld *world, Texture *atlas) {
+	PaddleEncounter *boss = &world->boss;
+
+	for (uint32_t player_index = 0; player_index < countof(world->players); player_index++)
+		world->players[player_index].entity.sprite.texture = atlas;
+	world->weapon_system.texture = atlas;
+	world->asteroid_system.texture = atlas;
+	boss->paddle_texture = atlas;
+
+	sprites_bind(world->weapon_system.sprites, world->weapon_system.store.count, atlas);
+	sprites_bind(world->asteroid_system.sprites, world->asteroid_system.store.count, atlas);
+	for (uint32_t paddle_index = 0; paddle_index < countof(boss->paddles); paddle_index++)
+		boss->paddles[paddle_index].entity.sprite.texture = atlas;
+}
+
+void world_snapshot_save(const GameWorld *world, WorldSnapshot *snapshot) {
+	const PaddleEncounter *boss = &world->boss;
+	snapshot->survivor_index = boss->survivor ? (uint32_t)(boss->survivor - boss->paddles) : INVALID_INDEX;
+
+	GameWorld *copy = &snapshot->world;
+	memcpy(copy, world, sizeof(*world));
+
+	copy->frames = (FrameArenas){ 0 };
+	copy->persistent = (Arena){ 0 };
+	copy->reset_point = NULL;
+	copy->atlas = NULL;
+	copy->white = NULL;
+	copy->state_machine.context = NULL;
+	copy->boss.state_machine.context = NULL;
+	copy->boss.survivor = NULL;
+	world_bind_textures(copy, NULL);
+}
+
+void world_snapshot_restore(GameWorld *world, const WorldSnapshot *snapshot) {
+	FrameArenas frames = world->frames;
+	Arena persistent = world->persistent;
+	WorldSnapshot *reset_point = world->reset_point;
+	Texture *atlas = world->atlas;
+	Shader *white = world->white;
+
+	memcpy(world, &snapshot->world, sizeof(*world));
+
+	world->frames = frames;
+	world->persistent = persistent;
+	world->reset_point = reset_point;
+	world->atlas = atlas;
+	world->white = white;
+
+	PaddleEncounter *boss = &world->boss;
+	world->state_machine.context = world;
+	boss->state_machine.context = boss;
+	boss->survivor = snapshot->survivor_index < countof(boss->paddles) ? &boss->paddles[snapshot->survivor_index] : NULL;
+	world_bind_textures(world, atlas);
+}
+
+void world_rewind_tick(WorldRewind *rewind, const GameWorld *world) {
+	if (rewind->ticks++ % WORLD_REWIND_INTERVAL)
+		return;
+
+	world_snapshot_save(world, &rewind->snapshots[rewind->head]);
+	rewind->head = (rewind->head + 1) % WORLD_REWIND_CAPACITY;
+	rewind->count = min(rewind->count + 1, WORLD_REWIND_CAPACITY);
+}
+
+bool32 world_rewind_step_back(WorldRewind *rewind, GameWorld *world) {
+	if (rewind->count == 0)
+		return false;
+
+	rewind->head = (rewind->head + WORLD_REWIND_CAPACITY - 1) % WORLD_REWIND_CAPACITY;
+	rewind->count--;
+	rewind->ticks = 1;
+	world_snapshot_restore(world, &rewind->snapshots[rewind->head]);
+	return true;
+}
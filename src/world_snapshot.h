@@ -0,0 +1,32 @@
+#pragma once
+
+#include "common.h"
+#include "world.h"
+
+// Copy of the simulation state with every data pointer cleared: the frame
+// arena, textures, shader, FSM contexts and the boss survivor are rebound
+// from the live world on restore. FSM handler tables are code addresses, so a
+// snapshot is only meaningful to the binary that took it.
+typedef struct world_snapshot {
+	GameWorld world;
+	uint32_t survivor_index;
+} WorldSnapshot;
+
+void world_snapshot_save(const GameWorld *world, WorldSnapshot *snapshot);
+// Keeps the live world's arenas and resources, everything else comes from the snapshot
+void world_snapshot_restore(GameWorld *world, const WorldSnapshot *snapshot);
+
+// Ring of recent snapshots for stepping back while debugging
+#define WORLD_REWIND_CAPACITY 64
+#define WORLD_REWIND_INTERVAL 10
+
+typedef struct {
+	WorldSnapshot snapshots[WORLD_REWIND_CAPACITY];
+	uint32_t head, count;
+	uint32_t ticks;
+} WorldRewind;
+
+// Takes a snapshot every WORLD_REWIND_INTERVAL calls, overwriting the oldest when full
+void world_rewind_tick(WorldRewind *rewind, const GameWorld *world);
+// Restores the most recent snapshot and drops it, false when the ring is empty
+bool32 world_rewind_step_back(WorldRewind *rewind, GameWorld *world);
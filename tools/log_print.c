@@ -0,0 +1,184 @@
+// Pretty-prints a binary log written through logger_binary_open in the game's text format.
+//
+//     log_print astroids.alog
+#include "common.h"
+#include "core/log_binary.h"
+#include "core/logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_PRINT_MAX_PAYLOAD 65535
+
+typedef struct {
+	bool32 defined;
+	LogLevel level;
+	int line;
+	char *file, *format;
+} PrintSite;
+
+static PrintSite *sites = NULL;
+static uint32_t site_capacity = 0;
+
+static bool32 read_exact(FILE *file, void *buffer, usize size) {
+	return fread(buffer, 1, size, file) == size;
+}
+
+static char *read_string(FILE *file, uint16_t length) {
+	char *string = malloc((usize)length + 1);
+	if (string == NULL || read_exact(file, string, length) == false) {
+		free(string);
+		return NULL;
+	}
+	string[length] = '\0';
+	return string;
+}
+
+static PrintSite *site_get(uint32_t id) {
+	if (id >= site_capacity) {
+		uint32_t capacity = max(site_capacity * 2, 64);
+		while (capacity <= id)
+			capacity *= 2;
+
+		PrintSite *grown = realloc(sites, capacity * sizeof(*sites));
+		if (grown == NULL)
+			return NULL;
+		memset(grown + site_capacity, 0, (capacity - site_capacity) * sizeof(*sites));
+
+		sites = grown;
+		site_capacity = capacity;
+	}
+	return &sites[id];
+}
+
+static bool32 read_site(FILE *file) {
+	uint8_t header[LOG_SITE_RECORD_SIZE - 1];
+	if (read_exact(file, header, sizeof(header)) == false)
+		return false;
+
+	uint32_t id, line;
+	uint16_t file_length, format_length;
+	memcpy(&id, header + 0, 4);
+	memcpy(&line, header + 5, 4);
+	memcpy(&file_length, header + 9, 2);
+	memcpy(&format_length, header + 11, 2);
+
+	PrintSite *site = site_get(id);
+	if (site == NULL)
+		return false;
+
+	free(site->file);
+	free(site->format);
+	site->level = (LogLevel)min(header[4], LOG_LEVEL_FATAL);
+	site->line = (int)line;
+	site->file = read_string(file, file_length);
+	site->format = read_string(file, format_length);
+	site->defined = site->file && site->format;
+
+	return site->defined;
+}
+
+// Text sites carry "file:line: message", the caller's location replaces the site's empty one
+static void split_text_site(char *message, const char **file, int *line, const char **text) {
+	char *colon = strchr(message, ':');
+	if (colon == NULL)
+		return;
+
+	char *end;
+	long number = strtol(colon + 1, &end, 10);
+	if (end == colon + 1 || end[0] != ':' || end[1] != ' ')
+		return;
+
+	*colon = '\0';
+	*file = message;
+	*line = (int)number;
+	*text = end + 2;
+}
+
+static bool32 read_message(FILE *file, int64_t base_unix_ns) {
+	static uint8_t payload[LOG_PRINT_MAX_PAYLOAD];
+	static char message[4096];
+
+	uint8_t header[LOG_MESSAGE_RECORD_SIZE - 1];
+	if (read_exact(file, header, sizeof(header)) == false)
+		return false;
+
+	uint32_t id;
+	uint64_t timestamp_ns;
+	uint16_t payload_size;
+	memcpy(&id, header + 0, 4);
+	memcpy(&timestamp_ns, header + 4, 8);
+	memcpy(&payload_size, header + 13, 2);
+
+	if (read_exact(file, payload, payload_size) == false)
+		return false;
+
+	PrintSite *site = id < site_capacity ? &sites[id] : NULL;
+	if (site == NULL || site->defined == false) {
+		fprintf(stderr, "log_print: message references unknown site %u\n", id);
+		return true;
+	}
+
+	log_args_render(message, sizeof(message), site->format, payload, payload_size);
+	int64_t unix_seconds = (base_unix_ns + (int64_t)timestamp_ns) / 1000000000LL;
+
+	const char *source = site->file, *text = message;
+	int line = site->line;
+	if (strcmp(site->file, LOG_TEXT_SITE_FILE) == 0)
+		split_text_site(message, &source, &line, &text);
+	logger_print(site->level, source, line, header[12], unix_seconds, text);
+
+	return true;
+}
+
+int main(int argc, char **argv) {
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s <log.alog>\n", argv[0]);
+		return 1;
+	}
+
+	FILE *file = fopen(argv[1], "rb");
+	if (file == NULL) {
+		fprintf(stderr, "log_print: failed to open '%s'\n", argv[1]);
+		return 1;
+	}
+
+	LogBinaryHeader header;
+	if (read_exact(file, &header, sizeof(header)) == false || header.magic != LOG_BINARY_MAGIC) {
+		fprintf(stderr, "log_print: '%s' is not a binary log\n", argv[1]);
+		fclose(file);
+		return 1;
+	}
+	if (header.version != LOG_BINARY_VERSION) {
+		fprintf(stderr, "log_print: unsupported version %u\n", header.version);
+		fclose(file);
+		return 1;
+	}
+
+	int result = 0;
+	int tag;
+	while ((tag = fgetc(file)) != EOF) {
+		bool32 ok = false;
+		if (tag == LOG_RECORD_SITE)
+			ok = read_site(file);
+		else if (tag == LOG_RECORD_MESSAGE)
+			ok = read_message(file, header.base_unix_ns);
+
+		if (ok == false) {
+			// A log cut short by a crash ends mid-record, everything before it is still valid
+			fprintf(stderr, "log_print: truncated or corrupt record at offset %ld\n", ftell(file));
+			result = 1;
+			break;
+		}
+	}
+
+	for (uint32_t i = 0; i < site_capacity; i++) {
+		free(sites[i].file);
+		free(sites[i].format);
+	}
+	free(sites);
+	fclose(file);
+
+	return result;
+}